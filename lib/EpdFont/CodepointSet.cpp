@@ -0,0 +1,182 @@
+#include "CodepointSet.h"
+
+#include <HardwareSerial.h>
+#include <SDCardManager.h>
+#include <Serialization.h>
+#include <Utf8.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+constexpr uint32_t CODEPOINT_SET_MAGIC = 0x31535043;  // "CPS1"
+}
+
+CodepointSet::~CodepointSet() { clear(); }
+
+void CodepointSet::clear() {
+  for (auto& page : pages) {
+    free(page);
+    page = nullptr;
+  }
+  std::vector<uint32_t>().swap(astral);
+  count = 0;
+}
+
+bool CodepointSet::copyFrom(const CodepointSet& other) {
+  if (&other == this) {
+    return true;
+  }
+  clear();
+  for (uint32_t i = 0; i < PAGE_COUNT; i++) {
+    if (!other.pages[i]) {
+      continue;
+    }
+    pages[i] = static_cast<uint32_t*>(malloc(WORDS_PER_PAGE * sizeof(uint32_t)));
+    if (!pages[i]) {
+      clear();
+      return false;
+    }
+    memcpy(pages[i], other.pages[i], WORDS_PER_PAGE * sizeof(uint32_t));
+  }
+  astral = other.astral;
+  count = other.count;
+  return true;
+}
+
+bool CodepointSet::next(const uint32_t from, uint32_t* cp) const {
+  for (uint32_t page = from >> PAGE_BITS; page < PAGE_COUNT; page++) {
+    if (!pages[page]) {
+      continue;
+    }
+    // Only the page holding from starts part way
+    const uint32_t offset = page == from >> PAGE_BITS ? from & (PAGE_SIZE - 1) : 0;
+    for (uint32_t word = offset >> 5; word < WORDS_PER_PAGE; word++) {
+      uint32_t bits = pages[page][word];
+      if (word == offset >> 5) {
+        bits &= ~0u << (offset & 31);
+      }
+      if (bits != 0) {
+        *cp = (page << PAGE_BITS) | (word << 5) | __builtin_ctz(bits);
+        return true;
+      }
+    }
+  }
+  const auto it = std::lower_bound(astral.begin(), astral.end(), from);
+  if (it == astral.end()) {
+    return false;
+  }
+  *cp = *it;
+  return true;
+}
+
+bool CodepointSet::add(const uint32_t cp) {
+  if (cp >= 0x10000) {
+    const auto it = std::lower_bound(astral.begin(), astral.end(), cp);
+    if (it != astral.end() && *it == cp) {
+      return false;
+    }
+    astral.insert(it, cp);
+    count++;
+    return true;
+  }
+
+  uint32_t*& page = pages[cp >> PAGE_BITS];
+  if (!page) {
+    page = static_cast<uint32_t*>(calloc(WORDS_PER_PAGE, sizeof(uint32_t)));
+    if (!page) {
+      return false;
+    }
+  }
+  uint32_t& word = page[(cp & (PAGE_SIZE - 1)) >> 5];
+  const uint32_t bit = 1u << (cp & 31);
+  if (word & bit) {
+    return false;
+  }
+  word |= bit;
+  count++;
+  return true;
+}
+
+void CodepointSet::addUtf8(const char* text) {
+  const auto* p = reinterpret_cast<const unsigned char*>(text);
+  while (const uint32_t cp = utf8NextCodepoint(&p)) {
+    add(cp);
+  }
+}
+
+bool CodepointSet::contains(const uint32_t cp) const {
+  if (cp >= 0x10000) {
+    return std::binary_search(astral.begin(), astral.end(), cp);
+  }
+  const uint32_t* page = pages[cp >> PAGE_BITS];
+  return page && (page[(cp & (PAGE_SIZE - 1)) >> 5] & (1u << (cp & 31)));
+}
+
+// File layout: magic, page count, then (page number, bitmap) per allocated page, then the codepoints above the BMP
+bool CodepointSet::save(const std::string& path) const {
+  FsFile file;
+  if (!SdMan.openFileForWrite("CPS", path, file)) {
+    return false;
+  }
+  serialization::writePod(file, CODEPOINT_SET_MAGIC);
+  uint16_t pageCount = 0;
+  for (const auto* page : pages) {
+    pageCount += page != nullptr;
+  }
+  serialization::writePod(file, pageCount);
+  for (uint32_t i = 0; i < PAGE_COUNT; i++) {
+    if (pages[i]) {
+      serialization::writePod(file, static_cast<uint8_t>(i));
+      file.write(reinterpret_cast<const uint8_t*>(pages[i]), WORDS_PER_PAGE * sizeof(uint32_t));
+    }
+  }
+  serialization::writePod(file, static_cast<uint32_t>(astral.size()));
+  file.write(reinterpret_cast<const uint8_t*>(astral.data()), astral.size() * sizeof(uint32_t));
+  file.close();
+  return true;
+}
+
+bool CodepointSet::load(const std::string& path) {
+  clear();
+  FsFile file;
+  if (!SdMan.exists(path.c_str()) || !SdMan.openFileForRead("CPS", path, file)) {
+    return false;
+  }
+
+  uint32_t magic = 0;
+  uint16_t pageCount = 0;
+  serialization::readPod(file, magic);
+  serialization::readPod(file, pageCount);
+  bool ok = magic == CODEPOINT_SET_MAGIC && pageCount <= PAGE_COUNT;
+  for (uint16_t i = 0; ok && i < pageCount; i++) {
+    uint8_t index = 0;
+    serialization::readPod(file, index);
+    uint32_t*& page = pages[index];
+    if (!page) {
+      page = static_cast<uint32_t*>(malloc(WORDS_PER_PAGE * sizeof(uint32_t)));
+    }
+    ok = page && file.read(reinterpret_cast<uint8_t*>(page), WORDS_PER_PAGE * sizeof(uint32_t)) ==
+                     static_cast<int>(WORDS_PER_PAGE * sizeof(uint32_t));
+    for (uint32_t word = 0; ok && word < WORDS_PER_PAGE; word++) {
+      count += __builtin_popcount(page[word]);
+    }
+  }
+  uint32_t astralCount = 0;
+  serialization::readPod(file, astralCount);
+  ok = ok && astralCount <= 0x10000;
+  if (ok) {
+    astral.resize(astralCount);
+    ok = file.read(reinterpret_cast<uint8_t*>(astral.data()), astralCount * sizeof(uint32_t)) ==
+         static_cast<int>(astralCount * sizeof(uint32_t));
+    count += astralCount;
+  }
+  file.close();
+
+  if (!ok) {
+    Serial.printf("[%lu] [CPS] Invalid codepoint set %s\n", millis(), path.c_str());
+    clear();
+  }
+  return ok;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Set of Unicode codepoints, used to collect the characters a book uses so its font subset can be written (see
+ * CustomEpdFont::writeSubset).
+ *
+ * The BMP is a bitmap split into lazily allocated pages of 256 codepoints, so a book in one or two scripts costs a few
+ * kilobytes at most. Codepoints above the BMP are rare and kept in a sorted vector.
+ */
+class CodepointSet {
+ public:
+  CodepointSet() = default;
+  ~CodepointSet();
+  CodepointSet(const CodepointSet&) = delete;
+  CodepointSet& operator=(const CodepointSet&) = delete;
+
+  // Returns true if the codepoint was not in the set yet
+  bool add(uint32_t cp);
+  void addUtf8(const char* text);
+  bool contains(uint32_t cp) const;
+  size_t size() const { return count; }
+  void clear();
+  // Replaces the contents with those of other. Returns false, leaving the set empty, if memory runs out
+  bool copyFrom(const CodepointSet& other);
+
+  // Smallest codepoint in the set that is >= from, for walking the set across calls. Returns false if there is none
+  bool next(uint32_t from, uint32_t* cp) const;
+
+  // Calls fn(cp) for every codepoint in ascending order
+  template <typename Fn>
+  void forEach(Fn fn) const {
+    for (uint32_t page = 0; page < PAGE_COUNT; page++) {
+      if (!pages[page]) {
+        continue;
+      }
+      for (uint32_t word = 0; word < WORDS_PER_PAGE; word++) {
+        for (uint32_t bits = pages[page][word]; bits != 0; bits &= bits - 1) {
+          fn((page << PAGE_BITS) | (word << 5) | __builtin_ctz(bits));
+        }
+      }
+    }
+    for (const uint32_t cp : astral) {
+      fn(cp);
+    }
+  }
+
+  bool load(const std::string& path);
+  bool save(const std::string& path) const;
+
+ private:
+  static constexpr int PAGE_BITS = 8;
+  static constexpr uint32_t PAGE_SIZE = 1u << PAGE_BITS;
+  static constexpr uint32_t PAGE_COUNT = 0x10000 >> PAGE_BITS;
+  static constexpr uint32_t WORDS_PER_PAGE = PAGE_SIZE / 32;
+
+  uint32_t* pages[PAGE_COUNT] = {nullptr};
+  std::vector<uint32_t> astral;  // Sorted
+  size_t count = 0;
+};
@@ -1,59 +1,641 @@
 #include "CustomEpdFont.h"
 
+#include <Arduino.h>
 #include <HardwareSerial.h>
 #include <SDCardManager.h>
 
 #include <algorithm>
+#include <cstring>
+#include <new>
+
+uint32_t CustomEpdFont::sdReadCount = 0;
+
+bool CustomEpdFont::decodePixelRuns(const uint8_t* src, const size_t srcLength, uint8_t* dest,
+                                    const uint32_t pixelCount, const int bitsPerPixel) {
+  const int lengthBits = 8 - bitsPerPixel;
+  const uint8_t lengthMask = (1 << lengthBits) - 1;
+  uint32_t pixel = 0;
+  uint8_t acc = 0;
+  int accBits = 0;
+  for (size_t in = 0; in < srcLength; in++) {
+    const uint8_t value = src[in] >> lengthBits;
+    uint32_t run = (src[in] & lengthMask) + 1;
+    if (pixel + run > pixelCount) {
+      return false;
+    }
+    pixel += run;
+    while (run-- > 0) {
+      acc = (acc << bitsPerPixel) | value;
+      accBits += bitsPerPixel;
+      if (accBits == 8) {
+        *dest++ = acc;
+        acc = 0;
+        accBits = 0;
+      }
+    }
+  }
+  if (accBits > 0) {
+    *dest = acc << (8 - accBits);
+  }
+  return pixel == pixelCount;
+}
 
 CustomEpdFont::CustomEpdFont(const String& filePath, const EpdFontData* data, uint32_t offsetIntervals,
-                             uint32_t offsetGlyphs, uint32_t offsetBitmaps, int version)
+                             uint32_t offsetGlyphs, uint32_t offsetBitmaps, int version, size_t cacheCapacity,
+                             size_t bitmapBudget)
     : EpdFont(data),
       filePath(filePath),
       offsetIntervals(offsetIntervals),
       offsetGlyphs(offsetGlyphs),
       offsetBitmaps(offsetBitmaps),
+      bitmapCacheBudget(bitmapBudget),
+      glyphCacheCapacity(cacheCapacity),
       version(version) {
-  // Initialize bitmap cache
-  for (size_t i = 0; i < BITMAP_CACHE_CAPACITY; i++) {
-    bitmapCache[i].data = nullptr;
-    bitmapCache[i].size = 0;
-    bitmapCache[i].codePoint = 0;
-    bitmapCache[i].lastAccess = 0;
-  }
   // Initialize glyph cache
-  for (size_t i = 0; i < GLYPH_CACHE_CAPACITY; i++) {
-    glyphCache[i].codePoint = 0xFFFFFFFF;
-    glyphCache[i].lastAccess = 0;
+  if (glyphCacheCapacity == 0) {
+    // Roughly what one entry costs with the index at its maximum load of 1/2
+    constexpr size_t entryCost = sizeof(GlyphStructCacheEntry) + 4 * sizeof(uint16_t);
+    glyphCacheCapacity = ESP.getFreeHeap() / GLYPH_CACHE_HEAP_DIVISOR / entryCost;
+    glyphCacheCapacity = std::max(MIN_GLYPH_CACHE_CAPACITY, std::min(MAX_GLYPH_CACHE_CAPACITY, glyphCacheCapacity));
+  }
+  glyphCacheCapacity = std::min(MAX_GLYPH_CACHE_CAPACITY, glyphCacheCapacity);
+  while (!allocateGlyphCache(glyphCacheCapacity) && glyphCacheCapacity > 16) {
+    glyphCacheCapacity /= 2;
+  }
+  if (glyphCache) {
+    Serial.printf("[%lu] [CEF] Glyph cache: %u entries, %u index slots\n", millis(),
+                  static_cast<unsigned>(glyphCacheCapacity), static_cast<unsigned>(glyphIndex.slotCount()));
+  } else {
+    Serial.printf("[%lu] [CEF] Failed to allocate glyph cache for %s\n", millis(), filePath.c_str());
   }
 }
 
 CustomEpdFont::~CustomEpdFont() {
+  subset.reset();
   clearCache();
+  releaseHotPack();
+  delete[] glyphCache;
   if (fontFile.isOpen()) {
     fontFile.close();
   }
+  // Book subsets are loaded and dropped per book, so the font data must not outlive the font
+  free(const_cast<EpdGlyphPageTable*>(data->pageTable));
+  delete[] data->intervals;
+  delete data;
 }
 
 void CustomEpdFont::clearCache() const {
-  for (size_t i = 0; i < BITMAP_CACHE_CAPACITY; i++) {
-    if (bitmapCache[i].data) {
-      free(bitmapCache[i].data);
-      bitmapCache[i].data = nullptr;
+  free(bitmapArena);
+  bitmapArena = nullptr;
+  delete[] bitmapSlabs;
+  bitmapSlabs = nullptr;
+  delete[] bitmapSlots;
+  bitmapSlots = nullptr;
+  bitmapSlabCount = 0;
+  bitmapIndex.release();
+  free(oversizeBitmap);
+  oversizeBitmap = nullptr;
+  oversizeBitmapSize = 0;
+}
+
+bool CustomEpdFont::loadHotPack(size_t budgetBytes) {
+  releaseHotPack();
+
+  String packPath = filePath;
+  if (packPath.endsWith(".epdfont")) {
+    packPath = packPath.substring(0, packPath.length() - 8);
+  }
+  packPath += ".epdhot";
+  if (!SdMan.exists(packPath.c_str())) {
+    return false;
+  }
+  FsFile pack;
+  if (!SdMan.openFileForRead("CEF", packPath, pack)) {
+    return false;
+  }
+
+  /*
+   * Hot pack format (little endian):
+   *   0 : Magic "EPDH"
+   *   4 : Version (2) = 1
+   *   6 : Reserved (2)
+   *   8 : GlyphCount (4)
+   *   12: OffsetGlyphs of the font (4)
+   *   16: OffsetBitmaps of the font (4)
+   *   20: OffsetBitmaps of the pack (4)
+   *   24: GlyphCount records, most frequent first: codepoint (4) followed by the glyph record exactly as in the font
+   *   OffsetBitmaps: the bitmaps as stored in the font, in record order
+   * The font offsets tie the pack to the font file it was generated for.
+   */
+  uint8_t header[HOT_PACK_HEADER_SIZE];
+  if (pack.read(header, sizeof(header)) != static_cast<int>(sizeof(header))) {
+    pack.close();
+    return false;
+  }
+  const auto u32 = [](const uint8_t* b) {
+    return b[0] | (b[1] << 8) | (b[2] << 16) | (static_cast<uint32_t>(b[3]) << 24);
+  };
+  const uint32_t packGlyphCount = u32(header + 8);
+  const uint32_t recordSize = 4 + glyphRecordSize();
+  if (memcmp(header, "EPDH", 4) != 0 || (header[4] | (header[5] << 8)) != 1 || u32(header + 12) != offsetGlyphs ||
+      u32(header + 16) != offsetBitmaps || u32(header + 20) != HOT_PACK_HEADER_SIZE + packGlyphCount * recordSize) {
+    Serial.printf("[%lu] [CEF] Hot pack %s does not match the font\n", millis(), packPath.c_str());
+    pack.close();
+    return false;
+  }
+
+  if (budgetBytes == 0) {
+    budgetBytes = std::min(MAX_HOT_PACK_BUDGET, static_cast<size_t>(ESP.getFreeHeap() / HOT_PACK_HEAP_DIVISOR));
+  }
+  // Codepoint, glyph, bitmap offset and index slots at the index's maximum load of 1/2
+  constexpr size_t entryCost = sizeof(uint32_t) + sizeof(EpdGlyph) + sizeof(uint32_t) + 2 * sizeof(uint16_t);
+
+  // Records are read twice, first to find how many glyphs fit the budget and then into arrays of exactly that size.
+  // Bitmaps are in record order, so the ones kept are a single read of the start of the bitmap section.
+  uint8_t recordBuf[PREFETCH_RECORD_BUFFER_SIZE];
+  const uint32_t recordsPerRead = sizeof(recordBuf) / recordSize;
+  const uint32_t maxCount = std::min<uint32_t>(packGlyphCount, 0xFFFF);
+  size_t count = 0;
+  size_t bitmapBytes = 0;
+  size_t used = 0;
+  bool full = false;
+  while (count < maxCount && !full) {
+    const uint32_t n = std::min(recordsPerRead, static_cast<uint32_t>(maxCount - count));
+    if (pack.read(recordBuf, n * recordSize) != static_cast<int>(n * recordSize)) {
+      pack.close();
+      return false;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+      EpdGlyph glyph;
+      parseGlyphRecord(recordBuf + i * recordSize + 4, &glyph);
+      if (used + entryCost + glyph.dataLength > budgetBytes) {
+        full = true;
+        break;
+      }
+      used += entryCost + glyph.dataLength;
+      bitmapBytes += glyph.dataLength;
+      count++;
+    }
+  }
+  if (count == 0) {
+    pack.close();
+    return false;
+  }
+
+  hotCodepoints = new (std::nothrow) uint32_t[count];
+  hotGlyphs = new (std::nothrow) EpdGlyph[count];
+  hotBitmapOffsets = new (std::nothrow) uint32_t[count];
+  hotBitmaps = static_cast<uint8_t*>(malloc(std::max<size_t>(bitmapBytes, 1)));
+  if (!hotCodepoints || !hotGlyphs || !hotBitmapOffsets || !hotBitmaps || !hotIndex.allocate(count)) {
+    Serial.printf("[%lu] [CEF] Failed to allocate hot pack (%u glyphs)\n", millis(),
+                  static_cast<unsigned>(count));
+    releaseHotPack();
+    pack.close();
+    return false;
+  }
+
+  bool ok = pack.seekSet(HOT_PACK_HEADER_SIZE);
+  uint32_t bitmapOffset = 0;
+  for (size_t first = 0; ok && first < count; first += recordsPerRead) {
+    const uint32_t n = std::min(recordsPerRead, static_cast<uint32_t>(count - first));
+    ok = pack.read(recordBuf, n * recordSize) == static_cast<int>(n * recordSize);
+    for (uint32_t i = 0; ok && i < n; i++) {
+      const uint8_t* record = recordBuf + i * recordSize;
+      hotCodepoints[first + i] = u32(record);
+      parseGlyphRecord(record + 4, &hotGlyphs[first + i]);
+      hotBitmapOffsets[first + i] = bitmapOffset;
+      bitmapOffset += hotGlyphs[first + i].dataLength;
+    }
+  }
+  ok = ok && pack.seekSet(u32(header + 20)) && pack.read(hotBitmaps, bitmapBytes) == static_cast<int>(bitmapBytes);
+  pack.close();
+  if (!ok) {
+    Serial.printf("[%lu] [CEF] Failed to read hot pack %s\n", millis(), packPath.c_str());
+    releaseHotPack();
+    return false;
+  }
+
+  hotGlyphCount = count;
+  for (size_t i = 0; i < count; i++) {
+    if (findHotGlyph(hotCodepoints[i]) == nullptr) {
+      hotIndex.insert(hotCodepoints[i], static_cast<uint16_t>(i));
+    }
+  }
+  Serial.printf("[%lu] [CEF] Hot pack: %u of %u glyphs resident, %u bytes\n", millis(), static_cast<unsigned>(count),
+                packGlyphCount, static_cast<unsigned>(used));
+  return true;
+}
+
+void CustomEpdFont::attachSubset(CustomEpdFont* subsetFont) {
+  subset.reset(subsetFont);
+  if (subset) {
+    // Little is read from this font any more, give its bitmap cache back until it is needed again
+    clearCache();
+  }
+}
+
+bool CustomEpdFont::hasGlyph(const uint32_t cp) const {
+  uint32_t glyphIndex;
+  return findGlyphIndex(cp, getData(), &glyphIndex);
+}
+
+bool CustomEpdFont::ownsGlyph(const EpdGlyph* glyph) const {
+  const auto* address = reinterpret_cast<const uint8_t*>(glyph);
+  const auto* cacheStart = reinterpret_cast<const uint8_t*>(glyphCache);
+  if (glyphCache && address >= cacheStart && address < cacheStart + glyphCacheCapacity * sizeof(*glyphCache)) {
+    return true;
+  }
+  return hotGlyphBitmap(glyph) != nullptr;
+}
+
+uint32_t CustomEpdFont::totalGlyphCount() const {
+  const EpdFontData* data = getData();
+  uint32_t total = 0;
+  for (uint32_t i = 0; i < data->intervalCount; i++) {
+    const EpdUnicodeInterval& interval = data->intervals[i];
+    total = std::max(total, interval.offset + interval.last - interval.first + 1);
+  }
+  return total;
+}
+
+bool CustomEpdFont::writeSubset(const CodepointSet& codepoints, const String& path) const {
+  SubsetWriter writer(*this, path);
+  if (!writer.begin(codepoints)) {
+    return false;
+  }
+  while (!writer.done()) {
+    if (!writer.step(UINT32_MAX)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+CustomEpdFont::SubsetWriter::~SubsetWriter() {
+  if (out.isOpen()) {
+    out.close();
+    SdMan.remove(path.c_str());
+  }
+}
+
+bool CustomEpdFont::SubsetWriter::begin(const CodepointSet& source) {
+  if (!codepoints.copyFrom(source)) {
+    return false;
+  }
+  const EpdFontData* data = font.getData();
+
+  // Count the glyphs and intervals first, the header needs them
+  uint32_t intervalCount = 0;
+  uint32_t previousCp = 0;
+  codepoints.forEach([&](const uint32_t cp) {
+    uint32_t glyphIndex;
+    if (!font.findGlyphIndex(cp, data, &glyphIndex)) {
+      return;
+    }
+    if (glyphCount == 0 || cp != previousCp + 1) {
+      intervalCount++;
     }
-    bitmapCache[i].size = 0;
+    previousCp = cp;
+    glyphCount++;
+  });
+  if (glyphCount == 0) {
+    return false;
+  }
+
+  if (!SdMan.openFileForWrite("CEF", path, out)) {
+    return false;
+  }
+
+  // Same 32 byte header as the v1 files FontManager loads
+  const uint32_t subsetOffsetIntervals = 32;
+  const uint32_t subsetOffsetGlyphs = subsetOffsetIntervals + intervalCount * sizeof(EpdUnicodeInterval);
+  const uint32_t subsetOffsetBitmaps = subsetOffsetGlyphs + glyphCount * 16;
+  uint8_t header[32] = {'E', 'P', 'D', 'F'};
+  header[4] = font.version == 2 ? 2 : 1;
+  header[6] = data->is2Bit ? 1 : 0;
+  header[8] = data->advanceY;
+  header[9] = static_cast<uint8_t>(data->ascender);
+  header[10] = static_cast<uint8_t>(data->descender);
+  const uint32_t headerFields[] = {intervalCount, glyphCount, subsetOffsetIntervals, subsetOffsetGlyphs,
+                                   subsetOffsetBitmaps};
+  memcpy(header + 12, headerFields, sizeof(headerFields));
+  if (out.write(header, sizeof(header)) != sizeof(header)) {
+    fail();
+    return false;
+  }
+  return true;
+}
+
+bool CustomEpdFont::SubsetWriter::step(const uint32_t glyphs) {
+  for (uint32_t moved = 0; phase != Phase::Done && moved < glyphs;) {
+    // Not begun, or failed
+    if (!out.isOpen()) {
+      return false;
+    }
+    uint32_t cp;
+    uint32_t glyphIndex;
+    if (!nextGlyph(&cp, &glyphIndex)) {
+      if (!finishPhase()) {
+        fail();
+      }
+      continue;
+    }
+    moved++;
+    bool ok = false;
+    switch (phase) {
+      case Phase::Intervals:
+        ok = addInterval(cp);
+        break;
+      case Phase::Records:
+        ok = writeRecord(glyphIndex);
+        break;
+      case Phase::Bitmaps:
+        ok = addBitmap(glyphIndex);
+        break;
+      case Phase::Done:
+        break;
+    }
+    if (!ok) {
+      fail();
+    }
+  }
+  return phase == Phase::Done || out.isOpen();
+}
+
+bool CustomEpdFont::SubsetWriter::nextGlyph(uint32_t* cp, uint32_t* glyphIndex) {
+  while (codepoints.next(cursor, cp)) {
+    cursor = *cp + 1;
+    if (font.findGlyphIndex(*cp, font.getData(), glyphIndex)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool CustomEpdFont::SubsetWriter::sourceGlyph(const uint32_t glyphIndex, EpdGlyph* glyph) {
+  const uint32_t stride = font.glyphRecordSize();
+  if (glyphIndex < bufferFirst || glyphIndex >= bufferFirst + bufferCount) {
+    bufferFirst = glyphIndex;
+    bufferCount = std::min<uint32_t>(sizeof(recordBuf) / stride, font.totalGlyphCount() - glyphIndex);
+    if (!font.readGlyphRecords(bufferFirst, bufferCount, recordBuf)) {
+      bufferCount = 0;
+      return false;
+    }
+  }
+  font.parseGlyphRecord(recordBuf + (glyphIndex - bufferFirst) * stride, glyph);
+  return true;
+}
+
+bool CustomEpdFont::SubsetWriter::addInterval(const uint32_t cp) {
+  bool ok = true;
+  if (subsetIndex > 0 && cp != interval.last + 1) {
+    ok = out.write(reinterpret_cast<const uint8_t*>(&interval), sizeof(interval)) == sizeof(interval);
+  }
+  if (subsetIndex == 0 || cp != interval.last + 1) {
+    interval = {cp, cp, subsetIndex};
+  }
+  interval.last = cp;
+  subsetIndex++;
+  return ok;
+}
+
+bool CustomEpdFont::SubsetWriter::writeRecord(const uint32_t glyphIndex) {
+  EpdGlyph glyph;
+  if (!sourceGlyph(glyphIndex, &glyph)) {
+    return false;
+  }
+  uint8_t record[16] = {glyph.width, glyph.height, glyph.advanceX, 0};
+  memcpy(record + 4, &glyph.left, 2);
+  memcpy(record + 6, &glyph.top, 2);
+  memcpy(record + 8, &glyph.dataLength, 4);
+  memcpy(record + 12, &subsetDataOffset, 4);
+  subsetDataOffset += glyph.dataLength;
+  return out.write(record, sizeof(record)) == sizeof(record);
+}
+
+bool CustomEpdFont::SubsetWriter::addBitmap(const uint32_t glyphIndex) {
+  EpdGlyph glyph;
+  if (!sourceGlyph(glyphIndex, &glyph)) {
+    return false;
+  }
+  if (runLength > 0 &&
+      (glyph.dataOffset != runOffset + runLength || runLength + glyph.dataLength > BITMAP_SLAB_SIZE)) {
+    if (!copyBitmaps()) {
+      return false;
+    }
+    runLength = 0;
+  }
+  if (runLength == 0) {
+    runOffset = glyph.dataOffset;
+  }
+  runLength += glyph.dataLength;
+  return true;
+}
+
+bool CustomEpdFont::SubsetWriter::copyBitmaps() {
+  // The font may have dropped its scratch buffer since the last step
+  if (runLength > 0 && !font.ensureScratchBitmap(BITMAP_SLAB_SIZE)) {
+    return false;
+  }
+  for (uint32_t done = 0; done < runLength; done += BITMAP_SLAB_SIZE) {
+    const uint32_t chunk = std::min<uint32_t>(BITMAP_SLAB_SIZE, runLength - done);
+    if (!font.readBitmap(runOffset + done, font.oversizeBitmap, chunk) ||
+        out.write(font.oversizeBitmap, chunk) != chunk) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CustomEpdFont::SubsetWriter::finishPhase() {
+  cursor = 0;
+  switch (phase) {
+    case Phase::Intervals:
+      phase = Phase::Records;
+      return out.write(reinterpret_cast<const uint8_t*>(&interval), sizeof(interval)) == sizeof(interval);
+    case Phase::Records:
+      phase = Phase::Bitmaps;
+      return true;
+    case Phase::Bitmaps:
+      if (!copyBitmaps()) {
+        return false;
+      }
+      out.close();
+      phase = Phase::Done;
+      Serial.printf("[%lu] [CEF] Wrote subset %s: %u glyphs, %u bitmap bytes\n", millis(), path.c_str(), glyphCount,
+                    subsetDataOffset);
+      return true;
+    case Phase::Done:
+      break;
+  }
+  return true;
+}
+
+void CustomEpdFont::SubsetWriter::fail() {
+  Serial.printf("[%lu] [CEF] Failed to write subset %s\n", millis(), path.c_str());
+  out.close();
+  SdMan.remove(path.c_str());
+}
+
+void CustomEpdFont::releaseHotPack() {
+  delete[] hotCodepoints;
+  hotCodepoints = nullptr;
+  delete[] hotGlyphs;
+  hotGlyphs = nullptr;
+  delete[] hotBitmapOffsets;
+  hotBitmapOffsets = nullptr;
+  free(hotBitmaps);
+  hotBitmaps = nullptr;
+  hotIndex.release();
+  hotGlyphCount = 0;
+}
+
+const EpdGlyph* CustomEpdFont::findHotGlyph(const uint32_t cp) const {
+  if (hotGlyphCount == 0) {
+    return nullptr;
+  }
+  const int entry = hotIndex.find(cp, [this](const size_t i) { return hotCodepoints[i]; });
+  return entry == GlyphCacheIndex::NOT_FOUND ? nullptr : &hotGlyphs[entry];
+}
+
+const uint8_t* CustomEpdFont::hotGlyphBitmap(const EpdGlyph* glyph) const {
+  if (hotGlyphCount == 0 || glyph < hotGlyphs || glyph >= hotGlyphs + hotGlyphCount) {
+    return nullptr;
+  }
+  return hotBitmaps + hotBitmapOffsets[glyph - hotGlyphs];
+}
+
+bool CustomEpdFont::allocateGlyphCache(const size_t capacity) {
+  delete[] glyphCache;
+  glyphCache = new (std::nothrow) GlyphStructCacheEntry[capacity];
+  if (!glyphCache || !glyphIndex.allocate(capacity)) {
+    delete[] glyphCache;
+    glyphCache = nullptr;
+    return false;
+  }
+  glyphCacheUsed = 0;
+  clockHand = 0;
+  return true;
+}
+
+const EpdGlyph* CustomEpdFont::findCachedGlyph(const uint32_t cp) const {
+  const int entry = glyphIndex.find(cp, [this](const size_t i) { return glyphCache[i].codePoint; });
+  if (entry == GlyphCacheIndex::NOT_FOUND) {
+    return nullptr;
+  }
+  glyphCache[entry].referenced = true;
+  return &glyphCache[entry].glyph;
+}
+
+GlyphStructCacheEntry* CustomEpdFont::claimGlyphCacheEntry(const uint32_t cp) const {
+  size_t entryIndex;
+  if (glyphCacheUsed < glyphCacheCapacity) {
+    entryIndex = glyphCacheUsed++;
+  } else {
+    // Clock eviction: give entries referenced since the last sweep a second chance
+    while (glyphCache[clockHand].referenced) {
+      glyphCache[clockHand].referenced = false;
+      clockHand = (clockHand + 1) % glyphCacheCapacity;
+    }
+    entryIndex = clockHand;
+    clockHand = (clockHand + 1) % glyphCacheCapacity;
+    glyphIndex.erase(glyphCache[entryIndex].codePoint, [this](const size_t i) { return glyphCache[i].codePoint; });
+  }
+  glyphIndex.insert(cp, static_cast<uint16_t>(entryIndex));
+
+  GlyphStructCacheEntry& entry = glyphCache[entryIndex];
+  entry.codePoint = cp;
+  entry.referenced = false;
+  return &entry;
+}
+
+bool CustomEpdFont::findGlyphIndex(const uint32_t cp, const EpdFontData* data, uint32_t* glyphIndex) const {
+  return EpdFont::findGlyphIndex(data, cp, glyphIndex);
+}
+
+uint32_t CustomEpdFont::fallbackCodepoint(const uint32_t cp) {
+  if (cp == 0x2018 || cp == 0x2019) {  // Left/Right single quote
+    return 0x0027;                     // ASCII apostrophe
+  }
+  if (cp == 0x201C || cp == 0x201D) {  // Left/Right double quote
+    return 0x0022;                     // ASCII double quote
+  }
+  if (cp == 160) {  // Non-breaking space
+    return 32;      // Space
+  }
+  return 0;
+}
+
+bool CustomEpdFont::readGlyphRecords(const uint32_t firstIndex, const uint32_t count, uint8_t* dest) const {
+  const uint32_t glyphFileOffset = offsetGlyphs + firstIndex * glyphRecordSize();
+
+  if (!fontFile.isOpen()) {
+    if (!SdMan.openFileForRead("CustomFont", filePath.c_str(), fontFile)) {
+      Serial.printf("CustomEpdFont: Failed to open file %s\n", filePath.c_str());
+      return false;
+    }
+  }
+
+  if (!fontFile.seekSet(glyphFileOffset)) {
+    Serial.printf("CustomEpdFont: Failed to seek to glyph offset %u\n", glyphFileOffset);
+    fontFile.close();
+    return false;
+  }
+
+  const size_t length = count * glyphRecordSize();
+  sdReadCount++;
+  if (fontFile.read(dest, length) != static_cast<int>(length)) {
+    Serial.printf("CustomEpdFont: Read failed (glyph entry v%d)\n", version);
+    fontFile.close();
+    return false;
+  }
+  return true;
+}
+
+void CustomEpdFont::parseGlyphRecord(const uint8_t* glyphBuf, EpdGlyph* glyph) const {
+  if (version >= 1) {
+    // New format (16 bytes)
+    /*
+      view.setUint8(offset++, glyph.width);
+      view.setUint8(offset++, glyph.height);
+      view.setUint8(offset++, glyph.advanceX);
+      view.setUint8(offset++, 0);
+      view.setInt16(offset, glyph.left, true);
+      offset += 2;
+      view.setInt16(offset, glyph.top, true);
+      offset += 2;
+      view.setUint32(offset, glyph.dataLength, true);
+      offset += 4;
+      view.setUint32(offset, glyph.dataOffset, true);
+      offset += 4;
+    */
+    glyph->width = glyphBuf[0];
+    glyph->height = glyphBuf[1];
+    glyph->advanceX = glyphBuf[2];
+    // glyphBuf[3] reserved
+    glyph->left = (int16_t)(glyphBuf[4] | (glyphBuf[5] << 8));  // Little endian int16
+    glyph->top = (int16_t)(glyphBuf[6] | (glyphBuf[7] << 8));   // Little endian int16
+    glyph->dataLength = glyphBuf[8] | (glyphBuf[9] << 8) | (glyphBuf[10] << 16) | (glyphBuf[11] << 24);
+    glyph->dataOffset = glyphBuf[12] | (glyphBuf[13] << 8) | (glyphBuf[14] << 16) | (glyphBuf[15] << 24);
+  } else {
+    // Old format (13 bytes)
+    glyph->width = glyphBuf[0];
+    glyph->height = glyphBuf[1];
+    glyph->advanceX = glyphBuf[2];
+    glyph->left = (int8_t)glyphBuf[3];
+    // glyphBuf[4] unused
+    glyph->top = (int8_t)glyphBuf[5];
+    // glyphBuf[6] unused
+    glyph->dataLength = glyphBuf[7] | (glyphBuf[8] << 8);
+    glyph->dataOffset = glyphBuf[9] | (glyphBuf[10] << 8) | (glyphBuf[11] << 16) | (glyphBuf[12] << 24);
   }
 }
 
 const EpdGlyph* CustomEpdFont::getGlyph(uint32_t cp, const EpdFontStyles::Style style) const {
   // Serial.printf("CustomEpdFont::getGlyph cp=%u style=%d this=%p\n", cp, style, this);
 
-  // Check glyph cache first
-  for (size_t i = 0; i < GLYPH_CACHE_CAPACITY; i++) {
-    if (glyphCache[i].codePoint == cp) {
-      glyphCache[i].lastAccess = ++currentAccessCount;
-      // Serial.printf("  Cache hit: %p\n", &glyphCache[i].glyph);
-      return &glyphCache[i].glyph;
-    }
+  if (!glyphCache) {
+    return nullptr;
   }
 
   const EpdFontData* data = getData(style);
@@ -62,285 +644,508 @@ const EpdGlyph* CustomEpdFont::getGlyph(uint32_t cp, const EpdFontStyles::Style
     return nullptr;
   }
 
-  const EpdUnicodeInterval* intervals = data->intervals;
-  const int count = data->intervalCount;
-
   uint32_t currentCp = cp;
   bool triedFallback = false;
 
   // Loop to allow for fallback attempts
   while (true) {
-    // Check glyph cache first
-    for (size_t i = 0; i < GLYPH_CACHE_CAPACITY; i++) {
-      if (glyphCache[i].codePoint == currentCp) {
-        glyphCache[i].lastAccess = ++currentAccessCount;
-        // Serial.printf("  Cache hit: %p\n", &glyphCache[i].glyph);
-        return &glyphCache[i].glyph;
-      }
+    // Hot pack and glyph cache first
+    if (const EpdGlyph* hot = findHotGlyph(currentCp)) {
+      hotPackHits++;
+      return hot;
     }
-
-    const EpdFontData* data = getData(style);
-    if (!data) {
-      Serial.println("CustomEpdFont::getGlyph: No data!");
-      return nullptr;
+    if (subset && subset->hasGlyph(currentCp)) {
+      return subset->getGlyph(currentCp, style);
+    }
+    if (const EpdGlyph* cached = findCachedGlyph(currentCp)) {
+      glyphCacheHits++;
+      return cached;
     }
 
-    const EpdUnicodeInterval* intervals = data->intervals;
-    const int count = data->intervalCount;
-
-    int left = 0;
-    int right = count - 1;
-
-    bool foundInterval = false;
-    uint32_t glyphIndex = 0;
-    const EpdUnicodeInterval* foundIntervalPtr = nullptr;
+    uint32_t glyphIndex;
+    if (findGlyphIndex(currentCp, data, &glyphIndex)) {
+      uint8_t glyphBuf[MAX_GLYPH_RECORD_SIZE];
+      if (!readGlyphRecords(glyphIndex, 1, glyphBuf)) {
+        return nullptr;
+      }
 
-    while (left <= right) {
-      const int mid = left + (right - left) / 2;
-      const EpdUnicodeInterval* interval = &intervals[mid];
+      // Populate cache
+      glyphCacheMisses++;
+      GlyphStructCacheEntry* entry = claimGlyphCacheEntry(currentCp);
+      parseGlyphRecord(glyphBuf, &entry->glyph);
 
-      if (currentCp < interval->first) {
-        right = mid - 1;
-      } else if (currentCp > interval->last) {
-        left = mid + 1;
-      } else {
-        // Found interval. Calculate index.
-        glyphIndex = interval->offset + (currentCp - interval->first);
-        foundIntervalPtr = interval;
-        foundInterval = true;
-        break;
-      }
+      // Serial.printf("  Loaded to cache: %p\n", &entry->glyph);
+      return &entry->glyph;
     }
 
-    if (foundInterval) {
-      uint32_t stride = (version == 1) ? 16 : 13;
-      uint32_t glyphFileOffset = offsetGlyphs + (glyphIndex * stride);
+    // Not found in intervals. Try fallback.
+    const uint32_t fallbackCp = fallbackCodepoint(currentCp);
+    if (!triedFallback && fallbackCp != 0) {
+      currentCp = fallbackCp;
+      triedFallback = true;
+      continue;  // Retry with fallback CP
+    }
 
-      if (!fontFile.isOpen()) {
-        if (!SdMan.openFileForRead("CustomFont", filePath.c_str(), fontFile)) {
-          Serial.printf("CustomEpdFont: Failed to open file %s\n", filePath.c_str());
-          return nullptr;
-        }
-      }
+    return nullptr;
+  }
+}
 
-      if (!fontFile.seekSet(glyphFileOffset)) {
-        Serial.printf("CustomEpdFont: Failed to seek to glyph offset %u\n", glyphFileOffset);
-        fontFile.close();
-        return nullptr;
-      }
+void CustomEpdFont::prefetchGlyphs(const uint32_t* codepoints, const size_t count,
+                                   const EpdFontStyles::Style style) const {
+  const EpdFontData* data = getData(style);
+  if (!glyphCache || !data || count == 0) {
+    return;
+  }
+  if (!subset) {
+    prefetchOwnGlyphs(codepoints, count, data);
+    return;
+  }
 
-      uint8_t w, h, adv, res = 0;
-      int16_t l, t = 0;
-      uint32_t dLen, dOffset = 0;
-
-      if (version == 1) {
-        // New format (16 bytes)
-        uint8_t glyphBuf[16];
-        if (fontFile.read(glyphBuf, 16) != 16) {
-          Serial.println("CustomEpdFont: Read failed (glyph entry v1)");
-          fontFile.close();
-          return nullptr;
-        }
+  // Split the page between the subset and this font, in drawing order. Hot pack glyphs need neither.
+  std::vector<uint32_t> subsetCps;
+  std::vector<uint32_t> ownCps;
+  subsetCps.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    if (findHotGlyph(codepoints[i])) {
+      continue;
+    }
+    (subset->hasGlyph(codepoints[i]) ? subsetCps : ownCps).push_back(codepoints[i]);
+  }
+  if (!subsetCps.empty()) {
+    subset->prefetchGlyphs(subsetCps.data(), subsetCps.size(), style);
+  }
+  if (!ownCps.empty()) {
+    prefetchOwnGlyphs(ownCps.data(), ownCps.size(), data);
+  }
+}
 
-        /*
-          view.setUint8(offset++, glyph.width);
-          view.setUint8(offset++, glyph.height);
-          view.setUint8(offset++, glyph.advanceX);
-          view.setUint8(offset++, 0);
-          view.setInt16(offset, glyph.left, true);
-          offset += 2;
-          view.setInt16(offset, glyph.top, true);
-          offset += 2;
-          view.setUint32(offset, glyph.dataLength, true);
-          offset += 4;
-          view.setUint32(offset, glyph.dataOffset, true);
-          offset += 4;
-        */
-
-        w = glyphBuf[0];
-        h = glyphBuf[1];
-        adv = glyphBuf[2];
-        res = glyphBuf[3];
-        l = (int16_t)(glyphBuf[4] | (glyphBuf[5] << 8));  // Little endian int16
-        t = (int16_t)(glyphBuf[6] | (glyphBuf[7] << 8));  // Little endian int16
-        dLen = glyphBuf[8] | (glyphBuf[9] << 8) | (glyphBuf[10] << 16) | (glyphBuf[11] << 24);
-        dOffset = glyphBuf[12] | (glyphBuf[13] << 8) | (glyphBuf[14] << 16) | (glyphBuf[15] << 24);
+void CustomEpdFont::prefetchOwnGlyphs(const uint32_t* codepoints, const size_t count,
+                                      const EpdFontData* data) const {
+  // Glyphs are selected in the order they are drawn: when a page holds more glyphs than the caches do, the ones
+  // drawn first are prefetched and the rest load on demand as before
+  std::vector<uint32_t> uniqueCps(codepoints, codepoints + count);
+  std::sort(uniqueCps.begin(), uniqueCps.end());
+  uniqueCps.erase(std::unique(uniqueCps.begin(), uniqueCps.end()), uniqueCps.end());
+  std::vector<bool> seen(uniqueCps.size(), false);
 
-      } else {
-        // Old format (13 bytes)
-        uint8_t glyphBuf[13];
-        if (fontFile.read(glyphBuf, 13) != 13) {
-          Serial.println("CustomEpdFont: Read failed (glyph entry)");
-          fontFile.close();
-          return nullptr;
-        }
+  // Glyph table pass: collect the records that are not cached yet. The glyphs taken for the page must fit in part of
+  // the cache, or prefetching would evict its own entries.
+  struct PendingGlyph {
+    uint32_t glyphIndex;
+    uint32_t cp;
+    size_t pageIndex;
+  };
+  std::vector<PendingGlyph> pendingGlyphs;
+  std::vector<EpdGlyph> pageGlyphs;  // In drawing order, dataLength 0 for glyphs without a bitmap to prefetch
+  pageGlyphs.reserve(uniqueCps.size());
+  size_t glyphsLeft = glyphCacheCapacity * 3 / 4;
+  for (size_t i = 0; i < count && glyphsLeft > 0; i++) {
+    const uint32_t cp = codepoints[i];
+    const size_t uniqueIndex = std::lower_bound(uniqueCps.begin(), uniqueCps.end(), cp) - uniqueCps.begin();
+    if (seen[uniqueIndex]) {
+      continue;
+    }
+    seen[uniqueIndex] = true;
+    if (findHotGlyph(cp)) {
+      continue;  // Resident already
+    }
 
-        w = glyphBuf[0];
-        h = glyphBuf[1];
-        adv = glyphBuf[2];
-        l = (int8_t)glyphBuf[3];
-        // glyphBuf[4] unused
-        t = (int8_t)glyphBuf[5];
-        // glyphBuf[6] unused
-        dLen = glyphBuf[7] | (glyphBuf[8] << 8);
-        dOffset = glyphBuf[9] | (glyphBuf[10] << 8) | (glyphBuf[11] << 16) | (glyphBuf[12] << 24);
+    uint32_t resolvedCp = cp;
+    const EpdGlyph* cached = findCachedGlyph(cp);
+    uint32_t glyphIndex = 0;
+    if (!cached && !findGlyphIndex(cp, data, &glyphIndex)) {
+      resolvedCp = fallbackCodepoint(cp);
+      if (resolvedCp == 0) {
+        continue;
       }
+      cached = findCachedGlyph(resolvedCp);
+      if (!cached && !findGlyphIndex(resolvedCp, data, &glyphIndex)) {
+        continue;
+      }
+    }
+    glyphsLeft--;
+    if (cached) {
+      pageGlyphs.push_back(*cached);
+    } else {
+      pendingGlyphs.push_back({glyphIndex, resolvedCp, pageGlyphs.size()});
+      pageGlyphs.push_back({});
+    }
+  }
 
-      /*
-      Serial.printf("[CEF] Parsed Glyph %u: Off=%u, Len=%u, W=%u, H=%u, L=%d, T=%d\n",
-                    glyphIndex, dOffset, dLen, w, h, l, t);
-      */
+  // Read the missing records in file order, reading through small gaps instead of seeking over them
+  std::sort(pendingGlyphs.begin(), pendingGlyphs.end(),
+            [](const PendingGlyph& a, const PendingGlyph& b) { return a.glyphIndex < b.glyphIndex; });
+  const uint32_t stride = glyphRecordSize();
+  uint8_t recordBuf[PREFETCH_RECORD_BUFFER_SIZE];
+  for (size_t runStart = 0; runStart < pendingGlyphs.size();) {
+    const uint32_t firstIndex = pendingGlyphs[runStart].glyphIndex;
+    size_t runEnd = runStart + 1;
+    while (runEnd < pendingGlyphs.size() &&
+           (pendingGlyphs[runEnd].glyphIndex + 1 - firstIndex) * stride <= sizeof(recordBuf) &&
+           (pendingGlyphs[runEnd].glyphIndex - pendingGlyphs[runEnd - 1].glyphIndex) * stride <= PREFETCH_MAX_GAP) {
+      runEnd++;
+    }
 
-      // Removed individual reads since we read all 13 bytes
+    if (!readGlyphRecords(firstIndex, pendingGlyphs[runEnd - 1].glyphIndex + 1 - firstIndex, recordBuf)) {
+      return;
+    }
+    for (size_t i = runStart; i < runEnd; i++) {
+      // Two codepoints can share a glyph through the fallbacks
+      if (i > runStart && pendingGlyphs[i].glyphIndex == pendingGlyphs[i - 1].glyphIndex) {
+        pageGlyphs[pendingGlyphs[i].pageIndex] = pageGlyphs[pendingGlyphs[i - 1].pageIndex];
+        continue;
+      }
+      glyphCacheMisses++;
+      GlyphStructCacheEntry* entry = claimGlyphCacheEntry(pendingGlyphs[i].cp);
+      entry->referenced = true;  // About to be drawn, keep it through the next clock sweep
+      parseGlyphRecord(recordBuf + (pendingGlyphs[i].glyphIndex - firstIndex) * stride, &entry->glyph);
+      pageGlyphs[pendingGlyphs[i].pageIndex] = entry->glyph;
+    }
+    runStart = runEnd;
+  }
 
-      // fontFile.close();  // Keep file open for performance
+  // Bitmap pass: same idea, bounded so the page's bitmaps fit in part of the arena together
+  if (!bitmapArena && !allocateBitmapArena()) {
+    return;
+  }
+  struct PendingBitmap {
+    EpdGlyph glyph;
+    uint32_t decodedLength;
+  };
+  std::vector<PendingBitmap> pendingBitmaps;
+  size_t bytesLeft = bitmapSlabCount * BITMAP_SLAB_SIZE * 3 / 4;
+  const auto keyOf = [this](const size_t s) { return bitmapSlots[s].dataOffset; };
+  for (const EpdGlyph& glyph : pageGlyphs) {
+    const uint32_t decodedLength = decodedBitmapLength(glyph);
+    const int sizeClass = bitmapSizeClass(decodedLength);
+    if (glyph.dataLength == 0 || sizeClass < 0) {
+      continue;
+    }
+    const size_t slotSize = MIN_BITMAP_SLOT_SIZE << sizeClass;
+    if (slotSize > bytesLeft) {
+      break;
+    }
+    bytesLeft -= slotSize;
+    const int slot = bitmapIndex.find(glyph.dataOffset, keyOf);
+    if (slot != GlyphCacheIndex::NOT_FOUND) {
+      // Mark it recently used so the prefetch below does not evict it
+      bitmapSlots[slot].lastAccess = ++currentAccessCount;
+      bitmapSlabs[slot / MAX_SLOTS_PER_SLAB].lastAccess = currentAccessCount;
+    } else {
+      pendingBitmaps.push_back({glyph, decodedLength});
+    }
+  }
+  if (pendingBitmaps.empty()) {
+    return;
+  }
 
-      // Find slot in glyph cache (LRU)
-      int slotIndex = -1;
-      uint32_t minAccess = 0xFFFFFFFF;
-      for (size_t i = 0; i < GLYPH_CACHE_CAPACITY; i++) {
-        if (glyphCache[i].codePoint == 0xFFFFFFFF) {
-          slotIndex = i;
-          break;
-        }
-        if (glyphCache[i].lastAccess < minAccess) {
-          minAccess = glyphCache[i].lastAccess;
-          slotIndex = i;
-        }
+  std::sort(pendingBitmaps.begin(), pendingBitmaps.end(),
+            [](const PendingBitmap& a, const PendingBitmap& b) { return a.glyph.dataOffset < b.glyph.dataOffset; });
+  if (!ensureScratchBitmap(BITMAP_SLAB_SIZE)) {
+    return;
+  }
+  for (size_t runStart = 0; runStart < pendingBitmaps.size();) {
+    const uint32_t runOffset = pendingBitmaps[runStart].glyph.dataOffset;
+    uint32_t runLength = pendingBitmaps[runStart].glyph.dataLength;
+    size_t runEnd = runStart + 1;
+    while (runEnd < pendingBitmaps.size()) {
+      const EpdGlyph& next = pendingBitmaps[runEnd].glyph;
+      const uint32_t nextEnd = std::max(runOffset + runLength, next.dataOffset + next.dataLength);
+      if (next.dataOffset > runOffset + runLength + PREFETCH_MAX_GAP || nextEnd - runOffset > BITMAP_SLAB_SIZE) {
+        break;
       }
+      runLength = nextEnd - runOffset;
+      runEnd++;
+    }
 
-      // Populate cache
-      glyphCache[slotIndex].codePoint = currentCp;
-      glyphCache[slotIndex].lastAccess = ++currentAccessCount;
-      glyphCache[slotIndex].glyph.dataOffset = dOffset;
-      glyphCache[slotIndex].glyph.dataLength = dLen;
-      glyphCache[slotIndex].glyph.width = w;
-      glyphCache[slotIndex].glyph.height = h;
-      glyphCache[slotIndex].glyph.advanceX = adv;
-      glyphCache[slotIndex].glyph.left = l;
-      glyphCache[slotIndex].glyph.top = t;
-
-      // Serial.printf("  Loaded to cache[%d]: %p\n", slotIndex, &glyphCache[slotIndex].glyph);
-      return &glyphCache[slotIndex].glyph;
+    if (!readBitmap(runOffset, oversizeBitmap, runLength)) {
+      return;
     }
-    // Not found in intervals. Try fallback.
-    if (!triedFallback) {
-      if (currentCp == 0x2018 || currentCp == 0x2019) {  // Left/Right single quote
-        currentCp = 0x0027;                              // ASCII apostrophe
-        triedFallback = true;
-        continue;                                               // Retry with fallback CP
-      } else if (currentCp == 0x201C || currentCp == 0x201D) {  // Left/Right double quote
-        currentCp = 0x0022;                                     // ASCII double quote
-        triedFallback = true;
-        continue;                     // Retry with fallback CP
-      } else if (currentCp == 160) {  // Non-breaking space
-        currentCp = 32;               // Space
-        triedFallback = true;
+    for (size_t i = runStart; i < runEnd; i++) {
+      const EpdGlyph& glyph = pendingBitmaps[i].glyph;
+      if (i > runStart && glyph.dataOffset == pendingBitmaps[i - 1].glyph.dataOffset) {
         continue;
       }
+      bitmapCacheMisses++;
+      const uint32_t decodedLength = pendingBitmaps[i].decodedLength;
+      const int slot = claimBitmapSlot(bitmapSizeClass(decodedLength));
+      const uint8_t* stored = oversizeBitmap + (glyph.dataOffset - runOffset);
+      if (glyph.dataLength < decodedLength) {
+        if (!decodeGlyphBitmap(glyph, stored, bitmapSlotData(slot))) {
+          continue;  // The slot stays free
+        }
+      } else {
+        memcpy(bitmapSlotData(slot), stored, glyph.dataLength);
+      }
+      bitmapSlots[slot].dataOffset = glyph.dataOffset;
+      bitmapSlots[slot].lastAccess = ++currentAccessCount;
+      bitmapSlabs[slot / MAX_SLOTS_PER_SLAB].lastAccess = currentAccessCount;
+      bitmapIndex.insert(glyph.dataOffset, static_cast<uint16_t>(slot));
     }
+    runStart = runEnd;
+  }
+}
 
-    return nullptr;
+bool CustomEpdFont::allocateBitmapArena() const {
+  if (bitmapArenaFailed) {
+    return false;
+  }
+
+  size_t budget = bitmapCacheBudget;
+  if (budget == 0) {
+    const EpdFontData* fontData = getData();
+    const size_t emPixels = static_cast<size_t>(fontData->advanceY) * fontData->advanceY;
+    const size_t emBytes = (emPixels * (fontData->is2Bit ? 2 : 1) + 7) / 8;
+    budget = std::max(MIN_BITMAP_CACHE_BUDGET, std::min(MAX_BITMAP_CACHE_BUDGET, emBytes * BITMAP_CACHE_GLYPHS));
+  }
+  budget = std::min(budget, static_cast<size_t>(ESP.getFreeHeap()) / 4);
+
+  size_t slabs = std::max<size_t>(1, budget / BITMAP_SLAB_SIZE);
+  while (slabs > 0) {
+    bitmapArena = static_cast<uint8_t*>(malloc(slabs * BITMAP_SLAB_SIZE));
+    bitmapSlabs = new (std::nothrow) BitmapCacheSlab[slabs];
+    bitmapSlots = new (std::nothrow) BitmapCacheSlot[slabs * MAX_SLOTS_PER_SLAB];
+    if (bitmapArena && bitmapSlabs && bitmapSlots && bitmapIndex.allocate(slabs * MAX_SLOTS_PER_SLAB)) {
+      break;
+    }
+    clearCache();
+    slabs /= 2;
+  }
+  if (slabs == 0) {
+    Serial.printf("[%lu] [CEF] Failed to allocate bitmap cache for %s\n", millis(), filePath.c_str());
+    bitmapArenaFailed = true;
+    return false;
   }
 
-  return nullptr;
+  bitmapSlabCount = slabs;
+  Serial.printf("[%lu] [CEF] Bitmap cache: %u slabs of %u bytes\n", millis(), static_cast<unsigned>(slabs),
+                static_cast<unsigned>(BITMAP_SLAB_SIZE));
+  return true;
 }
 
-const uint8_t* CustomEpdFont::loadGlyphBitmap(const EpdGlyph* glyph, uint8_t* buffer,
-                                              const EpdFontStyles::Style style) const {
-  if (!glyph) return nullptr;
-  // Serial.printf("CustomEpdFont::loadGlyphBitmap glyph=%p len=%u\n", glyph, glyph->dataLength);
+uint8_t* CustomEpdFont::bitmapSlotData(const size_t slot) const {
+  const size_t slab = slot / MAX_SLOTS_PER_SLAB;
+  const size_t slotSize = MIN_BITMAP_SLOT_SIZE << bitmapSlabs[slab].sizeClass;
+  return bitmapArena + slab * BITMAP_SLAB_SIZE + (slot % MAX_SLOTS_PER_SLAB) * slotSize;
+}
 
-  if (glyph->dataLength == 0) {
-    return nullptr;  // Empty glyph
-  }
-  if (glyph->dataLength > 32768) {
-    Serial.printf("CustomEpdFont: Glyph too large (%u)\n", glyph->dataLength);
-    return nullptr;
+void CustomEpdFont::releaseBitmapSlab(const size_t slab) const {
+  for (size_t i = slab * MAX_SLOTS_PER_SLAB; i < (slab + 1) * MAX_SLOTS_PER_SLAB; i++) {
+    if (bitmapSlots[i].dataOffset != 0xFFFFFFFF) {
+      bitmapIndex.erase(bitmapSlots[i].dataOffset, [this](const size_t s) { return bitmapSlots[s].dataOffset; });
+      bitmapSlots[i].dataOffset = 0xFFFFFFFF;
+    }
   }
+  bitmapSlabs[slab].sizeClass = -1;
+}
 
-  // Serial.printf("[CEF] loadGlyphBitmap: len=%u, off=%u\n", glyph->dataLength, glyph->dataOffset);
+int CustomEpdFont::claimBitmapSlot(const int sizeClass) const {
+  const size_t slotsPerSlab = BITMAP_SLAB_SIZE / (MIN_BITMAP_SLOT_SIZE << sizeClass);
 
-  uint32_t offset = glyph->dataOffset;
+  // Free slot of this class, or else its least recently used one
+  int lruSlot = -1;
+  uint32_t lruAccess = 0xFFFFFFFF;
+  int freeSlab = -1;
+  for (size_t slab = 0; slab < bitmapSlabCount; slab++) {
+    if (bitmapSlabs[slab].sizeClass == -1) {
+      if (freeSlab == -1) {
+        freeSlab = slab;
+      }
+      continue;
+    }
+    if (bitmapSlabs[slab].sizeClass != sizeClass) {
+      continue;
+    }
+    for (size_t i = slab * MAX_SLOTS_PER_SLAB; i < slab * MAX_SLOTS_PER_SLAB + slotsPerSlab; i++) {
+      if (bitmapSlots[i].dataOffset == 0xFFFFFFFF) {
+        return i;
+      }
+      if (bitmapSlots[i].lastAccess < lruAccess) {
+        lruAccess = bitmapSlots[i].lastAccess;
+        lruSlot = i;
+      }
+    }
+  }
 
-  // Check bitmap cache
-  for (size_t i = 0; i < BITMAP_CACHE_CAPACITY; i++) {
-    if (bitmapCache[i].data && bitmapCache[i].codePoint == offset) {
-      bitmapCache[i].lastAccess = ++currentAccessCount;
-      if (buffer) {
-        memcpy(buffer, bitmapCache[i].data, std::min((size_t)glyph->dataLength, (size_t)bitmapCache[i].size));
-        return buffer;
+  if (freeSlab == -1) {
+    // Take over the slab of another class that has gone unused the longest, if all of it is older than our LRU slot
+    uint32_t oldestAccess = 0xFFFFFFFF;
+    int oldestSlab = -1;
+    for (size_t slab = 0; slab < bitmapSlabCount; slab++) {
+      if (bitmapSlabs[slab].sizeClass != sizeClass && bitmapSlabs[slab].lastAccess < oldestAccess) {
+        oldestAccess = bitmapSlabs[slab].lastAccess;
+        oldestSlab = slab;
       }
-      return bitmapCache[i].data;
     }
+    if (lruSlot != -1 && (oldestSlab == -1 || lruAccess <= oldestAccess)) {
+      bitmapIndex.erase(bitmapSlots[lruSlot].dataOffset, [this](const size_t s) { return bitmapSlots[s].dataOffset; });
+      bitmapSlots[lruSlot].dataOffset = 0xFFFFFFFF;
+      return lruSlot;
+    }
+    releaseBitmapSlab(oldestSlab);
+    freeSlab = oldestSlab;
   }
 
-  // Cache miss - read from SD
+  bitmapSlabs[freeSlab].sizeClass = static_cast<int8_t>(sizeClass);
+  return freeSlab * MAX_SLOTS_PER_SLAB;
+}
+
+int CustomEpdFont::bitmapSizeClass(const uint32_t length) {
+  int sizeClass = 0;
+  while ((MIN_BITMAP_SLOT_SIZE << sizeClass) < length) {
+    if ((MIN_BITMAP_SLOT_SIZE << sizeClass) >= BITMAP_SLAB_SIZE) {
+      return -1;
+    }
+    sizeClass++;
+  }
+  return sizeClass;
+}
+
+bool CustomEpdFont::ensureScratchBitmap(const size_t size) const {
+  if (oversizeBitmapSize >= size) {
+    return true;
+  }
+  free(oversizeBitmap);
+  oversizeBitmap = static_cast<uint8_t*>(malloc(size));
+  oversizeBitmapSize = oversizeBitmap ? size : 0;
+  if (!oversizeBitmap) {
+    Serial.println("CustomEpdFont: MALLOC FAILED");
+    return false;
+  }
+  return true;
+}
+
+bool CustomEpdFont::readBitmap(const uint32_t dataOffset, uint8_t* dest, const uint32_t length) const {
   if (!fontFile.isOpen()) {
     if (!SdMan.openFileForRead("CustomFont", filePath.c_str(), fontFile)) {
       Serial.printf("Failed to open font file: %s\n", filePath.c_str());
-      return nullptr;
+      return false;
     }
   }
 
-  if (!fontFile.seekSet(offsetBitmaps + offset)) {
-    Serial.printf("CustomEpdFont: Failed to seek to bitmap offset %u\n", offsetBitmaps + offset);
+  if (!fontFile.seekSet(offsetBitmaps + dataOffset)) {
+    Serial.printf("CustomEpdFont: Failed to seek to bitmap offset %u\n", offsetBitmaps + dataOffset);
     fontFile.close();
-    return nullptr;
+    return false;
   }
 
-  // Allocate memory manually
-  uint8_t* newData = (uint8_t*)malloc(glyph->dataLength);
-  if (!newData) {
-    Serial.println("CustomEpdFont: MALLOC FAILED");
-    fontFile.close();
-    return nullptr;
+  sdReadCount++;
+  const size_t bytesRead = fontFile.read(dest, length);
+  if (bytesRead != length) {
+    Serial.printf("CustomEpdFont: Read mismatch. Expected %u, got %u\n", length, static_cast<unsigned>(bytesRead));
+    return false;
   }
+  return true;
+}
 
-  size_t bytesRead = fontFile.read(newData, glyph->dataLength);
-  // fontFile.close(); // Keep file open
+uint32_t CustomEpdFont::decodedBitmapLength(const EpdGlyph& glyph) const {
+  if (version < 2) {
+    return glyph.dataLength;
+  }
+  const uint32_t bitsPerPixel = getData()->is2Bit ? 2 : 1;
+  return (static_cast<uint32_t>(glyph.width) * glyph.height * bitsPerPixel + 7) / 8;
+}
+
+bool CustomEpdFont::readGlyphBitmap(const EpdGlyph& glyph, uint8_t* dest, const uint32_t decodedLength) const {
+  if (const uint8_t* hot = hotGlyphBitmap(&glyph)) {
+    if (!isCompressed(glyph)) {
+      memcpy(dest, hot, decodedLength);
+      return true;
+    }
+    return decodeGlyphBitmap(glyph, hot, dest);
+  }
+  if (!isCompressed(glyph)) {
+    return readBitmap(glyph.dataOffset, dest, decodedLength);
+  }
+
+  // Stage the packed bytes in the scratch buffer, behind the output if the output is the scratch buffer itself
+  const size_t stagingOffset = dest == oversizeBitmap ? decodedLength : 0;
+  if (!ensureScratchBitmap(stagingOffset + glyph.dataLength)) {
+    return false;
+  }
+  uint8_t* packed = oversizeBitmap + stagingOffset;
+  if (!readBitmap(glyph.dataOffset, packed, glyph.dataLength)) {
+    return false;
+  }
+  return decodeGlyphBitmap(glyph, packed, dest);
+}
+
+bool CustomEpdFont::decodeGlyphBitmap(const EpdGlyph& glyph, const uint8_t* packed, uint8_t* dest) const {
+  if (!decodePixelRuns(packed, glyph.dataLength, dest, static_cast<uint32_t>(glyph.width) * glyph.height,
+                       getData()->is2Bit ? 2 : 1)) {
+    Serial.printf("CustomEpdFont: Corrupt compressed bitmap at %u\n", glyph.dataOffset);
+    return false;
+  }
+  return true;
+}
 
-  if (bytesRead != glyph->dataLength) {
-    Serial.printf("CustomEpdFont: Read mismatch. Expected %u, got %u\n", glyph->dataLength, bytesRead);
-    free(newData);
+const uint8_t* CustomEpdFont::loadGlyphBitmap(const EpdGlyph* glyph, uint8_t* buffer,
+                                              const EpdFontStyles::Style style) const {
+  if (!glyph) return nullptr;
+  // Serial.printf("CustomEpdFont::loadGlyphBitmap glyph=%p len=%u\n", glyph, glyph->dataLength);
+  if (subset && subset->ownsGlyph(glyph)) {
+    return subset->loadGlyphBitmap(glyph, buffer, style);
+  }
+
+  if (glyph->dataLength == 0) {
+    return nullptr;  // Empty glyph
+  }
+  const uint32_t offset = glyph->dataOffset;
+  const uint32_t length = decodedBitmapLength(*glyph);
+  if (length > 32768) {
+    Serial.printf("CustomEpdFont: Glyph too large (%u)\n", length);
     return nullptr;
   }
 
-  // Find slot in bitmap cache (LRU)
-  int slotIndex = -1;
-  for (size_t i = 0; i < BITMAP_CACHE_CAPACITY; i++) {
-    if (bitmapCache[i].data == nullptr) {
-      slotIndex = i;
-      break;
+  // Raw bitmaps of the hot pack are used in place
+  const uint8_t* hot = hotGlyphBitmap(glyph);
+  if (hot && !isCompressed(*glyph)) {
+    hotPackHits++;
+    if (buffer) {
+      memcpy(buffer, hot, length);
+      return buffer;
     }
+    return hot;
   }
 
-  if (slotIndex == -1) {
-    uint32_t minAccess = 0xFFFFFFFF;
-    for (size_t i = 0; i < BITMAP_CACHE_CAPACITY; i++) {
-      if (bitmapCache[i].lastAccess < minAccess) {
-        minAccess = bitmapCache[i].lastAccess;
-        slotIndex = i;
+  const int sizeClass = bitmapSizeClass(length);
+
+  uint8_t* data = nullptr;
+  if (sizeClass >= 0 && (bitmapArena || allocateBitmapArena())) {
+    const auto keyOf = [this](const size_t s) { return bitmapSlots[s].dataOffset; };
+    int slot = bitmapIndex.find(offset, keyOf);
+    if (slot != GlyphCacheIndex::NOT_FOUND) {
+      bitmapCacheHits++;
+      data = bitmapSlotData(slot);
+    } else {
+      // Cache miss - read (and decode) from SD straight into the slot
+      bitmapCacheMisses++;
+      slot = claimBitmapSlot(sizeClass);
+      data = bitmapSlotData(slot);
+      if (!readGlyphBitmap(*glyph, data, length)) {
+        return nullptr;
       }
+      bitmapSlots[slot].dataOffset = offset;
+      bitmapIndex.insert(offset, static_cast<uint16_t>(slot));
     }
-
-    // Free evicted slot
-    if (bitmapCache[slotIndex].data) {
-      free(bitmapCache[slotIndex].data);
-      bitmapCache[slotIndex].data = nullptr;
+    bitmapSlots[slot].lastAccess = ++currentAccessCount;
+    bitmapSlabs[slot / MAX_SLOTS_PER_SLAB].lastAccess = currentAccessCount;
+  } else {
+    // Too large for a slab (or no arena): reuse one scratch buffer, growing it only when needed
+    // Compressed data is staged behind the decoded bitmap
+    bitmapCacheMisses++;
+    if (!ensureScratchBitmap(length + (isCompressed(*glyph) ? glyph->dataLength : 0))) {
+      return nullptr;
+    }
+    data = oversizeBitmap;
+    if (!readGlyphBitmap(*glyph, data, length)) {
+      return nullptr;
     }
   }
 
-  // Store in cache
-  bitmapCache[slotIndex].codePoint = offset;
-  bitmapCache[slotIndex].lastAccess = ++currentAccessCount;
-  bitmapCache[slotIndex].data = newData;
-  bitmapCache[slotIndex].size = glyph->dataLength;
-
   if (buffer) {
-    memcpy(buffer, newData, glyph->dataLength);
+    memcpy(buffer, data, length);
     return buffer;
   }
-
-  return newData;
+  return data;
 }
@@ -2,32 +2,85 @@
 
 #include <SDCardManager.h>
 
+#include <memory>
 #include <vector>
 
+#include "CodepointSet.h"
 #include "EpdFont.h"
+#include "GlyphCacheIndex.h"
 
-struct BitmapCacheEntry {
-  uint32_t codePoint = 0;
+struct BitmapCacheSlot {
+  uint32_t dataOffset = 0xFFFFFFFF;  // Invalid initial value
+  uint32_t lastAccess = 0;
+};
+
+struct BitmapCacheSlab {
+  int8_t sizeClass = -1;  // -1 while the slab is unused
   uint32_t lastAccess = 0;
-  uint8_t* data = nullptr;
-  uint16_t size = 0;
 };
 
 struct GlyphStructCacheEntry {
   uint32_t codePoint = 0xFFFFFFFF;  // Invalid initial value
-  uint32_t lastAccess = 0;
+  bool referenced = false;          // Clock bit, set on every hit
   EpdGlyph glyph;
 };
 
 class CustomEpdFont : public EpdFont {
  public:
+  // Takes ownership of data and its intervals, both allocated with new, and of its page table (see
+  // EpdFont::buildPageTable).
+  // glyphCacheCapacity = 0 sizes the glyph metadata cache from the free heap at load time,
+  // bitmapCacheBudget = 0 sizes the bitmap cache from the font size on the first bitmap load
   CustomEpdFont(const String& filePath, const EpdFontData* data, uint32_t offsetIntervals, uint32_t offsetGlyphs,
-                uint32_t offsetBitmaps, int version = 0);
+                uint32_t offsetBitmaps, int version = 0, size_t glyphCacheCapacity = 0, size_t bitmapCacheBudget = 0);
   ~CustomEpdFont() override;
+  CustomEpdFont(const CustomEpdFont&) = delete;
+  CustomEpdFont& operator=(const CustomEpdFont&) = delete;
 
   const EpdGlyph* getGlyph(uint32_t cp, const EpdFontStyles::Style style = EpdFontStyles::REGULAR) const override;
   const uint8_t* loadGlyphBitmap(const EpdGlyph* glyph, uint8_t* buffer,
                                  const EpdFontStyles::Style style = EpdFontStyles::REGULAR) const override;
+  void prefetchGlyphs(const uint32_t* codepoints, size_t count,
+                      const EpdFontStyles::Style style = EpdFontStyles::REGULAR) const override;
+
+  // Loads the font's hot pack (<font>.epdhot next to the .epdfont, see fontconvert.py --hot-pack) if there is one.
+  // Its glyphs are ordered by frequency and kept resident as far as they fit in budgetBytes, 0 sizes the budget from
+  // the free heap. Returns false if there is no usable pack.
+  bool loadHotPack(size_t budgetBytes = 0);
+  size_t getHotGlyphCount() const { return hotGlyphCount; }
+  uint32_t getHotPackHits() const { return hotPackHits; }
+  // Writes a .epdfont (v1, or v2 if this font is v2) holding only the glyphs for the given codepoints, e.g. the
+  // characters of one book. Its glyph table is in codepoint order, so reading a book's glyphs stays within a small file.
+  bool writeSubset(const CodepointSet& codepoints, const String& path) const;
+  // writeSubset a few glyphs at a time, see below
+  class SubsetWriter;
+  // Serves the glyphs the subset has from it and everything else from this font. Takes ownership, nullptr detaches.
+  void attachSubset(CustomEpdFont* subsetFont);
+  bool hasSubset() const { return subset != nullptr; }
+
+  // Decodes the pixel run length encoding of compressed v2 bitmaps (see fontconvert.py --compress): every byte is one
+  // run, the pixel value in the top bitsPerPixel bits and the run length - 1 below it. Writes the bitmap packed like an
+  // uncompressed one, rows continuous and MSB first. Fails on runs that don't add up to exactly pixelCount pixels.
+  static bool decodePixelRuns(const uint8_t* src, size_t srcLength, uint8_t* dest, uint32_t pixelCount,
+                              int bitsPerPixel);
+
+  // Reads from the SD card by all custom fonts since boot, for profiling
+  static uint32_t getSdReadCount() { return sdReadCount; }
+
+  // Cache statistics, for profiling
+  size_t getGlyphCacheCapacity() const { return glyphCacheCapacity; }
+  uint32_t getGlyphCacheHits() const { return glyphCacheHits; }
+  uint32_t getGlyphCacheMisses() const { return glyphCacheMisses; }
+  size_t getBitmapCacheBudget() const { return bitmapSlabCount * BITMAP_SLAB_SIZE; }
+  uint32_t getBitmapCacheHits() const { return bitmapCacheHits; }
+  uint32_t getBitmapCacheMisses() const { return bitmapCacheMisses; }
+  void resetCacheStats() const {
+    glyphCacheHits = 0;
+    glyphCacheMisses = 0;
+    bitmapCacheHits = 0;
+    bitmapCacheMisses = 0;
+    hotPackHits = 0;
+  }
 
  private:
   String filePath;
@@ -37,15 +90,153 @@ class CustomEpdFont : public EpdFont {
   uint32_t offsetBitmaps;
 
   // Bitmap Cache (Pixel data)
-  static constexpr size_t BITMAP_CACHE_CAPACITY = 10;
-  mutable BitmapCacheEntry bitmapCache[BITMAP_CACHE_CAPACITY];
+  // One arena of fixed size slabs, allocated on the first bitmap load. Each slab is handed to a size class on demand
+  // and split into equal slots, so steady state rendering never touches the heap. Slots are evicted LRU within their
+  // class; a slab of another class is taken over instead when everything in it is older than that. Bitmaps larger
+  // than a slab are read into a reusable scratch buffer.
+  static constexpr size_t BITMAP_SLAB_SIZE = 2048;
+  static constexpr size_t MIN_BITMAP_SLOT_SIZE = 64;
+  static constexpr size_t MAX_SLOTS_PER_SLAB = BITMAP_SLAB_SIZE / MIN_BITMAP_SLOT_SIZE;
+  static constexpr size_t MIN_BITMAP_CACHE_BUDGET = 24 * 1024;
+  static constexpr size_t MAX_BITMAP_CACHE_BUDGET = 48 * 1024;
+  static constexpr size_t BITMAP_CACHE_GLYPHS = 192;  // Auto budget: room for this many em-sized glyphs
+  size_t bitmapCacheBudget = 0;
+  mutable uint8_t* bitmapArena = nullptr;
+  mutable size_t bitmapSlabCount = 0;
+  mutable BitmapCacheSlab* bitmapSlabs = nullptr;
+  mutable BitmapCacheSlot* bitmapSlots = nullptr;  // MAX_SLOTS_PER_SLAB per slab
+  mutable GlyphCacheIndex bitmapIndex;            // Data offset -> slot
+  mutable bool bitmapArenaFailed = false;
+  mutable uint8_t* oversizeBitmap = nullptr;  // Also the staging buffer for prefetch reads
+  mutable size_t oversizeBitmapSize = 0;
+  mutable uint32_t bitmapCacheHits = 0;
+  mutable uint32_t bitmapCacheMisses = 0;
 
   // Glyph Struct Cache (Metadata)
-  static constexpr size_t GLYPH_CACHE_CAPACITY = 200;
-  mutable GlyphStructCacheEntry glyphCache[GLYPH_CACHE_CAPACITY];
+  // Entries live in a fixed array evicted with the clock algorithm, and are found through an index keyed by codepoint
+  static constexpr size_t MIN_GLYPH_CACHE_CAPACITY = 128;
+  static constexpr size_t MAX_GLYPH_CACHE_CAPACITY = 1024;
+  static constexpr size_t GLYPH_CACHE_HEAP_DIVISOR = 16;  // Auto sizing uses at most 1/16 of the free heap
+  size_t glyphCacheCapacity = 0;
+  mutable GlyphStructCacheEntry* glyphCache = nullptr;
+  mutable GlyphCacheIndex glyphIndex;
+  mutable size_t glyphCacheUsed = 0;
+  mutable size_t clockHand = 0;
+  mutable uint32_t glyphCacheHits = 0;
+  mutable uint32_t glyphCacheMisses = 0;
+
+  // Hot pack (metadata and bitmaps of the most frequent glyphs)
+  // Read in one sequential pass at load and never evicted. Bitmaps are kept as stored: raw ones are drawn straight from
+  // the pack, compressed ones are decoded into the bitmap cache like bitmaps read from the font file.
+  static constexpr size_t HOT_PACK_HEADER_SIZE = 24;
+  static constexpr size_t MAX_HOT_PACK_BUDGET = 64 * 1024;
+  static constexpr size_t HOT_PACK_HEAP_DIVISOR = 8;  // Auto budget uses at most 1/8 of the free heap
+  size_t hotGlyphCount = 0;
+  uint32_t* hotCodepoints = nullptr;
+  EpdGlyph* hotGlyphs = nullptr;
+  uint32_t* hotBitmapOffsets = nullptr;  // Into hotBitmaps
+  uint8_t* hotBitmaps = nullptr;
+  GlyphCacheIndex hotIndex;  // Codepoint -> hot glyph
+  mutable uint32_t hotPackHits = 0;
+  static uint32_t sdReadCount;
+
+  std::unique_ptr<CustomEpdFont> subset;
+
+  // Prefetch reads through gaps up to this size between wanted records/bitmaps rather than seeking over them
+  static constexpr uint32_t PREFETCH_MAX_GAP = 256;
+  static constexpr size_t PREFETCH_RECORD_BUFFER_SIZE = 512;
+  static constexpr size_t MAX_GLYPH_RECORD_SIZE = 16;
 
   mutable uint32_t currentAccessCount = 0;
   int version = 0;
 
+  uint32_t glyphRecordSize() const { return version >= 1 ? 16 : 13; }
+  bool findGlyphIndex(uint32_t cp, const EpdFontData* data, uint32_t* glyphIndex) const;
+  // Maps characters the font may lack onto ASCII lookalikes, 0 if there is none
+  static uint32_t fallbackCodepoint(uint32_t cp);
+  bool readGlyphRecords(uint32_t firstIndex, uint32_t count, uint8_t* dest) const;
+  void parseGlyphRecord(const uint8_t* glyphBuf, EpdGlyph* glyph) const;
+
+  void prefetchOwnGlyphs(const uint32_t* codepoints, size_t count, const EpdFontData* data) const;
+  bool hasGlyph(uint32_t cp) const;
+  // Whether the glyph pointer was handed out by this font's caches
+  bool ownsGlyph(const EpdGlyph* glyph) const;
+  uint32_t totalGlyphCount() const;
+
+  void releaseHotPack();
+  const EpdGlyph* findHotGlyph(uint32_t cp) const;
+  // Stored bitmap of a glyph returned from the hot pack, nullptr for any other glyph
+  const uint8_t* hotGlyphBitmap(const EpdGlyph* glyph) const;
+
   void clearCache() const;
+  bool allocateGlyphCache(size_t capacity);
+  const EpdGlyph* findCachedGlyph(uint32_t cp) const;
+  GlyphStructCacheEntry* claimGlyphCacheEntry(uint32_t cp) const;
+
+  bool allocateBitmapArena() const;
+  int claimBitmapSlot(int sizeClass) const;
+  void releaseBitmapSlab(size_t slab) const;
+  uint8_t* bitmapSlotData(size_t slot) const;
+  // Smallest size class that fits, -1 if the bitmap is larger than a slab
+  static int bitmapSizeClass(uint32_t length);
+  bool ensureScratchBitmap(size_t size) const;
+  bool readBitmap(uint32_t dataOffset, uint8_t* dest, uint32_t length) const;
+  // v2 fonts store a bitmap as pixel runs whenever that is smaller than the raw bitmap, dataLength is the stored size
+  uint32_t decodedBitmapLength(const EpdGlyph& glyph) const;
+  bool isCompressed(const EpdGlyph& glyph) const { return glyph.dataLength < decodedBitmapLength(glyph); }
+  bool readGlyphBitmap(const EpdGlyph& glyph, uint8_t* dest, uint32_t decodedLength) const;
+  bool decodeGlyphBitmap(const EpdGlyph& glyph, const uint8_t* packed, uint8_t* dest) const;
+};
+
+// Writes the same file as CustomEpdFont::writeSubset, up to a given number of glyphs per step() so the work can be
+// spread over the time slices of a background job. It works from its own copy of the codepoints, which are free to
+// change meanwhile. The font must outlive the writer. A writer destroyed before it is done removes its partial file.
+class CustomEpdFont::SubsetWriter {
+ public:
+  SubsetWriter(const CustomEpdFont& font, const String& path) : font(font), path(path) {}
+  ~SubsetWriter();
+  SubsetWriter(const SubsetWriter&) = delete;
+  SubsetWriter& operator=(const SubsetWriter&) = delete;
+
+  // Counts the glyphs and writes the header. Returns false if the font has none of the codepoints or the file can't be
+  // written.
+  bool begin(const CodepointSet& codepoints);
+  // Writes the intervals, then the glyph records, then the bitmaps, moving over at most glyphs glyphs of one of them.
+  // Returns false once writing has failed.
+  bool step(uint32_t glyphs);
+  bool done() const { return phase == Phase::Done; }
+
+ private:
+  enum class Phase : uint8_t { Intervals, Records, Bitmaps, Done };
+
+  const CustomEpdFont& font;
+  String path;
+  CodepointSet codepoints;
+  FsFile out;
+  Phase phase = Phase::Intervals;
+  uint32_t cursor = 0;  // Where the current phase continues in codepoints
+  uint32_t glyphCount = 0;
+
+  // Intervals are renumbered over the subset's glyphs
+  EpdUnicodeInterval interval = {0, 0, 0};
+  uint32_t subsetIndex = 0;
+
+  // Records and bitmaps both walk the source glyph table forwards through one buffer of records
+  uint8_t recordBuf[PREFETCH_RECORD_BUFFER_SIZE];
+  uint32_t bufferFirst = 0;
+  uint32_t bufferCount = 0;
+  uint32_t subsetDataOffset = 0;
+
+  // Bitmaps that follow each other in the source are copied in runs of up to a slab
+  uint32_t runOffset = 0;
+  uint32_t runLength = 0;
+
+  bool nextGlyph(uint32_t* cp, uint32_t* glyphIndex);
+  bool sourceGlyph(uint32_t glyphIndex, EpdGlyph* glyph);
+  bool addInterval(uint32_t cp);
+  bool writeRecord(uint32_t glyphIndex);
+  bool addBitmap(uint32_t glyphIndex);
+  bool copyBitmaps();
+  bool finishPhase();
+  void fail();
 };
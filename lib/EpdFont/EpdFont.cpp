@@ -2,8 +2,153 @@
 
 #include <Arduino.h>
 #include <Utf8.h>
+#include <miniz.h>
 
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+// Bitmaps of block compressed fonts, shared by all of them. Glyphs are copied out of their inflated block into a small
+// set associative cache, so the characters on screen stay resident without keeping whole blocks around. The last
+// inflated blocks are kept too, neighbouring glyphs (and those too large for a cache entry) often share them.
+constexpr int BITMAP_BLOCK_SLOTS = 2;
+constexpr int GLYPH_CACHE_SET_BITS = 6;
+constexpr int GLYPH_CACHE_SETS = 1 << GLYPH_CACHE_SET_BITS;
+constexpr int GLYPH_CACHE_WAYS = 4;
+constexpr uint32_t GLYPH_CACHE_ENTRY_BYTES = 60;
+
+struct BitmapBlockSlot {
+  const EpdBitmapBlocks* blocks = nullptr;
+  uint32_t block = 0;
+  uint32_t lastUse = 0;
+  uint32_t capacity = 0;
+  uint8_t* bytes = nullptr;
+};
+
+struct GlyphCacheEntry {
+  const EpdBitmapBlocks* blocks;
+  uint32_t dataOffset;
+  uint32_t lastUse;
+  uint8_t bytes[GLYPH_CACHE_ENTRY_BYTES];
+};
+
+BitmapBlockSlot bitmapBlockSlots[BITMAP_BLOCK_SLOTS];
+uint32_t bitmapBlockClock = 0;
+uint32_t bitmapBlockInflateCount = 0;
+GlyphCacheEntry* glyphCache = nullptr;  // GLYPH_CACHE_SETS * GLYPH_CACHE_WAYS entries, allocated on first use
+tinfl_decompressor* inflator = nullptr;  // ~11KB, allocated on the first inflate and reused for every block
+
+bool inflateBitmapBlock(const uint8_t* input, const size_t inputSize, uint8_t* output, const size_t outputSize) {
+  if (!inflator) {
+    inflator = static_cast<tinfl_decompressor*>(malloc(sizeof(tinfl_decompressor)));
+    if (!inflator) {
+      Serial.printf("[%lu] [EFT] Failed to allocate memory for inflator\n", millis());
+      return false;
+    }
+  }
+  tinfl_init(inflator);
+
+  size_t inBytes = inputSize;
+  size_t outBytes = outputSize;
+  const tinfl_status status =
+      tinfl_decompress(inflator, input, &inBytes, output, output, &outBytes, TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+
+  if (status != TINFL_STATUS_DONE) {
+    Serial.printf("[%lu] [EFT] Bitmap block inflate failed with status %d\n", millis(), status);
+    return false;
+  }
+  return true;
+}
+
+// Returns the inflated block, from the block slots if it is still there
+const uint8_t* loadBitmapBlock(const EpdFontData* data, const uint32_t block) {
+  const EpdBitmapBlocks* blocks = data->bitmapBlocks;
+  bitmapBlockClock++;
+  BitmapBlockSlot* victim = &bitmapBlockSlots[0];
+  for (auto& slot : bitmapBlockSlots) {
+    if (slot.blocks == blocks && slot.block == block) {
+      slot.lastUse = bitmapBlockClock;
+      return slot.bytes;
+    }
+    if (slot.lastUse < victim->lastUse) {
+      victim = &slot;
+    }
+  }
+
+  if (victim->capacity < blocks->blockSize) {
+    free(victim->bytes);
+    victim->bytes = static_cast<uint8_t*>(malloc(blocks->blockSize));
+    victim->capacity = victim->bytes ? blocks->blockSize : 0;
+  }
+  victim->blocks = nullptr;
+  victim->lastUse = 0;
+  if (!victim->bytes) {
+    Serial.printf("[%lu] [EFT] Failed to allocate bitmap block\n", millis());
+    return nullptr;
+  }
+
+  const uint32_t start = blocks->offsets[block];
+  if (!inflateBitmapBlock(data->bitmap + start, blocks->offsets[block + 1] - start, victim->bytes,
+                          blocks->blockSize)) {
+    return nullptr;
+  }
+  bitmapBlockInflateCount++;
+  victim->blocks = blocks;
+  victim->block = block;
+  victim->lastUse = bitmapBlockClock;
+  return victim->bytes;
+}
+
+// Returns the glyph's bitmap, valid until the next glyph of a block compressed font is loaded
+const uint8_t* loadBlockGlyphBitmap(const EpdFontData* data, const EpdGlyph* glyph) {
+  const EpdBitmapBlocks* blocks = data->bitmapBlocks;
+  const uint32_t block = glyph->dataOffset / blocks->blockSize;
+  if (block >= blocks->blockCount) {
+    return nullptr;
+  }
+
+  // Glyphs without a bitmap share their offset with the next glyph, they must not take its cache entry
+  GlyphCacheEntry* set = nullptr;
+  if (glyph->dataLength > 0 && glyph->dataLength <= GLYPH_CACHE_ENTRY_BYTES) {
+    if (!glyphCache) {
+      glyphCache = static_cast<GlyphCacheEntry*>(calloc(GLYPH_CACHE_SETS * GLYPH_CACHE_WAYS, sizeof(GlyphCacheEntry)));
+    }
+    if (glyphCache) {
+      const uint32_t key = glyph->dataOffset ^ static_cast<uint32_t>(reinterpret_cast<uintptr_t>(blocks));
+      set = &glyphCache[((key * 2654435761u) >> (32 - GLYPH_CACHE_SET_BITS)) * GLYPH_CACHE_WAYS];
+      bitmapBlockClock++;
+      for (int way = 0; way < GLYPH_CACHE_WAYS; way++) {
+        if (set[way].blocks == blocks && set[way].dataOffset == glyph->dataOffset) {
+          set[way].lastUse = bitmapBlockClock;
+          return set[way].bytes;
+        }
+      }
+    }
+  }
+
+  const uint8_t* blockBytes = loadBitmapBlock(data, block);
+  if (!blockBytes) {
+    return nullptr;
+  }
+  const uint8_t* bitmap = blockBytes + glyph->dataOffset % blocks->blockSize;
+  if (!set) {
+    return bitmap;
+  }
+
+  GlyphCacheEntry* entry = &set[0];
+  for (int way = 1; way < GLYPH_CACHE_WAYS; way++) {
+    if (set[way].lastUse < entry->lastUse) {
+      entry = &set[way];
+    }
+  }
+  entry->blocks = blocks;
+  entry->dataOffset = glyph->dataOffset;
+  entry->lastUse = bitmapBlockClock;
+  memcpy(entry->bytes, bitmap, glyph->dataLength);
+  return entry->bytes;
+}
+}  // namespace
 
 void EpdFont::getTextBounds(const char* string, const int startX, const int startY, int* minX, int* minY, int* maxX,
                             int* maxY, const EpdFontStyles::Style style) const {
@@ -57,15 +202,26 @@ bool EpdFont::hasPrintableChars(const char* string, const EpdFontStyles::Style s
 
 const EpdGlyph* EpdFont::getGlyph(const uint32_t cp, const EpdFontStyles::Style style) const {
   const EpdFontData* data = getData(style);
-  if (!data) return nullptr;
+  if (!data || !data->glyph) return nullptr;
 
-  const EpdUnicodeInterval* intervals = data->intervals;
-  const int count = data->intervalCount;
+  uint32_t glyphIndex;
+  if (!findGlyphIndex(data, cp, &glyphIndex)) {
+    return nullptr;
+  }
+  return &data->glyph[glyphIndex];
+}
 
-  if (count == 0) return nullptr;
+bool EpdFont::findGlyphIndex(const EpdFontData* data, const uint32_t cp, uint32_t* glyphIndex) {
+  if (data->pageTable && cp < 0x10000) {
+    return findGlyphIndexInPageTable(data->pageTable, cp, glyphIndex);
+  }
+  return findGlyphIndexInIntervals(data, cp, glyphIndex);
+}
 
+bool EpdFont::findGlyphIndexInIntervals(const EpdFontData* data, const uint32_t cp, uint32_t* glyphIndex) {
+  const EpdUnicodeInterval* intervals = data->intervals;
   int left = 0;
-  int right = count - 1;
+  int right = static_cast<int>(data->intervalCount) - 1;
 
   while (left <= right) {
     const int mid = left + (right - left) / 2;
@@ -76,19 +232,104 @@ const EpdGlyph* EpdFont::getGlyph(const uint32_t cp, const EpdFontStyles::Style
     } else if (cp > interval->last) {
       left = mid + 1;
     } else {
-      if (data->glyph) {
-        return &data->glyph[interval->offset + (cp - interval->first)];
-      }
+      *glyphIndex = interval->offset + (cp - interval->first);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool EpdFont::findGlyphIndexInPageTable(const EpdGlyphPageTable* table, const uint32_t cp, uint32_t* glyphIndex) {
+  const uint16_t pageIndex = table->pageIndex[cp >> 8];
+  if (pageIndex == 0xFFFF) {
+    return false;
+  }
+  const EpdGlyphPage& page = table->pages[pageIndex];
+  const uint32_t word = (cp & 0xFF) >> 5;
+  const uint32_t bit = 1u << (cp & 31);
+  if (!(page.bits[word] & bit)) {
+    return false;
+  }
+  *glyphIndex = page.base + page.rank[word] + __builtin_popcount(page.bits[word] & (bit - 1));
+  return true;
+}
+
+EpdGlyphPageTable* EpdFont::buildPageTable(const EpdFontData* data) {
+  constexpr uint32_t PAGE_COUNT = 256;
+
+  // Glyph indices have to follow codepoint order across the BMP, a page's glyphs are then counted from its base
+  uint16_t pageIndex[PAGE_COUNT];
+  std::fill(pageIndex, pageIndex + PAGE_COUNT, 0xFFFF);
+  uint16_t usedPages = 0;
+  for (uint32_t i = 0; i < data->intervalCount; i++) {
+    const EpdUnicodeInterval& interval = data->intervals[i];
+    if (interval.first >= 0x10000) {
+      break;
+    }
+    if (interval.last < interval.first) {
       return nullptr;
     }
+    if (i > 0) {
+      const EpdUnicodeInterval& previous = data->intervals[i - 1];
+      if (interval.first <= previous.last || interval.offset != previous.offset + (previous.last - previous.first + 1)) {
+        return nullptr;
+      }
+    }
+    for (uint32_t page = interval.first >> 8; page <= (std::min(interval.last, 0xFFFFu) >> 8); page++) {
+      if (pageIndex[page] == 0xFFFF) {
+        pageIndex[page] = usedPages++;
+      }
+    }
+  }
+  if (usedPages == 0) {
+    return nullptr;
   }
 
-  return nullptr;
+  const size_t size = sizeof(EpdGlyphPageTable) + sizeof(pageIndex) + usedPages * sizeof(EpdGlyphPage);
+  auto* block = static_cast<uint8_t*>(malloc(size));
+  if (!block) {
+    return nullptr;
+  }
+  auto* table = reinterpret_cast<EpdGlyphPageTable*>(block);
+  auto* tableIndex = reinterpret_cast<uint16_t*>(block + sizeof(EpdGlyphPageTable));
+  auto* pages = reinterpret_cast<EpdGlyphPage*>(block + sizeof(EpdGlyphPageTable) + sizeof(pageIndex));
+  std::copy(pageIndex, pageIndex + PAGE_COUNT, tableIndex);
+  memset(pages, 0, usedPages * sizeof(EpdGlyphPage));
+  for (uint16_t i = 0; i < usedPages; i++) {
+    pages[i].base = UINT32_MAX;
+  }
+
+  for (uint32_t i = 0; i < data->intervalCount && data->intervals[i].first < 0x10000; i++) {
+    const EpdUnicodeInterval& interval = data->intervals[i];
+    const uint32_t last = std::min(interval.last, 0xFFFFu);
+    for (uint32_t cp = interval.first; cp <= last; cp++) {
+      EpdGlyphPage& page = pages[pageIndex[cp >> 8]];
+      page.base = std::min(page.base, interval.offset + (cp - interval.first));
+      page.bits[(cp & 0xFF) >> 5] |= 1u << (cp & 31);
+    }
+  }
+  for (uint16_t i = 0; i < usedPages; i++) {
+    uint8_t rank = 0;
+    for (int word = 0; word < 8; word++) {
+      pages[i].rank[word] = rank;
+      rank += __builtin_popcount(pages[i].bits[word]);
+    }
+  }
+
+  table->pageIndex = tableIndex;
+  table->pages = pages;
+  return table;
 }
 
-const uint8_t* EpdFont::loadGlyphBitmap(const EpdGlyph* glyph, uint8_t* buffer,
+const uint8_t* EpdFont::loadGlyphBitmap(const EpdGlyph* glyph, uint8_t* /*buffer*/,
                                         const EpdFontStyles::Style style) const {
   const EpdFontData* data = getData(style);
   if (!data || !data->bitmap) return nullptr;
+  if (data->bitmapBlocks) {
+    return loadBlockGlyphBitmap(data, glyph);
+  }
   return data->bitmap + glyph->dataOffset;
 }
+
+uint32_t EpdFont::getBitmapBlockInflateCount() { return bitmapBlockInflateCount; }
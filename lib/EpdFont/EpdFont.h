@@ -1,4 +1,6 @@
 #pragma once
+#include <cstddef>
+
 #include "EpdFontData.h"
 #include "EpdFontStyles.h"
 
@@ -19,6 +21,25 @@ class EpdFont {
   virtual const EpdGlyph* getGlyph(uint32_t cp, const EpdFontStyles::Style style = EpdFontStyles::REGULAR) const;
   virtual const uint8_t* loadGlyphBitmap(const EpdGlyph* glyph, uint8_t* buffer,
                                          const EpdFontStyles::Style style = EpdFontStyles::REGULAR) const;
+  // Hint that the glyphs for these codepoints are about to be drawn, so fonts backed by storage can load them in one
+  // batch. Built-in fonts are in flash and have nothing to do.
+  virtual void prefetchGlyphs(const uint32_t* /*codepoints*/, size_t /*count*/,
+                              const EpdFontStyles::Style /*style*/ = EpdFontStyles::REGULAR) const {}
+
+  virtual const EpdFontData* getData(const EpdFontStyles::Style /*style*/ = EpdFontStyles::REGULAR) const {
+    return data;
+  }
+
+  // Index of cp's glyph in the font's glyph array. Uses the page table when the font has one and cp is in the BMP,
+  // the intervals otherwise. Returns false if the font has no glyph for cp.
+  static bool findGlyphIndex(const EpdFontData* data, uint32_t cp, uint32_t* glyphIndex);
+  static bool findGlyphIndexInIntervals(const EpdFontData* data, uint32_t cp, uint32_t* glyphIndex);
+  static bool findGlyphIndexInPageTable(const EpdGlyphPageTable* table, uint32_t cp, uint32_t* glyphIndex);
+
+  // Builds the page table for a font loaded at runtime, in one block to be released with free(). Returns nullptr if
+  // the font has no glyphs in the BMP or its glyphs are not in codepoint order.
+  static EpdGlyphPageTable* buildPageTable(const EpdFontData* data);
 
-  virtual const EpdFontData* getData(const EpdFontStyles::Style style = EpdFontStyles::REGULAR) const { return data; }
+  // Number of bitmap blocks inflated so far, for fonts with EpdFontData::bitmapBlocks
+  static uint32_t getBitmapBlockInflateCount();
 };
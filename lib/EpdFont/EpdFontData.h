@@ -22,6 +22,28 @@ typedef struct {
   uint32_t offset;  ///< Index of the first code point into the glyph array
 } EpdUnicodeInterval;
 
+/// One 256 codepoint page of a glyph page table
+typedef struct {
+  uint32_t base;     ///< Glyph index of the first codepoint in this page that has a glyph
+  uint32_t bits[8];  ///< Bit (cp & 31) of bits[(cp & 0xFF) >> 5] is set if the font has a glyph for cp
+  uint8_t rank[8];   ///< Number of glyphs in bits[0] to bits[i - 1]
+} EpdGlyphPage;
+
+/// Two-level codepoint to glyph index table for the BMP, so lookups don't have to search the intervals.
+/// Only valid for fonts whose glyph array is in codepoint order.
+typedef struct {
+  const uint16_t* pageIndex;  ///< Per 256 codepoint page: index into pages, or 0xFFFF if the page has no glyphs
+  const EpdGlyphPage* pages;
+} EpdGlyphPageTable;
+
+/// Glyph bitmaps stored as raw deflate blocks, decompressed on demand by EpdFont::loadGlyphBitmap. A glyph's dataOffset
+/// is its offset in the uncompressed bitmaps, which are laid out so that no glyph crosses a block boundary.
+typedef struct {
+  const uint32_t* offsets;  ///< Offset of each compressed block in EpdFontData::bitmap, blockCount + 1 entries
+  uint32_t blockCount;      ///< Number of blocks
+  uint32_t blockSize;       ///< Uncompressed size of a block, the last one may be shorter
+} EpdBitmapBlocks;
+
 /// Data stored for FONT AS A WHOLE
 typedef struct {
   const uint8_t* bitmap;                ///< Glyph bitmaps, concatenated
@@ -32,4 +54,6 @@ typedef struct {
   int ascender;                         ///< Maximal height of a glyph above the base line
   int descender;                        ///< Maximal height of a glyph below the base line
   bool is2Bit;
+  const EpdGlyphPageTable* pageTable;   ///< Optional, nullptr to search the intervals
+  const EpdBitmapBlocks* bitmapBlocks;  ///< Optional, nullptr if bitmap holds the glyph bitmaps uncompressed
 } EpdFontData;
@@ -44,3 +44,10 @@ const uint8_t* EpdFontFamily::loadGlyphBitmap(const EpdGlyph* glyph, uint8_t* bu
   const EpdFont* font = getFont(style);
   return font ? font->loadGlyphBitmap(glyph, buffer, style) : nullptr;
 }
+
+void EpdFontFamily::prefetchGlyphs(const uint32_t* codepoints, const size_t count, const Style style) const {
+  const EpdFont* font = getFont(style);
+  if (font) {
+    font->prefetchGlyphs(codepoints, count, style);
+  }
+}
@@ -24,6 +24,7 @@ class EpdFontFamily {
 
   // Helper to load glyph bitmap seamlessly from either static or custom (SD-based) fonts
   const uint8_t* loadGlyphBitmap(const EpdGlyph* glyph, uint8_t* buffer, Style style = EpdFontStyles::REGULAR) const;
+  void prefetchGlyphs(const uint32_t* codepoints, size_t count, Style style = EpdFontStyles::REGULAR) const;
 
  private:
   const EpdFont* regular;
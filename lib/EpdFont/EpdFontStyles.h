@@ -2,4 +2,5 @@
 
 namespace EpdFontStyles {
 enum Style { REGULAR = 0, BOLD = 1, ITALIC = 2, BOLD_ITALIC = 3 };
+constexpr int STYLE_COUNT = 4;
 }
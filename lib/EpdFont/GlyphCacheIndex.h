@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+/**
+ * Open-addressing (linear probing) index from a 32-bit key to an entry number of a fixed-size cache, used by the
+ * CustomEpdFont glyph and bitmap caches.
+ *
+ * The index does not store keys, the owning cache does: lookups and deletions take a keyOf(entry) callable that maps
+ * an entry number back to its key. Slots hold entry + 1, 0 marks an empty slot. Deletion uses backward shifting, so
+ * there are no tombstones and probe runs never degrade.
+ */
+class GlyphCacheIndex {
+ public:
+  static constexpr int NOT_FOUND = -1;
+
+  GlyphCacheIndex() = default;
+  ~GlyphCacheIndex() { release(); }
+  GlyphCacheIndex(const GlyphCacheIndex&) = delete;
+  GlyphCacheIndex& operator=(const GlyphCacheIndex&) = delete;
+
+  // Sizes the index for up to maxEntries entries (at most 65535), keeping it at most half full
+  bool allocate(const size_t maxEntries) {
+    release();
+    int newBits = 1;
+    while ((size_t{1} << newBits) < maxEntries * 2) {
+      newBits++;
+    }
+    slots = new (std::nothrow) uint16_t[size_t{1} << newBits]();
+    if (!slots) {
+      return false;
+    }
+    bits = newBits;
+    return true;
+  }
+
+  void release() {
+    delete[] slots;
+    slots = nullptr;
+    bits = 0;
+  }
+
+  bool isAllocated() const { return slots != nullptr; }
+  size_t slotCount() const { return slots ? size_t{1} << bits : 0; }
+
+  template <typename KeyOf>
+  int find(const uint32_t key, KeyOf keyOf) const {
+    for (size_t i = homeSlot(key);; i = (i + 1) & mask()) {
+      if (slots[i] == 0) {
+        return NOT_FOUND;
+      }
+      if (keyOf(slots[i] - 1) == key) {
+        return slots[i] - 1;
+      }
+    }
+  }
+
+  // The key must not be indexed already
+  void insert(const uint32_t key, const uint16_t entry) {
+    size_t i = homeSlot(key);
+    while (slots[i] != 0) {
+      i = (i + 1) & mask();
+    }
+    slots[i] = entry + 1;
+  }
+
+  template <typename KeyOf>
+  void erase(const uint32_t key, KeyOf keyOf) {
+    size_t hole = homeSlot(key);
+    while (slots[hole] != 0 && keyOf(slots[hole] - 1) != key) {
+      hole = (hole + 1) & mask();
+    }
+    if (slots[hole] == 0) {
+      return;
+    }
+
+    // Pull later entries of the probe run into the hole, unless that would move them in front of their home slot
+    for (size_t i = (hole + 1) & mask(); slots[i] != 0; i = (i + 1) & mask()) {
+      const size_t home = homeSlot(keyOf(slots[i] - 1));
+      const bool reachableFromHole = hole <= i ? (home <= hole || home > i) : (home <= hole && home > i);
+      if (reachableFromHole) {
+        slots[hole] = slots[i];
+        hole = i;
+      }
+    }
+    slots[hole] = 0;
+  }
+
+ private:
+  uint16_t* slots = nullptr;
+  int bits = 0;
+
+  size_t mask() const { return (size_t{1} << bits) - 1; }
+  // Fibonacci hashing, the top bits of the product are the well mixed ones
+  size_t homeSlot(const uint32_t key) const { return (key * 2654435761u) >> (32 - bits); }
+};
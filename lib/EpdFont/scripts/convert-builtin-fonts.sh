@@ -42,12 +42,17 @@ done
 UI_FONT_SIZES=(10 12)
 UI_FONT_STYLES=("Regular" "Bold")
 
+# UI font bitmaps are block compressed, with the characters of the firmware's own strings packed into the first blocks
+ui_text=$(mktemp)
+trap 'rm -f "$ui_text"' EXIT
+find ../../../src -name '*.cpp' -o -name '*.h' | xargs cat > "$ui_text"
+
 for size in ${UI_FONT_SIZES[@]}; do
   for style in ${UI_FONT_STYLES[@]}; do
     font_name="ubuntu_${size}_$(echo $style | tr '[:upper:]' '[:lower:]')"
     font_path="../builtinFonts/source/Ubuntu/Ubuntu-${style}.ttf"
     output_path="../builtinFonts/${font_name}.h"
-    python fontconvert.py $font_name $size $font_path > $output_path
+    python fontconvert.py $font_name $size $font_path --block-compress --block-order "$ui_text" > $output_path
     echo "Generated $output_path"
   done
 done
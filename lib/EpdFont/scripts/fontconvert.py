@@ -16,7 +16,21 @@ parser.add_argument("fontstack", action="store", nargs='+', help="list of font f
 parser.add_argument("--2bit", dest="is2Bit", action="store_true", help="generate 2-bit greyscale bitmap instead of 1-bit black and white.")
 parser.add_argument("--additional-intervals", dest="additional_intervals", action="append", help="Additional code point intervals to export as min,max. This argument can be repeated.")
 parser.add_argument("--binary", dest="isBinary", action="store_true", help="output a binary .epdfont file instead of a C header.")
+parser.add_argument("--compress", dest="compress", action="store_true", help="run length encode glyph bitmaps, writes a version 2 .epdfont (requires --binary).")
+parser.add_argument("--hot-pack", dest="hot_pack", action="store", help="also write a .epdhot pack of the glyphs most frequent in this UTF-8 text file (a corpus, or a list of characters ordered by frequency), preloaded by the reader (requires --binary).")
+parser.add_argument("--hot-count", dest="hot_count", type=int, default=3500, help="maximum number of glyphs in the hot pack (default 3500).")
+parser.add_argument("--block-compress", dest="block_compress", action="store_true", help="deflate glyph bitmaps in blocks, decompressed on demand by the firmware (C header only).")
+parser.add_argument("--block-size", dest="block_size", type=int, default=1024, help="uncompressed size of a bitmap block for --block-compress (default 1024).")
+parser.add_argument("--block-order", dest="block_order", action="store", help="with --block-compress, pack the glyphs most frequent in this UTF-8 text file into the first blocks, so the text it stands for decompresses few blocks.")
 args = parser.parse_args()
+if args.compress and not args.isBinary:
+    parser.error("--compress requires --binary")
+if args.hot_pack and not args.isBinary:
+    parser.error("--hot-pack requires --binary")
+if args.block_compress and args.isBinary:
+    parser.error("--block-compress only applies to C headers")
+if args.block_order and not args.block_compress:
+    parser.error("--block-order requires --block-compress")
 
 GlyphProps = namedtuple("GlyphProps", ["width", "height", "advance_x", "left", "top", "data_length", "data_offset", "code_point"])
 
@@ -78,6 +92,97 @@ def chunks(l, n):
     for i in range(0, len(l), n):
         yield l[i:i + n]
 
+def glyph_page_table(intervals):
+    # Two-level lookup table for the BMP, see EpdGlyphPageTable in EpdFontData.h. Returns the index of each 256
+    # codepoint page into the page list (0xFFFF for pages without glyphs) and (base, bits, rank) per used page.
+    page_index = [0xFFFF] * 256
+    pages = []
+    offset = 0
+    for i_start, i_end in intervals:
+        for code_point in range(i_start, min(i_end, 0xFFFF) + 1):
+            page = code_point >> 8
+            if page_index[page] == 0xFFFF:
+                page_index[page] = len(pages)
+                pages.append([offset + code_point - i_start, [0] * 8])
+            pages[page_index[page]][1][(code_point & 0xFF) >> 5] |= 1 << (code_point & 31)
+        offset += i_end - i_start + 1
+    result = []
+    for base, bits in pages:
+        rank = []
+        count = 0
+        for word in bits:
+            rank.append(count)
+            count += bin(word).count("1")
+        result.append((base, bits, rank))
+    return page_index, result
+
+def encode_pixel_runs(packed, pixel_count, bits_per_pixel):
+    # One byte per run of equal pixels: the pixel value in the top bits_per_pixel bits, the run length - 1 below it.
+    # Must match decodePixelRuns() in CustomEpdFont.cpp
+    length_bits = 8 - bits_per_pixel
+    max_run = 1 << length_bits
+    pixels_per_byte = 8 // bits_per_pixel
+    pixel_mask = (1 << bits_per_pixel) - 1
+    out = bytearray()
+    value = None
+    run = 0
+    for i in range(pixel_count):
+        shift = 8 - bits_per_pixel * (i % pixels_per_byte + 1)
+        pixel = (packed[i // pixels_per_byte] >> shift) & pixel_mask
+        if pixel == value and run < max_run:
+            run += 1
+            continue
+        if run > 0:
+            out.append((value << length_bits) | (run - 1))
+        value = pixel
+        run = 1
+    if run > 0:
+        out.append((value << length_bits) | (run - 1))
+    return bytes(out)
+
+def rank_characters(path):
+    # Characters of a UTF-8 text file ranked by how often they occur, ties by first occurrence, so a list of characters
+    # ordered by frequency ranks as given
+    with open(path, encoding="utf-8") as f:
+        counts = {}
+        for ch in f.read():
+            if not ch.isspace():
+                counts[ch] = counts.get(ch, 0) + 1
+    return sorted(counts, key=lambda ch: -counts[ch])
+
+def compress_bitmap_blocks(glyphs, block_size, ranked_code_points=()):
+    # Lays the bitmaps out in blocks of block_size bytes without splitting a glyph across two blocks, then deflates each
+    # block on its own, see EpdBitmapBlocks in EpdFontData.h. Glyphs of ranked_code_points come first in that order,
+    # the rest follow in code point order. Returns the glyphs (still in code point order) with their offsets in the
+    # layout, the compressed blocks concatenated and the offset of each block in them (plus the end offset).
+    index_by_code_point = {props.code_point: i for i, (props, packed) in enumerate(glyphs)}
+    order = []
+    for code_point in ranked_code_points:
+        i = index_by_code_point.pop(code_point, None)
+        if i is not None:
+            order.append(i)
+    order.extend(sorted(index_by_code_point.values()))
+
+    laid_out = list(glyphs)
+    blocks = [bytearray()]
+    for i in order:
+        props, packed = glyphs[i]
+        if len(packed) > block_size:
+            raise ValueError(f"glyph {props.code_point:#x} is {len(packed)} bytes, larger than the block size")
+        if len(blocks[-1]) + len(packed) > block_size:
+            blocks.append(bytearray())
+        offset = (len(blocks) - 1) * block_size + len(blocks[-1])
+        blocks[-1].extend(packed)
+        laid_out[i] = (props._replace(data_offset=offset), packed)
+    data = bytearray()
+    offsets = []
+    for block in blocks:
+        offsets.append(len(data))
+        compressor = zlib.compressobj(9, zlib.DEFLATED, -15)
+        data.extend(compressor.compress(bytes(block)) + compressor.flush())
+    offsets.append(len(data))
+    return laid_out, bytes(data), offsets
+
 def load_glyph(code_point):
     face_index = 0
     while face_index < len(font_stack):
@@ -198,6 +303,19 @@ for i_start, i_end in intervals:
         total_size += len(packed)
         all_glyphs.append((glyph, packed))
 
+if args.compress:
+    # Store each bitmap compressed only when that makes it smaller, the reader tells the two apart by comparing
+    # data_length with the raw size implied by width and height
+    total_size = 0
+    compressed_glyphs = []
+    for props, packed in all_glyphs:
+        compressed = encode_pixel_runs(packed, props.width * props.height, 2 if is2Bit else 1)
+        if len(compressed) < len(packed):
+            packed = compressed
+        compressed_glyphs.append((props._replace(data_length=len(packed), data_offset=total_size), packed))
+        total_size += len(packed)
+    all_glyphs = compressed_glyphs
+
 # pipe seems to be a good heuristic for the "real" descender
 face = load_glyph(ord('|'))
 
@@ -208,7 +326,62 @@ for index, glyph in enumerate(all_glyphs):
     glyph_data.extend([b for b in packed])
     glyph_props.append(props)
 
-if isBinary:
+if args.block_compress:
+    ranked = [ord(ch) for ch in rank_characters(args.block_order)] if args.block_order else []
+    laid_out, compressed_data, block_offsets = compress_bitmap_blocks(all_glyphs, args.block_size, ranked)
+    glyph_props = [props for props, packed in laid_out]
+    print(f"Compressed {len(glyph_data)} bytes of bitmaps to {len(compressed_data)} in {len(block_offsets) - 1} blocks", file=sys.stderr)
+    glyph_data = list(compressed_data)
+
+def glyph_record(g):
+    # Glyph record as stored in the .epdfont: 16 bytes in version 2, 13 bytes in version 0
+    if args.compress:
+        return struct.pack("<BBBBhhII", g.width, g.height, g.advance_x, 0, g.left, g.top, g.data_length, g.data_offset)
+    return struct.pack("<BBB b B b B H I", g.width, g.height, g.advance_x, g.left, 0, g.top, 0, g.data_length, g.data_offset)
+
+if isBinary and args.compress:
+    import struct
+    with open(f"{font_name}.epdfont", "wb") as f:
+        # Version 2 Header Format (32 bytes total, same layout as version 1)
+        # 0 : Magic (4) "EPDF"
+        # 4 : Version (2) = 2
+        # 6 : Is2Bit (1)
+        # 7 : Reserved (1)
+        # 8 : AdvanceY (1)
+        # 9 : Ascender (1, signed)
+        # 10: Descender (1, signed)
+        # 11: Reserved (1)
+        # 12: IntervalCount (4)
+        # 16: GlyphCount (4)
+        # 20: OffsetIntervals (4)
+        # 24: OffsetGlyphs (4)
+        # 28: OffsetBitmaps (4)
+
+        header_size = 32
+        offset_intervals = header_size
+        offset_glyphs = offset_intervals + len(intervals) * 12
+        offset_bitmaps = offset_glyphs + len(glyph_props) * 16
+
+        f.write(b"EPDF")
+        f.write(struct.pack("<HBB", 2, 1 if is2Bit else 0, 0))
+        f.write(struct.pack("<Bbbb", norm_ceil(face.size.height), norm_ceil(face.size.ascender), norm_floor(face.size.descender), 0))
+        f.write(struct.pack("<IIIII", len(intervals), len(glyph_props), offset_intervals, offset_glyphs, offset_bitmaps))
+
+        # Intervals (offset is the index of the first code point in the glyph table)
+        current_offset = 0
+        for i_start, i_end in intervals:
+            f.write(struct.pack("<III", i_start, i_end, current_offset))
+            current_offset += i_end - i_start + 1
+
+        # Glyphs, 16 bytes each. data_length is the stored (possibly compressed) size.
+        for g in glyph_props:
+            f.write(glyph_record(g))
+
+        # Bitmaps
+        f.write(bytes(glyph_data))
+    raw_size = sum((g.width * g.height * (2 if is2Bit else 1) + 7) // 8 for g in glyph_props)
+    print(f"Generated {font_name}.epdfont (bitmaps {len(glyph_data)} bytes, {raw_size} uncompressed)")
+elif isBinary:
     import struct
     with open(f"{font_name}.epdfont", "wb") as f:
         # Custom Header Format (48 bytes total)
@@ -261,7 +434,7 @@ if isBinary:
         # Glyphs
         for g in glyph_props:
             # 13 bytes per glyph
-            f.write(struct.pack("<BBB b B b B H I", g.width, g.height, g.advance_x, g.left, 0, g.top, 0, g.data_length, g.data_offset))
+            f.write(glyph_record(g))
         
         # Bitmaps
         f.write(bytes(glyph_data))
@@ -289,6 +462,26 @@ else:
         offset += i_end - i_start + 1
     print ("};\n");
 
+    page_index, pages = glyph_page_table(intervals)
+    print(f"static const uint16_t {font_name}PageIndex[] = {{")
+    for c in chunks(page_index, 16):
+        print ("    " + " ".join(f"0x{p:04X}," for p in c))
+    print ("};\n");
+
+    print(f"static const EpdGlyphPage {font_name}Pages[] = {{")
+    for base, bits, rank in pages:
+        print (f"    {{ 0x{base:X}, {{ " + ", ".join(f"0x{b:08X}" for b in bits) + " }, { " + ", ".join(f"{r}" for r in rank) + " } },")
+    print ("};\n");
+
+    print(f"static const EpdGlyphPageTable {font_name}PageTable = {{ {font_name}PageIndex, {font_name}Pages }};\n")
+
+    if args.block_compress:
+        print(f"static const uint32_t {font_name}BlockOffsets[] = {{")
+        for c in chunks(block_offsets, 8):
+            print ("    " + " ".join(f"0x{o:X}," for o in c))
+        print ("};\n");
+        print(f"static const EpdBitmapBlocks {font_name}BitmapBlocks = {{ {font_name}BlockOffsets, {len(block_offsets) - 1}, {args.block_size} }};\n")
+
     print(f"static const EpdFontData {font_name} = {{")
     print(f"    {font_name}Bitmaps,")
     print(f"    {font_name}Glyphs,")
@@ -298,5 +491,34 @@ else:
     print(f"    {norm_ceil(face.size.ascender)},")
     print(f"    {norm_floor(face.size.descender)},")
     print(f"    {'true' if is2Bit else 'false'},")
+    print(f"    &{font_name}PageTable,")
+    print(f"    &{font_name}BitmapBlocks," if args.block_compress else "    nullptr,")
     print("};")
 
+
+if args.hot_pack:
+    ranked = rank_characters(args.hot_pack)
+    glyphs_by_code_point = {g.code_point: g for g in glyph_props}
+    hot = [glyphs_by_code_point[ord(ch)] for ch in ranked if ord(ch) in glyphs_by_code_point][:args.hot_count]
+
+    with open(f"{font_name}.epdhot", "wb") as f:
+        # Hot Pack Format (loaded by CustomEpdFont::loadHotPack)
+        # 0 : Magic (4) "EPDH"
+        # 4 : Version (2) = 1
+        # 6 : Reserved (2)
+        # 8 : GlyphCount (4)
+        # 12: OffsetGlyphs of the .epdfont (4)
+        # 16: OffsetBitmaps of the .epdfont (4)
+        # 20: OffsetBitmaps (4)
+        # 24: Records, most frequent first: code point (4) + glyph record as in the .epdfont
+        # Then the bitmaps as stored in the .epdfont, in record order
+        record_size = 4 + len(glyph_record(glyph_props[0]))
+        f.write(b"EPDH")
+        f.write(struct.pack("<HHIIII", 1, 0, len(hot), offset_glyphs, offset_bitmaps, 24 + len(hot) * record_size))
+        for g in hot:
+            f.write(struct.pack("<I", g.code_point))
+            f.write(glyph_record(g))
+        for g in hot:
+            f.write(bytes(glyph_data[g.data_offset:g.data_offset + g.data_length]))
+    hot_bitmaps = sum(g.data_length for g in hot)
+    print(f"Generated {font_name}.epdhot ({len(hot)} glyphs, bitmaps {hot_bitmaps} bytes)")
@@ -57,11 +57,15 @@ void EpdFontLoader::loadFontsFromSd(GfxRenderer& renderer) {
                       key.c_str());
         renderer.insertFont(id, *family);
         loadedCustomIds.push_back(id);
+        FontManager::getInstance().setReaderFont(SETTINGS.customFontFamily, size);
+        return;
       } else {
         Serial.println("Failed to load custom font family");
       }
     }
   }
+
+  FontManager::getInstance().setReaderFont("", 0);
 }
 
 int EpdFontLoader::getBestFontId(const char* familyName, int size) {
@@ -246,6 +246,9 @@ bool Epub::clearCache() const {
     Serial.printf("[%lu] [EPB] Failed to clear cache\n", millis());
     return false;
   }
+  if (sectionCache) {
+    sectionCache->reset();
+  }
 
   Serial.printf("[%lu] [EPB] Cache cleared successfully\n", millis());
   return true;
@@ -261,6 +264,13 @@ void Epub::setupCacheDir() const {
 
 const std::string& Epub::getCachePath() const { return cachePath; }
 
+SectionCache& Epub::getSectionCache() const {
+  if (!sectionCache) {
+    sectionCache.reset(new SectionCache(cachePath + "/sections"));
+  }
+  return *sectionCache;
+}
+
 const std::string& Epub::getPath() const { return filepath; }
 
 const std::string& Epub::getTitle() const {
@@ -283,7 +293,7 @@ const std::string& Epub::getAuthor() const {
 
 std::string Epub::getCoverBmpPath() const { return cachePath + "/cover.bmp"; }
 
-bool Epub::generateCoverBmp() const {
+bool Epub::generateCoverBmp(const std::function<bool()>& yieldFn) const {
   // Already generated, return true
   if (SdMan.exists(getCoverBmpPath().c_str())) {
     return true;
@@ -321,7 +331,7 @@ bool Epub::generateCoverBmp() const {
       coverJpg.close();
       return false;
     }
-    const bool success = JpegToBmpConverter::jpegFileToBmpStream(coverJpg, coverBmp);
+    const bool success = JpegToBmpConverter::jpegFileToBmpStream(coverJpg, coverBmp, yieldFn);
     coverJpg.close();
     coverBmp.close();
     SdMan.remove(coverJpgTempPath.c_str());
@@ -368,6 +378,22 @@ bool Epub::readItemContentsToStream(const std::string& itemHref, Print& out, con
   return ZipFile(newpath).readFileToStream(path.c_str(), out, chunkSize);
 }
 
+std::unique_ptr<ZipFileReader> Epub::openItemReader(const std::string& itemHref, const size_t chunkSize,
+                                                    const std::string& spoolPath) const {
+  if (itemHref.empty()) {
+    Serial.printf("[%lu] [EBP] Failed to read item, empty href\n", millis());
+    return nullptr;
+  }
+
+  const std::string path = FsHelpers::normalisePath(itemHref);
+  std::unique_ptr<ZipFileReader> reader(new (std::nothrow) ZipFileReader(removeSpecifiedInvalidChars(filepath)));
+  if (!reader || !reader->open(path.c_str(), chunkSize, spoolPath)) {
+    Serial.printf("[%lu] [EBP] Failed to open item %s\n", millis(), path.c_str());
+    return nullptr;
+  }
+  return reader;
+}
+
 bool Epub::getItemSize(const std::string& itemHref, size_t* size) const {
   const std::string path = FsHelpers::normalisePath(itemHref);
     std::string newpath=removeSpecifiedInvalidChars(filepath);
@@ -2,14 +2,17 @@
 
 #include <Print.h>
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "Epub/BookMetadataCache.h"
+#include "Epub/SectionCache.h"
 
 class ZipFile;
+class ZipFileReader;
 
 class Epub {
   // the ncx file
@@ -22,6 +25,8 @@ class Epub {
   std::string cachePath;
   // Spine and TOC cache
   std::unique_ptr<BookMetadataCache> bookMetadataCache;
+  // Variant index and sizes of the section files, shared by all sections of the book
+  mutable std::unique_ptr<SectionCache> sectionCache;
 
   bool findContentOpfFile(std::string* contentOpfFile) const;
   bool parseContentOpf(BookMetadataCache::BookMetadata& bookMetadata);
@@ -39,14 +44,20 @@ class Epub {
   bool clearCache() const;
   void setupCacheDir() const;
   const std::string& getCachePath() const;
+  SectionCache& getSectionCache() const;
   const std::string& getPath() const;
   const std::string& getTitle() const;
   const std::string& getAuthor() const;
   std::string getCoverBmpPath() const;
-  bool generateCoverBmp() const;
+  // yieldFn is called during the JPEG decode, see JpegToBmpConverter::jpegFileToBmpStream
+  bool generateCoverBmp(const std::function<bool()>& yieldFn = nullptr) const;
   uint8_t* readItemContentsToBytes(const std::string& itemHref, size_t* size = nullptr,
                                    bool trailingNullByte = false) const;
   bool readItemContentsToStream(const std::string& itemHref, Print& out, size_t chunkSize) const;
+  // Opens an item for pull based reading, nullptr if it is missing or can't be inflated. With a spoolPath the item is
+  // inflated to that temp file first, see ZipFileReader::open
+  std::unique_ptr<ZipFileReader> openItemReader(const std::string& itemHref, size_t chunkSize,
+                                                const std::string& spoolPath = "") const;
   bool getItemSize(const std::string& itemHref, size_t* size) const;
   BookMetadataCache::SpineEntry getSpineItem(int spineIndex) const;
   BookMetadataCache::TocEntry getTocItem(int tocIndex) const;
@@ -1,13 +1,13 @@
 #include "Page.h"
 
+#include <GfxRenderer.h>
 #include <HardwareSerial.h>
 #include <Serialization.h>
-#include <../GfxRenderer/GfxRenderer.h>
 //gd
 #include "../../src/CrossPointSettings.h"
 
 // gd:专门绘制水平虚线的函数（仅适配你的场景，参数：渲染器、起始X、Y、结束X、虚线段长/间隔）
-void PageLine::drawDashedLine(GfxRenderer& renderer, int x1, int y, int x2, bool isDark) const {
+void PageLine::drawDashedLine(GfxRenderer& renderer, int x1, int y, int x2, bool /*isDark*/) const {
   int startX = std::min(x1, x2);
   int endX = std::max(x1, x2);
   int currentX = startX;
@@ -50,22 +50,51 @@ bool PageLine::serialize(FsFile& file) {
   return block->serialize(file);
 }
 
-std::unique_ptr<PageLine> PageLine::deserialize(FsFile& file) {
+std::unique_ptr<PageLine> PageLine::deserialize(const uint8_t*& data, const uint8_t* end) {
   int16_t xPos;
   int16_t yPos;
-  serialization::readPod(file, xPos);
-  serialization::readPod(file, yPos);
+  if (!serialization::readPod(data, end, xPos) || !serialization::readPod(data, end, yPos)) {
+    return nullptr;
+  }
 
-  auto tb = TextBlock::deserialize(file);
+  auto tb = TextBlock::deserialize(data, end);
+  if (!tb) {
+    return nullptr;
+  }
   return std::unique_ptr<PageLine>(new PageLine(std::move(tb), xPos, yPos));
 }
 
+bool PageLine::skip(FsFile& file, const uint64_t end) {
+  constexpr uint32_t positionSize = sizeof(xPos) + sizeof(yPos);
+  return file.position() + positionSize <= end && file.seekCur(positionSize) && TextBlock::skip(file, end);
+}
+
 void Page::render(GfxRenderer& renderer, const int fontId, const int xOffset, const int yOffset) const {
+  // Load every glyph on the page up front, so SD backed fonts read them in file order rather than one by one
+  std::vector<uint32_t> codepointsByStyle[EpdFontStyles::STYLE_COUNT];
+  for (const auto& element : elements) {
+    element->collectCodepoints(codepointsByStyle);
+  }
+  for (int style = 0; style < EpdFontStyles::STYLE_COUNT; style++) {
+    if (!codepointsByStyle[style].empty()) {
+      renderer.prefetchGlyphs(fontId, codepointsByStyle[style].data(), codepointsByStyle[style].size(),
+                              static_cast<EpdFontFamily::Style>(style));
+    }
+  }
+
   for (auto& element : elements) {
     element->render(renderer, fontId, xOffset, yOffset);
   }
 }
 
+size_t Page::memoryUsage() const {
+  size_t bytes = sizeof(*this) + elements.capacity() * sizeof(elements[0]);
+  for (const auto& element : elements) {
+    bytes += element->memoryUsage();
+  }
+  return bytes;
+}
+
 bool Page::serialize(FsFile& file) const {
   const uint32_t count = elements.size();
   serialization::writePod(file, count);
@@ -81,18 +110,26 @@ bool Page::serialize(FsFile& file) const {
   return true;
 }
 
-std::unique_ptr<Page> Page::deserialize(FsFile& file) {
+std::unique_ptr<Page> Page::deserialize(const uint8_t* data, const size_t size) {
   auto page = std::unique_ptr<Page>(new Page());
+  const uint8_t* end = data + size;
 
   uint32_t count;
-  serialization::readPod(file, count);
+  if (!serialization::readPod(data, end, count)) {
+    Serial.printf("[%lu] [PGE] Deserialization failed: Truncated page\n", millis());
+    return nullptr;
+  }
 
   for (uint32_t i = 0; i < count; i++) {
-    uint8_t tag;
-    serialization::readPod(file, tag);
+    uint8_t tag = 0;
+    serialization::readPod(data, end, tag);
 
     if (tag == TAG_PageLine) {
-      auto pl = PageLine::deserialize(file);
+      auto pl = PageLine::deserialize(data, end);
+      if (!pl) {
+        Serial.printf("[%lu] [PGE] Deserialization failed: Bad line %u\n", millis(), i);
+        return nullptr;
+      }
       page->elements.push_back(std::move(pl));
     } else {
       Serial.printf("[%lu] [PGE] Deserialization failed: Unknown tag %u\n", millis(), tag);
@@ -102,3 +139,24 @@ std::unique_ptr<Page> Page::deserialize(FsFile& file) {
 
   return page;
 }
+
+bool Page::skip(FsFile& file, const uint64_t end) {
+  uint32_t count;
+  if (file.position() + sizeof(count) > end) {
+    return false;
+  }
+  serialization::readPod(file, count);
+
+  for (uint32_t i = 0; i < count; i++) {
+    uint8_t tag = 0;
+    if (file.position() + sizeof(tag) > end) {
+      return false;
+    }
+    serialization::readPod(file, tag);
+    if (tag != TAG_PageLine || !PageLine::skip(file, end)) {
+      return false;
+    }
+  }
+
+  return true;
+}
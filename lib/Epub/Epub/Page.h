@@ -18,6 +18,10 @@ class PageElement {
   explicit PageElement(const int16_t xPos, const int16_t yPos) : xPos(xPos), yPos(yPos) {}
   virtual ~PageElement() = default;
   virtual void render(GfxRenderer& renderer, int fontId, int xOffset, int yOffset) = 0;
+  // appends the codepoints this element draws, per font style
+  virtual void collectCodepoints(std::vector<uint32_t>* /*codepointsByStyle*/) const {}
+  // approximate heap and object bytes held by the element
+  virtual size_t memoryUsage() const = 0;
   virtual bool serialize(FsFile& file) = 0;
 };
 
@@ -31,8 +35,13 @@ class PageLine final : public PageElement {
   PageLine(std::shared_ptr<TextBlock> block, const int16_t xPos, const int16_t yPos)
       : PageElement(xPos, yPos), block(std::move(block)) {}
   void render(GfxRenderer& renderer, int fontId, int xOffset, int yOffset) override;
+  void collectCodepoints(std::vector<uint32_t>* codepointsByStyle) const override {
+    block->collectCodepoints(codepointsByStyle);
+  }
+  size_t memoryUsage() const override { return sizeof(*this) + block->memoryUsage(); }
   bool serialize(FsFile& file) override;
-  static std::unique_ptr<PageLine> deserialize(FsFile& file);
+  static std::unique_ptr<PageLine> deserialize(const uint8_t*& data, const uint8_t* end);
+  static bool skip(FsFile& file, uint64_t end);
 };
 
 class Page {
@@ -40,6 +49,10 @@ class Page {
   // the list of block index and line numbers on this page
   std::vector<std::shared_ptr<PageElement>> elements;
   void render(GfxRenderer& renderer, int fontId, int xOffset, int yOffset) const;
+  size_t memoryUsage() const;
   bool serialize(FsFile& file) const;
-  static std::unique_ptr<Page> deserialize(FsFile& file);
+  // parses a page from its bytes in the section file
+  static std::unique_ptr<Page> deserialize(const uint8_t* data, size_t size);
+  // moves the file past a serialized page without parsing its lines, false if it does not end by end
+  static bool skip(FsFile& file, uint64_t end);
 };
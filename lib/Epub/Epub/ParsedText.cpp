@@ -11,7 +11,7 @@
 
 constexpr int MAX_COST = std::numeric_limits<int>::max();
 
-void ParsedText::addWord(std::string word, const EpdFontFamily::Style fontStyle) {
+void ParsedText::addWord(const std::string& word, const EpdFontFamily::Style fontStyle) {
   if (word.empty()) return;
 
   // 判断是否包含中文字符（非ASCII字符）
@@ -27,38 +27,52 @@ void ParsedText::addWord(std::string word, const EpdFontFamily::Style fontStyle)
     // 先把word.c_str()转成校准函数需要的类型，再调用校准
     const unsigned char* calibrate_ptr = reinterpret_cast<const unsigned char*>(word.c_str());
     calibrateUtf8Pointer(calibrate_ptr);
-    // 按UTF-8字符拆分（每个中文字符为一个“单词”）
+    // 按UTF-8字符拆分（每个中文字符为一个“单词”），直接写入文字区，不再为每个字分配一个字符串
     const uint8_t* p = reinterpret_cast<const uint8_t*>(word.c_str());
     uint32_t cp;
     while ((cp = utf8NextCodepoint(&p))) {
-      std::string buf;
+      const size_t offset = beginWord();
       // 直接在当前函数中实现Unicode转UTF-8
       if (cp < 0x80) {
-        buf += static_cast<char>(cp);
+        text += static_cast<char>(cp);
       } else if (cp < 0x800) {
-        buf += static_cast<char>(0xC0 | (cp >> 6));
-        buf += static_cast<char>(0x80 | (cp & 0x3F));
+        text += static_cast<char>(0xC0 | (cp >> 6));
+        text += static_cast<char>(0x80 | (cp & 0x3F));
       } else if (cp < 0x10000) {
-        buf += static_cast<char>(0xE0 | (cp >> 12));
-        buf += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
-        buf += static_cast<char>(0x80 | (cp & 0x3F));
+        text += static_cast<char>(0xE0 | (cp >> 12));
+        text += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        text += static_cast<char>(0x80 | (cp & 0x3F));
       } else if (cp < 0x200000) {
-        buf += static_cast<char>(0xF0 | (cp >> 18));
-        buf += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
-        buf += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
-        buf += static_cast<char>(0x80 | (cp & 0x3F));
+        text += static_cast<char>(0xF0 | (cp >> 18));
+        text += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        text += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        text += static_cast<char>(0x80 | (cp & 0x3F));
       }
-      words.push_back(buf);
-      wordStyles.push_back(fontStyle);
+      endWord(offset, fontStyle);
     }
   } else {
     // 英文按原逻辑保留
-    words.push_back(std::move(word));
-    wordStyles.push_back(fontStyle);
+    const size_t offset = beginWord();
+    text += word;
+    endWord(offset, fontStyle);
   }
 }
 
+// Starts a word at the end of the text, the caller appends its bytes and then calls endWord
+size_t ParsedText::beginWord() {
+  const size_t offset = text.size();
+  // add em-space at the beginning of first word in paragraph to indent
+  if (words.empty() && !extraParagraphSpacing) {
+    text += "\xe2\x80\x83";
+  }
+  return offset;
+}
 
+void ParsedText::endWord(const size_t offset, const EpdFontFamily::Style fontStyle) {
+  words.push_back({static_cast<uint32_t>(offset), static_cast<uint16_t>(text.size() - offset),
+                   static_cast<uint8_t>(fontStyle)});
+  text += '\0';
+}
 
 // Consumes data to minimize memory usage
 void ParsedText::layoutAndExtractLines(const GfxRenderer& renderer, const int fontId, const int viewportWidth,
@@ -77,28 +91,29 @@ void ParsedText::layoutAndExtractLines(const GfxRenderer& renderer, const int fo
   for (size_t i = 0; i < lineCount; ++i) {
     extractLine(i, pageWidth, spaceWidth, wordWidths, lineBreakIndices, processLine);
   }
-}
-
-std::vector<uint16_t> ParsedText::calculateWordWidths(const GfxRenderer& renderer, const int fontId) {
-  const size_t totalWordCount = words.size();
-
-  std::vector<uint16_t> wordWidths;
-  wordWidths.reserve(totalWordCount);
 
-  // add em-space at the beginning of first word in paragraph to indent
-  if (!extraParagraphSpacing) {
-    std::string& first_word = words.front();
-    first_word.insert(0, "\xe2\x80\x83");
+  // Drop the words handed out, keeping only those of a held back last line
+  const size_t consumed = lineCount > 0 ? lineBreakIndices[lineCount - 1] : 0;
+  if (consumed == words.size()) {
+    std::string().swap(text);
+    std::vector<Word>().swap(words);
+  } else if (consumed > 0) {
+    const uint32_t textStart = words[consumed].offset;
+    text.erase(0, textStart);
+    words.erase(words.begin(), words.begin() + consumed);
+    for (auto& word : words) {
+      word.offset -= textStart;
+    }
   }
+}
 
-  auto wordsIt = words.begin();
-  auto wordStylesIt = wordStyles.begin();
-
-  while (wordsIt != words.end()) {
-    wordWidths.push_back(renderer.getTextWidth(fontId, wordsIt->c_str(), *wordStylesIt));
+std::vector<uint16_t> ParsedText::calculateWordWidths(const GfxRenderer& renderer, const int fontId) const {
+  std::vector<uint16_t> wordWidths;
+  wordWidths.reserve(words.size());
 
-    std::advance(wordsIt, 1);
-    std::advance(wordStylesIt, 1);
+  for (const auto& word : words) {
+    wordWidths.push_back(
+        renderer.getTextWidth(fontId, text.c_str() + word.offset, static_cast<EpdFontFamily::Style>(word.style)));
   }
 
   return wordWidths;
@@ -185,7 +200,7 @@ std::vector<size_t> ParsedText::computeLineBreaks(const int pageWidth, const int
 
 void ParsedText::extractLine(const size_t breakIndex, const int pageWidth, const int spaceWidth,
                              const std::vector<uint16_t>& wordWidths, const std::vector<size_t>& lineBreakIndices,
-                             const std::function<void(std::shared_ptr<TextBlock>)>& processLine) {
+                             const std::function<void(std::shared_ptr<TextBlock>)>& processLine) const {
   const size_t lineBreak = lineBreakIndices[breakIndex];
   const size_t lastBreakAt = breakIndex > 0 ? lineBreakIndices[breakIndex - 1] : 0;
   const size_t lineWordCount = lineBreak - lastBreakAt;
@@ -214,25 +229,15 @@ void ParsedText::extractLine(const size_t breakIndex, const int pageWidth, const
     xpos = (spareSpace - (lineWordCount - 1) * spaceWidth) / 2;
   }
 
-  // Pre-calculate X positions for words
-  std::list<uint16_t> lineXPos;
+  // The words of a line are contiguous in the text, so the line takes a copy of that one range
+  const uint32_t textStart = words[lastBreakAt].offset;
+  const uint32_t textEnd = words[lineBreak - 1].offset + words[lineBreak - 1].length + 1;
+  std::vector<TextBlock::Word> lineWords;
+  lineWords.reserve(lineWordCount);
   for (size_t i = lastBreakAt; i < lineBreak; i++) {
-    const uint16_t currentWordWidth = wordWidths[i];
-    lineXPos.push_back(xpos);
-    xpos += currentWordWidth + spacing;
+    lineWords.push_back({static_cast<uint16_t>(words[i].offset - textStart), words[i].length, xpos, words[i].style});
+    xpos += wordWidths[i] + spacing;
   }
 
-  // Iterators always start at the beginning as we are moving content with splice below
-  auto wordEndIt = words.begin();
-  auto wordStyleEndIt = wordStyles.begin();
-  std::advance(wordEndIt, lineWordCount);
-  std::advance(wordStyleEndIt, lineWordCount);
-
-  // *** CRITICAL STEP: CONSUME DATA USING SPLICE ***
-  std::list<std::string> lineWords;
-  lineWords.splice(lineWords.begin(), words, words.begin(), wordEndIt);
-  std::list<EpdFontFamily::Style> lineWordStyles;
-  lineWordStyles.splice(lineWordStyles.begin(), wordStyles, wordStyles.begin(), wordStyleEndIt);
-
-  processLine(std::make_shared<TextBlock>(std::move(lineWords), std::move(lineXPos), std::move(lineWordStyles), style));
+  processLine(std::make_shared<TextBlock>(text.substr(textStart, textEnd - textStart), std::move(lineWords), style));
 }
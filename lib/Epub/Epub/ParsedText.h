@@ -3,7 +3,6 @@
 #include <EpdFontFamily.h>
 
 #include <functional>
-#include <list>
 #include <memory>
 #include <string>
 #include <vector>
@@ -13,23 +12,32 @@
 class GfxRenderer;
 
 class ParsedText {
-  std::list<std::string> words;
-  std::list<EpdFontFamily::Style> wordStyles;
+  // A word is the NUL terminated run of UTF-8 bytes at offset in text
+  struct Word {
+    uint32_t offset;
+    uint16_t length;
+    uint8_t style;
+  };
+
+  std::string text;
+  std::vector<Word> words;
   TextBlock::BLOCK_STYLE style;
   bool extraParagraphSpacing;
 
   std::vector<size_t> computeLineBreaks(int pageWidth, int spaceWidth, const std::vector<uint16_t>& wordWidths) const;
   void extractLine(size_t breakIndex, int pageWidth, int spaceWidth, const std::vector<uint16_t>& wordWidths,
                    const std::vector<size_t>& lineBreakIndices,
-                   const std::function<void(std::shared_ptr<TextBlock>)>& processLine);
-  std::vector<uint16_t> calculateWordWidths(const GfxRenderer& renderer, int fontId);
+                   const std::function<void(std::shared_ptr<TextBlock>)>& processLine) const;
+  std::vector<uint16_t> calculateWordWidths(const GfxRenderer& renderer, int fontId) const;
+  size_t beginWord();
+  void endWord(size_t offset, EpdFontFamily::Style fontStyle);
 
  public:
   explicit ParsedText(const TextBlock::BLOCK_STYLE style, const bool extraParagraphSpacing)
       : style(style), extraParagraphSpacing(extraParagraphSpacing) {}
   ~ParsedText() = default;
 
-  void addWord(std::string word, EpdFontFamily::Style fontStyle);
+  void addWord(const std::string& word, EpdFontFamily::Style fontStyle);
   void setStyle(const TextBlock::BLOCK_STYLE style) { this->style = style; }
   TextBlock::BLOCK_STYLE getStyle() const { return style; }
   size_t size() const { return words.size(); }
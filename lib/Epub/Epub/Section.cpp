@@ -1,32 +1,129 @@
 #include "Section.h"
 
+#include <Arduino.h>
+#include <CodepointSet.h>
 #include <SDCardManager.h>
 #include <Serialization.h>
+#include <ZipFile.h>
+
+#include <algorithm>
+#include <cstdlib>
 
 #include "Page.h"
 #include "parsers/ChapterHtmlSlimParser.h"
 
 namespace {
-constexpr uint8_t SECTION_FILE_VERSION = 7;
-constexpr uint32_t HEADER_SIZE = sizeof(uint8_t) + sizeof(int) + sizeof(float) + sizeof(bool) + sizeof(int) +
-                                 sizeof(int) + sizeof(int) + sizeof(uint32_t);
+constexpr uint8_t SECTION_FILE_VERSION = 9;
+// Pages kept in memory, enough for the current page and its neighbours
+constexpr size_t PAGE_CACHE_MAX_PAGES = 3;
+constexpr size_t PAGE_CACHE_MAX_BYTES = 32 * 1024;
+// Pages written between syncs while building, which is what a crash or power cut can lose
+constexpr int CHECKPOINT_PAGES = 8;
+// Section files kept per book across all layout variants, several variants of a typical book fit
+constexpr uint64_t SECTION_CACHE_BUDGET_BYTES = 16 * 1024 * 1024;
+// Compressed bytes read from the epub at a time while inflating a chapter
+constexpr size_t READ_CHUNK_SIZE = 1024;
+// Heap the parser and layout need on top of the inflate state to inflate a chapter straight into the parser
+constexpr uint32_t MIN_FREE_HEAP_FOR_LAYOUT = 48 * 1024;
+// Where the resume point of a partial build sits in the header, after the layout parameters, and the room it has
+constexpr uint32_t RESUME_POINT_OFFSET =
+    sizeof(uint8_t) + sizeof(int) + sizeof(float) + sizeof(bool) + sizeof(int) + sizeof(int);
+constexpr uint32_t RESUME_POINT_SIZE = 192;
+// Its fields before the open tags, and the open tags' length
+constexpr uint32_t RESUME_POINT_FIELDS_SIZE = sizeof(uint32_t) + sizeof(uint32_t) + sizeof(int) + sizeof(int16_t) +
+                                              4 * sizeof(int) + sizeof(bool) + sizeof(uint32_t) + sizeof(uint32_t);
+constexpr uint32_t HEADER_SIZE = RESUME_POINT_OFFSET + RESUME_POINT_SIZE + sizeof(int) + sizeof(uint32_t);
 }  // namespace
 
-uint32_t Section::onPageComplete(std::unique_ptr<Page> page) {
+bool Section::onPageComplete(std::unique_ptr<Page> page) {
   if (!file) {
     Serial.printf("[%lu] [SCT] File not open for writing page %d\n", millis(), pageCount);
-    return 0;
+    return false;
   }
 
-  const uint32_t position = file.position();
-  if (!page->serialize(file)) {
+  // Pages may have been read since the last one was written, append after the last page
+  if (!file.seek(pageOffsets.back()) || !page->serialize(file)) {
     Serial.printf("[%lu] [SCT] Failed to serialize page %d\n", millis(), pageCount);
-    return 0;
+    return false;
   }
   Serial.printf("[%lu] [SCT] Page %d processed\n", millis(), pageCount);
 
+  pageOffsets.push_back(file.position());
   pageCount++;
-  return position;
+  // The last checkpoint lies before this page, so resuming there lays out nothing past the pages in the file
+  if (latestCheckpoint.offset > 0 &&
+      RESUME_POINT_FIELDS_SIZE + latestCheckpoint.openTags.size() <= RESUME_POINT_SIZE) {
+    resumePoint = latestCheckpoint;
+  }
+  if (pageCount % CHECKPOINT_PAGES == 0) {
+    writeResumePoint();
+    file.sync();
+  }
+  return true;
+}
+
+void Section::writeResumePoint() {
+  if (!file.seek(RESUME_POINT_OFFSET)) {
+    return;
+  }
+  serialization::writePod(file, resumePoint.offset);
+  serialization::writePod(file, resumePoint.prologEnd);
+  serialization::writePod(file, resumePoint.pagesCompleted);
+  serialization::writePod(file, resumePoint.pageNextY);
+  serialization::writePod(file, resumePoint.depth);
+  serialization::writePod(file, resumePoint.skipUntilDepth);
+  serialization::writePod(file, resumePoint.boldUntilDepth);
+  serialization::writePod(file, resumePoint.italicUntilDepth);
+  serialization::writePod(file, resumePoint.inPTag);
+  serialization::writePod(file, resumePoint.pCharCount);
+  serialization::writeString(file, resumePoint.openTags);
+}
+
+// A resume point that overruns its room in the header is dropped, the build then starts from the chapter start
+void Section::readResumePoint() {
+  resumePoint = {};
+  uint32_t tagsLength = 0;
+  if (!file.seek(RESUME_POINT_OFFSET)) {
+    return;
+  }
+  serialization::readPod(file, resumePoint.offset);
+  serialization::readPod(file, resumePoint.prologEnd);
+  serialization::readPod(file, resumePoint.pagesCompleted);
+  serialization::readPod(file, resumePoint.pageNextY);
+  serialization::readPod(file, resumePoint.depth);
+  serialization::readPod(file, resumePoint.skipUntilDepth);
+  serialization::readPod(file, resumePoint.boldUntilDepth);
+  serialization::readPod(file, resumePoint.italicUntilDepth);
+  serialization::readPod(file, resumePoint.inPTag);
+  serialization::readPod(file, resumePoint.pCharCount);
+  serialization::readPod(file, tagsLength);
+  if (RESUME_POINT_FIELDS_SIZE + static_cast<uint64_t>(tagsLength) > RESUME_POINT_SIZE) {
+    resumePoint = {};
+    return;
+  }
+  resumePoint.openTags.resize(tagsLength);
+  if (tagsLength > 0 && file.read(&resumePoint.openTags[0], tagsLength) != static_cast<int>(tagsLength)) {
+    resumePoint = {};
+  }
+}
+
+void Section::selectVariant(const int fontId, const float lineCompression, const bool extraParagraphSpacing,
+                            const int viewportWidth, const int viewportHeight) {
+  variant = SectionCache::fingerprint(SECTION_FILE_VERSION, fontId, lineCompression, extraParagraphSpacing,
+                                      viewportWidth, viewportHeight);
+  auto path = cache.getSectionPath(spineIndex, variant);
+  if (path == filePath) {
+    return;
+  }
+  // Anything loaded or built so far belongs to another variant's file
+  file.close();
+  complete = false;
+  pageCount = 0;
+  pageOffsets.clear();
+  pageCache.clear();
+  pageCacheBytes = 0;
+  resumePoint = {};
+  filePath = std::move(path);
 }
 
 void Section::writeSectionFileHeader(const int fontId, const float lineCompression, const bool extraParagraphSpacing,
@@ -35,9 +132,11 @@ void Section::writeSectionFileHeader(const int fontId, const float lineCompressi
     Serial.printf("[%lu] [SCT] File not open for writing header\n", millis());
     return;
   }
-  static_assert(HEADER_SIZE == sizeof(SECTION_FILE_VERSION) + sizeof(fontId) + sizeof(lineCompression) +
-                                   sizeof(extraParagraphSpacing) + sizeof(viewportWidth) + sizeof(viewportHeight) +
-                                   sizeof(pageCount) + sizeof(uint32_t),
+  static_assert(RESUME_POINT_OFFSET == sizeof(SECTION_FILE_VERSION) + sizeof(fontId) + sizeof(lineCompression) +
+                                           sizeof(extraParagraphSpacing) + sizeof(viewportWidth) +
+                                           sizeof(viewportHeight),
+                "Header size mismatch");
+  static_assert(HEADER_SIZE == RESUME_POINT_OFFSET + RESUME_POINT_SIZE + sizeof(pageCount) + sizeof(uint32_t),
                 "Header size mismatch");
   serialization::writePod(file, SECTION_FILE_VERSION);
   serialization::writePod(file, fontId);
@@ -45,15 +144,20 @@ void Section::writeSectionFileHeader(const int fontId, const float lineCompressi
   serialization::writePod(file, extraParagraphSpacing);
   serialization::writePod(file, viewportWidth);
   serialization::writePod(file, viewportHeight);
+  // Room for the resume point, none yet
+  const uint8_t noResumePoint[RESUME_POINT_SIZE] = {};
+  file.write(noResumePoint, sizeof(noResumePoint));
   serialization::writePod(file, pageCount);  // Placeholder for page count (will be initially 0 when written)
   serialization::writePod(file, static_cast<uint32_t>(0));  // Placeholder for LUT offset
 }
 
 bool Section::loadSectionFile(const int fontId, const float lineCompression, const bool extraParagraphSpacing,
                               const int viewportWidth, const int viewportHeight) {
+  selectVariant(fontId, lineCompression, extraParagraphSpacing, viewportWidth, viewportHeight);
   if (!SdMan.openFileForRead("SCT", filePath, file)) {
     return false;
   }
+  cache.touch(variant);
 
   // Match parameters
   {
@@ -85,14 +189,81 @@ bool Section::loadSectionFile(const int fontId, const float lineCompression, con
     }
   }
 
+  uint32_t lutOffset = 0;
+  file.seek(HEADER_SIZE - sizeof(uint32_t) - sizeof(pageCount));
   serialization::readPod(file, pageCount);
-  file.close();
+  serialization::readPod(file, lutOffset);
+
+  // No LUT yet, the build was stopped or cut off. Keep the pages it wrote and where it got to for createSectionFile to
+  // resume from.
+  if (lutOffset == 0) {
+    readResumePoint();
+    if (!recoverPageOffsets()) {
+      file.close();
+      Serial.printf("[%lu] [SCT] Deserialization failed: Bad partial section\n", millis());
+      clearCache();
+      return false;
+    }
+    if (resumePoint.pagesCompleted < 0 || resumePoint.pagesCompleted >= pageCount) {
+      resumePoint = {};
+    }
+    Serial.printf("[%lu] [SCT] Deserialization succeeded: %d pages of a partial build\n", millis(), pageCount);
+    return true;
+  }
+
+  if (pageCount < 0 || !readPageOffsets(lutOffset)) {
+    file.close();
+    Serial.printf("[%lu] [SCT] Deserialization failed: Bad page LUT\n", millis());
+    clearCache();
+    return false;
+  }
+  complete = true;
   Serial.printf("[%lu] [SCT] Deserialization succeeded: %d pages\n", millis(), pageCount);
   return true;
 }
 
+bool Section::readPageOffsets(const uint32_t lutOffset) {
+  const size_t lutSize = pageCount * sizeof(uint32_t);
+  if (lutOffset < HEADER_SIZE || lutOffset + static_cast<uint64_t>(lutSize) > file.size()) {
+    return false;
+  }
+  pageOffsets.resize(pageCount + 1);
+  if (!file.seek(lutOffset) || file.read(pageOffsets.data(), lutSize) != static_cast<int>(lutSize)) {
+    return false;
+  }
+  pageOffsets[pageCount] = lutOffset;
+  for (int i = 0; i < pageCount; i++) {
+    if (pageOffsets[i] < HEADER_SIZE || pageOffsets[i] >= pageOffsets[i + 1]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Walks the page records after the header, a page cut off by the end of the file is dropped
+bool Section::recoverPageOffsets() {
+  const uint64_t fileSize = file.size();
+  pageOffsets.assign(1, HEADER_SIZE);
+  pageCount = 0;
+  if (fileSize < HEADER_SIZE || !file.seek(HEADER_SIZE)) {
+    return false;
+  }
+  while (Page::skip(file, fileSize)) {
+    pageOffsets.push_back(file.position());
+    pageCount++;
+  }
+  return true;
+}
+
 // Your updated class method (assuming you are using the 'SD' object, which is a wrapper for a specific filesystem)
-bool Section::clearCache() const {
+bool Section::clearCache() {
+  file.close();
+  complete = false;
+  pageCount = 0;
+  pageOffsets.clear();
+  pageCache.clear();
+  pageCacheBytes = 0;
+  resumePoint = {};
   if (!SdMan.exists(filePath.c_str())) {
     Serial.printf("[%lu] [SCT] Cache does not exist, no action needed\n", millis());
     return true;
@@ -110,118 +281,228 @@ bool Section::clearCache() const {
 bool Section::createSectionFile(const int fontId, const float lineCompression, const bool extraParagraphSpacing,
                                 const int viewportWidth, const int viewportHeight,
                                 const std::function<void()>& progressSetupFn,
-                                const std::function<void(int)>& progressFn) {
+                                const std::function<void(int)>& progressFn, CodepointSet* charset,
+                                const std::function<bool()>& yieldFn) {
   constexpr uint32_t MIN_SIZE_FOR_PROGRESS = 50 * 1024;  // 50KB
   const auto localPath = epub->getSpineItem(spineIndex).href;
-  const auto tmpHtmlPath = epub->getCachePath() + "/.tmp_" + std::to_string(spineIndex) + ".html";
+  selectVariant(fontId, lineCompression, extraParagraphSpacing, viewportWidth, viewportHeight);
 
   // Create cache directory if it doesn't exist
   {
     const auto sectionsDir = epub->getCachePath() + "/sections";
     SdMan.mkdir(sectionsDir.c_str());
   }
-
-  // Retry logic for SD card timing issues
-  bool success = false;
-  uint32_t fileSize = 0;
-  for (int attempt = 0; attempt < 3 && !success; attempt++) {
+  cache.touch(variant);
+
+  // The chapter is inflated straight into the parser, which keeps the inflate state allocated during layout. When the
+  // heap can't spare that it is inflated to a temp file first and the parser reads that back, as it used to be.
+  const uint32_t freeHeap = ESP.getFreeHeap();
+  const bool spool = freeHeap < ZipFileReader::inflateStateBytes(READ_CHUNK_SIZE) + MIN_FREE_HEAP_FOR_LAYOUT;
+  const std::string spoolPath = spool ? epub->getCachePath() + "/.tmp_" + std::to_string(spineIndex) + ".html" : "";
+  Serial.printf("[%lu] [SCT] Free heap %u, min free heap %u, %s\n", millis(), freeHeap, ESP.getMinFreeHeap(),
+                spool ? "inflating to a temp file" : "inflating into the parser");
+
+  // Retry opening it for SD card timing issues
+  std::unique_ptr<ZipFileReader> reader;
+  for (int attempt = 0; attempt < 3 && !reader; attempt++) {
     if (attempt > 0) {
-      Serial.printf("[%lu] [SCT] Retrying stream (attempt %d)...\n", millis(), attempt + 1);
+      Serial.printf("[%lu] [SCT] Retrying open (attempt %d)...\n", millis(), attempt + 1);
       delay(50);  // Brief delay before retry
     }
-
-    // Remove any incomplete file from previous attempt before retrying
-    if (SdMan.exists(tmpHtmlPath.c_str())) {
-      SdMan.remove(tmpHtmlPath.c_str());
-    }
-
-    FsFile tmpHtml;
-    if (!SdMan.openFileForWrite("SCT", tmpHtmlPath, tmpHtml)) {
-      continue;
-    }
-    success = epub->readItemContentsToStream(localPath, tmpHtml, 1024);
-    fileSize = tmpHtml.size();
-    tmpHtml.close();
-
-    // If streaming failed, remove the incomplete file immediately
-    if (!success && SdMan.exists(tmpHtmlPath.c_str())) {
-      SdMan.remove(tmpHtmlPath.c_str());
-      Serial.printf("[%lu] [SCT] Removed incomplete temp file after failed attempt\n", millis());
-    }
+    reader = epub->openItemReader(localPath, READ_CHUNK_SIZE, spoolPath);
   }
 
-  if (!success) {
-    Serial.printf("[%lu] [SCT] Failed to stream item contents to temp file after retries\n", millis());
+  if (!reader) {
+    Serial.printf("[%lu] [SCT] Failed to open item contents after retries\n", millis());
     return false;
   }
-
-  Serial.printf("[%lu] [SCT] Streamed temp HTML to %s (%d bytes)\n", millis(), tmpHtmlPath.c_str(), fileSize);
+  const size_t fileSize = reader->getInflatedSize();
 
   // Only show progress bar for larger chapters where rendering overhead is worth it
   if (progressSetupFn && fileSize >= MIN_SIZE_FOR_PROGRESS) {
     progressSetupFn();
   }
 
-  if (!SdMan.openFileForWrite("SCT", filePath, file)) {
-    return false;
+  // Pages from a stopped or cut off build are kept. Layout picks up at the resume point saved with them, or at the
+  // start of the chapter without one, and only pages past the ones in the file are written.
+  int pagesInFile = complete ? 0 : pageCount;
+  if (pagesInFile > 0) {
+    file.close();
+    file = SdMan.open(filePath.c_str(), O_RDWR);
+    if (file && file.truncate(pageOffsets.back())) {
+      Serial.printf("[%lu] [SCT] Resuming after %d pages\n", millis(), pagesInFile);
+    } else {
+      Serial.printf("[%lu] [SCT] Failed to reopen partial section, starting over\n", millis());
+      pagesInFile = 0;
+    }
+  }
+  if (pagesInFile == 0) {
+    file.close();
+    complete = false;
+    pageCount = 0;
+    pageOffsets.assign(1, HEADER_SIZE);
+    pageCache.clear();
+    pageCacheBytes = 0;
+    resumePoint = {};
+    if (!SdMan.openFileForWrite("SCT", filePath, file)) {
+      return false;
+    }
+    writeSectionFileHeader(fontId, lineCompression, extraParagraphSpacing, viewportWidth, viewportHeight);
+  }
+
+  // Bytes of the file that the cache already accounts for
+  const uint32_t bytesBefore = pagesInFile > 0 ? pageOffsets.back() : 0;
+  const ChapterCheckpoint resumeFrom = resumePoint;
+  const bool resuming = resumeFrom.offset > 0 && resumeFrom.pagesCompleted < pagesInFile;
+  if (resuming) {
+    Serial.printf("[%lu] [SCT] Laying out from offset %u of %u\n", millis(), resumeFrom.offset,
+                  static_cast<uint32_t>(fileSize));
+  }
+  latestCheckpoint = {};
+  int pagesLaidOut = resuming ? resumeFrom.pagesCompleted : 0;
+  bool pageWriteFailed = false;
+  bool stopped = false;
+  std::function<bool()> parserYieldFn = nullptr;
+  if (yieldFn) {
+    parserYieldFn = [&yieldFn, &stopped] {
+      stopped = !yieldFn();
+      return !stopped;
+    };
   }
-  writeSectionFileHeader(fontId, lineCompression, extraParagraphSpacing, viewportWidth, viewportHeight);
-  std::vector<uint32_t> lut = {};
 
   ChapterHtmlSlimParser visitor(
-      tmpHtmlPath, renderer, fontId, lineCompression, extraParagraphSpacing, viewportWidth, viewportHeight,
-      [this, &lut](std::unique_ptr<Page> page) { lut.emplace_back(this->onPageComplete(std::move(page))); },
-      progressFn);
-  success = visitor.parseAndBuildPages();
+      *reader, renderer, fontId, lineCompression, extraParagraphSpacing, viewportWidth, viewportHeight,
+      [this, charset, pagesInFile, &pagesLaidOut, &pageWriteFailed](std::unique_ptr<Page> page) {
+        if (charset) {
+          // Only the regular style is subset, see FontManager::beginBookSubsetUpdate
+          std::vector<uint32_t> codepointsByStyle[EpdFontStyles::STYLE_COUNT];
+          for (const auto& element : page->elements) {
+            element->collectCodepoints(codepointsByStyle);
+          }
+          for (const uint32_t cp : codepointsByStyle[EpdFontStyles::REGULAR]) {
+            charset->add(cp);
+          }
+        }
+        if (pagesLaidOut++ >= pagesInFile && !this->onPageComplete(std::move(page))) {
+          pageWriteFailed = true;
+        }
+      },
+      progressFn, parserYieldFn,
+      [this](const ChapterCheckpoint& checkpoint) { latestCheckpoint = checkpoint; });
+  const auto layoutStart = millis();
+  const bool success = visitor.parseAndBuildPages(resuming ? &resumeFrom : nullptr);
+  Serial.printf("[%lu] [SCT] Parsed and laid out %d pages in %lums, min free heap %u\n", millis(), pageCount,
+                millis() - layoutStart, ESP.getMinFreeHeap());
+
+  if (stopped) {
+    // The pages so far stay readable and in the file, with where to pick up after them
+    writeResumePoint();
+    file.sync();
+    cache.addBytes(variant, pageOffsets.back() - bytesBefore);
+    Serial.printf("[%lu] [SCT] Layout stopped after %d pages\n", millis(), pageCount);
+    return false;
+  }
 
-  SdMan.remove(tmpHtmlPath.c_str());
-  if (!success) {
+  if (!success || pageWriteFailed) {
     Serial.printf("[%lu] [SCT] Failed to parse XML and build pages\n", millis());
-    file.close();
-    SdMan.remove(filePath.c_str());
+    clearCache();
     return false;
   }
 
-  const uint32_t lutOffset = file.position();
-  bool hasFailedLutRecords = false;
   // Write LUT
-  for (const uint32_t& pos : lut) {
-    if (pos == 0) {
-      hasFailedLutRecords = true;
-      break;
-    }
-    serialization::writePod(file, pos);
+  const uint32_t lutOffset = pageOffsets.back();
+  file.seek(lutOffset);
+  for (int i = 0; i < pageCount; i++) {
+    serialization::writePod(file, pageOffsets[i]);
   }
 
-  if (hasFailedLutRecords) {
-    Serial.printf("[%lu] [SCT] Failed to write LUT due to invalid page positions\n", millis());
-    file.close();
-    SdMan.remove(filePath.c_str());
-    return false;
-  }
+  // A complete file has no resume point
+  resumePoint = {};
+  writeResumePoint();
 
   // Go back and write LUT offset
   file.seek(HEADER_SIZE - sizeof(uint32_t) - sizeof(pageCount));
   serialization::writePod(file, pageCount);
   serialization::writePod(file, lutOffset);
   file.close();
-  return true;
+
+  // The book's sections grew, make room by dropping variants that haven't been used for the longest
+  cache.addBytes(variant, lutOffset + pageCount * sizeof(uint32_t) - bytesBefore);
+  cache.evict(variant, SECTION_CACHE_BUDGET_BYTES);
+
+  // Keep the file open for reading pages, the LUT is already in memory
+  complete = true;
+  return SdMan.openFileForRead("SCT", filePath, file);
 }
 
-std::unique_ptr<Page> Section::loadPageFromSectionFile() {
-  if (!SdMan.openFileForRead("SCT", filePath, file)) {
+std::shared_ptr<Page> Section::readPage(const int index) {
+  if (!file || index < 0 || index >= pageCount || pageOffsets.size() != static_cast<size_t>(pageCount) + 1) {
+    Serial.printf("[%lu] [SCT] Page %d not available\n", millis(), index);
     return nullptr;
   }
 
-  file.seek(HEADER_SIZE - sizeof(uint32_t));
-  uint32_t lutOffset;
-  serialization::readPod(file, lutOffset);
-  file.seek(lutOffset + sizeof(uint32_t) * currentPage);
-  uint32_t pagePos;
-  serialization::readPod(file, pagePos);
-  file.seek(pagePos);
+  const uint32_t pageSize = pageOffsets[index + 1] - pageOffsets[index];
+  std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[pageSize]);
+  if (!buffer) {
+    Serial.printf("[%lu] [SCT] Failed to allocate %u bytes for page %d\n", millis(), pageSize, index);
+    return nullptr;
+  }
+  if (!file.seek(pageOffsets[index]) || file.read(buffer.get(), pageSize) != static_cast<int>(pageSize)) {
+    Serial.printf("[%lu] [SCT] Failed to read page %d\n", millis(), index);
+    return nullptr;
+  }
 
-  auto page = Page::deserialize(file);
-  file.close();
+  return Page::deserialize(buffer.get(), pageSize);
+}
+
+void Section::cachePage(const int index, std::shared_ptr<Page> page) {
+  const size_t bytes = page->memoryUsage();
+  pageCache.push_back({index, std::move(page), bytes});
+  pageCacheBytes += bytes;
+
+  // Evict the page furthest from the one last shown, the oldest of those on a tie, always keeping the newest
+  while (pageCache.size() > 1 &&
+         (pageCache.size() > PAGE_CACHE_MAX_PAGES || pageCacheBytes > PAGE_CACHE_MAX_BYTES)) {
+    size_t victim = 0;
+    for (size_t i = 1; i + 1 < pageCache.size(); i++) {
+      if (std::abs(pageCache[i].index - lastLoadedPage) > std::abs(pageCache[victim].index - lastLoadedPage)) {
+        victim = i;
+      }
+    }
+    pageCacheBytes -= pageCache[victim].bytes;
+    pageCache.erase(pageCache.begin() + victim);
+  }
+}
+
+std::shared_ptr<Page> Section::loadPage(const int index) {
+  lastLoadedPage = index;
+  for (size_t i = 0; i < pageCache.size(); i++) {
+    if (pageCache[i].index == index) {
+      pageCacheHits++;
+      // Move to the back as the most recently used
+      std::rotate(pageCache.begin() + i, pageCache.begin() + i + 1, pageCache.end());
+      return pageCache.back().page;
+    }
+  }
+
+  pageCacheMisses++;
+  auto page = readPage(index);
+  if (page) {
+    cachePage(index, page);
+  }
   return page;
 }
+
+void Section::prefetchPage(const int index) {
+  if (index < 0 || index >= pageCount) {
+    return;
+  }
+  for (const auto& cached : pageCache) {
+    if (cached.index == index) {
+      return;
+    }
+  }
+  if (auto page = readPage(index)) {
+    cachePage(index, std::move(page));
+  }
+}
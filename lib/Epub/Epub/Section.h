@@ -1,38 +1,82 @@
 #pragma once
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "Epub.h"
+#include "SectionCache.h"
+#include "parsers/ChapterCheckpoint.h"
 
 class Page;
 class GfxRenderer;
+class CodepointSet;
 
 class Section {
   std::shared_ptr<Epub> epub;
   const int spineIndex;
   GfxRenderer& renderer;
+  SectionCache& cache;
+  // The file of the variant for the layout parameters last passed in, see SectionCache
+  uint32_t variant = 0;
   std::string filePath;
+  // Written while the section is built, then kept open for reading pages
   FsFile file;
+  // File offset of every page followed by where the last page ends, which becomes the LUT offset
+  std::vector<uint32_t> pageOffsets;
+  // Set once the LUT is written. Until then pages are readable as they are appended, and a build that was
+  // stopped or cut off resumes after the pages already in the file.
+  bool complete = false;
+  // The parser's last checkpoint, and the last one before a page written to the file. The latter is kept in the
+  // header of a partial file, a build resumes there rather than at the start of the chapter.
+  ChapterCheckpoint latestCheckpoint;
+  ChapterCheckpoint resumePoint;
 
+  // Recently loaded pages, oldest first. Holds the page on screen and the ones either side of it.
+  struct CachedPage {
+    int index;
+    std::shared_ptr<Page> page;
+    size_t bytes;
+  };
+  std::vector<CachedPage> pageCache;
+  size_t pageCacheBytes = 0;
+  int lastLoadedPage = 0;
+  uint32_t pageCacheHits = 0;
+  uint32_t pageCacheMisses = 0;
+
+  void selectVariant(int fontId, float lineCompression, bool extraParagraphSpacing, int viewportWidth,
+                     int viewportHeight);
   void writeSectionFileHeader(int fontId, float lineCompression, bool extraParagraphSpacing, int viewportWidth,
                               int viewportHeight);
-  uint32_t onPageComplete(std::unique_ptr<Page> page);
+  bool onPageComplete(std::unique_ptr<Page> page);
+  void writeResumePoint();
+  void readResumePoint();
+  bool readPageOffsets(uint32_t lutOffset);
+  bool recoverPageOffsets();
+  std::shared_ptr<Page> readPage(int index);
+  void cachePage(int index, std::shared_ptr<Page> page);
 
  public:
   int pageCount = 0;
   int currentPage = 0;
 
   explicit Section(const std::shared_ptr<Epub>& epub, const int spineIndex, GfxRenderer& renderer)
-      : epub(epub),
-        spineIndex(spineIndex),
-        renderer(renderer),
-        filePath(epub->getCachePath() + "/sections/" + std::to_string(spineIndex) + ".bin") {}
-  ~Section() = default;
+      : epub(epub), spineIndex(spineIndex), renderer(renderer), cache(epub->getSectionCache()) {}
+  ~Section() { file.close(); }
+  // Also succeeds for a partly built file, createSectionFile then resumes it
   bool loadSectionFile(int fontId, float lineCompression, bool extraParagraphSpacing, int viewportWidth,
                        int viewportHeight);
-  bool clearCache() const;
+  bool clearCache();
+  bool isComplete() const { return complete; }
+  // Builds the section, or finishes a partly built one. Pages can be loaded as soon as they are laid out, and a
+  // build stopped through yieldFn keeps its pages for the next call.
   bool createSectionFile(int fontId, float lineCompression, bool extraParagraphSpacing, int viewportWidth,
                          int viewportHeight, const std::function<void()>& progressSetupFn = nullptr,
-                         const std::function<void(int)>& progressFn = nullptr);
-  std::unique_ptr<Page> loadPageFromSectionFile();
+                         const std::function<void(int)>& progressFn = nullptr, CodepointSet* charset = nullptr,
+                         const std::function<bool()>& yieldFn = nullptr);
+  // Returns the page from the page cache, or reads it with one seek and one read of the open section file
+  std::shared_ptr<Page> loadPage(int index);
+  // Reads a page into the page cache ahead of it being shown, no-op if it is out of range or already cached
+  void prefetchPage(int index);
+  uint32_t getPageCacheHits() const { return pageCacheHits; }
+  uint32_t getPageCacheMisses() const { return pageCacheMisses; }
 };
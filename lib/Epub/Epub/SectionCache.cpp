@@ -0,0 +1,228 @@
+#include "SectionCache.h"
+
+#include <HardwareSerial.h>
+#include <SDCardManager.h>
+#include <Serialization.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+constexpr uint8_t INDEX_VERSION = 1;
+constexpr char indexFile[] = "/variants.bin";
+// Variants remembered in the index, files of older ones are treated like unknown files and evicted first
+constexpr size_t MAX_VARIANTS = 8;
+// Variant of files that don't follow the <spine>_<fingerprint>.bin naming
+constexpr uint32_t UNKNOWN_VARIANT = 0;
+
+bool parseVariant(const char* name, uint32_t& variant) {
+  const char* underscore = strchr(name, '_');
+  if (!underscore || strlen(underscore) != 1 + 8 + 4 || strcmp(underscore + 9, ".bin") != 0) {
+    return false;
+  }
+  char* end;
+  variant = strtoul(underscore + 1, &end, 16);
+  return end == underscore + 9 && variant != UNKNOWN_VARIANT;
+}
+}  // namespace
+
+uint32_t SectionCache::fingerprint(const uint8_t version, const int fontId, const float lineCompression,
+                                   const bool extraParagraphSpacing, const int viewportWidth,
+                                   const int viewportHeight) {
+  // FNV-1a over the parameters in the order of the section file header
+  uint32_t hash = 2166136261u;
+  const auto add = [&hash](const void* data, const size_t len) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < len; i++) {
+      hash = (hash ^ bytes[i]) * 16777619u;
+    }
+  };
+  add(&version, sizeof(version));
+  add(&fontId, sizeof(fontId));
+  add(&lineCompression, sizeof(lineCompression));
+  add(&extraParagraphSpacing, sizeof(extraParagraphSpacing));
+  add(&viewportWidth, sizeof(viewportWidth));
+  add(&viewportHeight, sizeof(viewportHeight));
+  return hash == UNKNOWN_VARIANT ? 1 : hash;
+}
+
+std::string SectionCache::getSectionPath(const int spineIndex, const uint32_t variant) const {
+  char name[24];
+  snprintf(name, sizeof(name), "/%d_%08x.bin", spineIndex, static_cast<unsigned>(variant));
+  return dir + name;
+}
+
+const std::vector<uint32_t>& SectionCache::index() {
+  if (indexLoaded) {
+    return variants;
+  }
+  indexLoaded = true;
+  FsFile file;
+  if (!SdMan.exists((dir + indexFile).c_str()) || !SdMan.openFileForRead("SCC", dir + indexFile, file)) {
+    return variants;
+  }
+  uint8_t version = 0;
+  uint8_t count = 0;
+  serialization::readPod(file, version);
+  serialization::readPod(file, count);
+  if (version == INDEX_VERSION && count <= MAX_VARIANTS) {
+    variants.resize(count);
+    const size_t bytes = count * sizeof(uint32_t);
+    if (file.read(variants.data(), bytes) != static_cast<int>(bytes)) {
+      variants.clear();
+    }
+  }
+  file.close();
+  return variants;
+}
+
+void SectionCache::writeIndex() const {
+  FsFile file;
+  if (!SdMan.openFileForWrite("SCC", dir + indexFile, file)) {
+    return;
+  }
+  serialization::writePod(file, INDEX_VERSION);
+  serialization::writePod(file, static_cast<uint8_t>(variants.size()));
+  file.write(reinterpret_cast<const uint8_t*>(variants.data()), variants.size() * sizeof(uint32_t));
+  file.close();
+}
+
+void SectionCache::touch(const uint32_t variant) {
+  if (!index().empty() && variants.front() == variant) {
+    return;
+  }
+  variants.erase(std::remove(variants.begin(), variants.end(), variant), variants.end());
+  variants.insert(variants.begin(), variant);
+  while (variants.size() > MAX_VARIANTS) {
+    forgetSize(variants.back());
+    variants.pop_back();
+  }
+  writeIndex();
+}
+
+SectionCache::VariantSize* SectionCache::findSize(const uint32_t variant) {
+  const auto it =
+      std::find_if(sizes.begin(), sizes.end(), [variant](const VariantSize& s) { return s.variant == variant; });
+  return it == sizes.end() ? nullptr : &*it;
+}
+
+void SectionCache::addBytes(const uint32_t variant, const uint64_t bytes) {
+  if (!sizesKnown) {
+    // Counted by the walk
+    return;
+  }
+  if (auto* size = findSize(variant)) {
+    size->bytes += bytes;
+  } else {
+    sizes.push_back({variant, bytes});
+  }
+  totalBytes += bytes;
+}
+
+void SectionCache::forgetSize(const uint32_t variant) {
+  auto* size = findSize(variant);
+  if (!size || variant == UNKNOWN_VARIANT) {
+    return;
+  }
+  const uint64_t bytes = size->bytes;
+  sizes.erase(sizes.begin() + (size - sizes.data()));
+  totalBytes -= bytes;
+  addBytes(UNKNOWN_VARIANT, bytes);
+}
+
+uint32_t SectionCache::variantOf(const char* name) {
+  const auto& known = index();
+  uint32_t variant;
+  if (!parseVariant(name, variant) || std::find(known.begin(), known.end(), variant) == known.end()) {
+    return UNKNOWN_VARIANT;
+  }
+  return variant;
+}
+
+void SectionCache::reset() {
+  variants.clear();
+  indexLoaded = false;
+  sizes.clear();
+  totalBytes = 0;
+  sizesKnown = false;
+}
+
+void SectionCache::countSizes() {
+  sizes.clear();
+  totalBytes = 0;
+  sizesKnown = true;
+  auto root = SdMan.open(dir.c_str());
+  if (!root || !root.isDirectory()) {
+    return;
+  }
+  char name[64];
+  for (auto file = root.openNextFile(); file; file = root.openNextFile()) {
+    file.getName(name, sizeof(name));
+    if (!file.isDirectory() && strcmp(name, indexFile + 1) != 0) {
+      addBytes(variantOf(name), file.fileSize());
+    }
+    file.close();
+  }
+  root.close();
+}
+
+void SectionCache::evict(const uint32_t keep, const uint64_t budgetBytes) {
+  // Sizes drift from the files when sections are cleared or rebuilt, count them again before removing anything
+  if (!sizesKnown || totalBytes > budgetBytes) {
+    countSizes();
+  }
+
+  // Unknown files are never opened again and always go, then variants from the least recently used end of the index
+  std::vector<uint32_t> evicted;
+  uint64_t bytesLeft = totalBytes;
+  if (const auto* unknown = findSize(UNKNOWN_VARIANT); unknown && unknown->bytes > 0) {
+    evicted.push_back(UNKNOWN_VARIANT);
+    bytesLeft -= unknown->bytes;
+  }
+  const auto& known = index();
+  for (auto variant = known.rbegin(); variant != known.rend() && bytesLeft > budgetBytes; ++variant) {
+    const auto* size = findSize(*variant);
+    if (*variant != keep && size) {
+      evicted.push_back(*variant);
+      bytesLeft -= size->bytes;
+    }
+  }
+  if (evicted.empty()) {
+    return;
+  }
+
+  const auto isEvicted = [&evicted](const uint32_t variant) {
+    return std::find(evicted.begin(), evicted.end(), variant) != evicted.end();
+  };
+  auto root = SdMan.open(dir.c_str());
+  if (!root || !root.isDirectory()) {
+    return;
+  }
+  std::vector<std::string> doomed;
+  char name[64];
+  for (auto file = root.openNextFile(); file; file = root.openNextFile()) {
+    file.getName(name, sizeof(name));
+    if (!file.isDirectory() && strcmp(name, indexFile + 1) != 0 && isEvicted(variantOf(name))) {
+      doomed.emplace_back(name);
+    }
+    file.close();
+  }
+  root.close();
+  for (const auto& file : doomed) {
+    SdMan.remove((dir + "/" + file).c_str());
+  }
+
+  const size_t variantCount = variants.size();
+  variants.erase(std::remove_if(variants.begin(), variants.end(), isEvicted), variants.end());
+  sizes.erase(std::remove_if(sizes.begin(), sizes.end(),
+                             [&isEvicted](const VariantSize& size) { return isEvicted(size.variant); }),
+              sizes.end());
+  totalBytes = bytesLeft;
+  if (variants.size() != variantCount) {
+    writeIndex();
+  }
+  Serial.printf("[%lu] [SCC] Evicted %u section files of %u variants, %llu bytes left\n", millis(),
+                static_cast<unsigned>(doomed.size()), static_cast<unsigned>(evicted.size()),
+                static_cast<unsigned long long>(totalBytes));
+}
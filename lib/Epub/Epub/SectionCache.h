@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The section files of one book. Each set of layout parameters is a variant with its own files, named by a
+// fingerprint of the parameters, so switching back to an earlier font size or orientation finds its sections
+// instead of laying the chapters out again. Variants are kept in most recently used order in a small index, and
+// when the book's sections go over their byte budget whole variants are removed, least recently used first.
+//
+// The index and the bytes used by each variant are kept in memory, so one instance should serve all sections of the
+// book (see Epub::getSectionCache). The index is read on first use, the sizes come from a walk of the directory and
+// are then kept up to date through addBytes.
+class SectionCache {
+  struct VariantSize {
+    uint32_t variant;
+    uint64_t bytes;
+  };
+
+  std::string dir;
+  std::vector<uint32_t> variants;
+  bool indexLoaded = false;
+  // Files of no variant in the index count as UNKNOWN_VARIANT
+  std::vector<VariantSize> sizes;
+  uint64_t totalBytes = 0;
+  bool sizesKnown = false;
+
+  const std::vector<uint32_t>& index();
+  void writeIndex() const;
+  // The variant of a section file name, UNKNOWN_VARIANT unless it is in the index
+  uint32_t variantOf(const char* name);
+  void countSizes();
+  VariantSize* findSize(uint32_t variant);
+  // Moves the variant's bytes to the unknown ones, its files are no longer in the index
+  void forgetSize(uint32_t variant);
+
+ public:
+  explicit SectionCache(std::string dir) : dir(std::move(dir)) {}
+  static uint32_t fingerprint(uint8_t version, int fontId, float lineCompression, bool extraParagraphSpacing,
+                              int viewportWidth, int viewportHeight);
+  std::string getSectionPath(int spineIndex, uint32_t variant) const;
+  // Makes the variant the most recently used one, the index is only written when that changes its order
+  void touch(uint32_t variant);
+  // Accounts for bytes written to a section file of the variant
+  void addBytes(uint32_t variant, uint64_t bytes);
+  // Removes the least recently used variants, never the given one, until the files fit in budgetBytes. Files of no
+  // known variant, such as sections from before variants or of variants dropped from the index, are always removed.
+  // Only walks the directory when that has something to remove, or the first time to learn the sizes.
+  void evict(uint32_t keep, uint64_t budgetBytes);
+  // Forgets the index and sizes, e.g. after the directory was removed
+  void reset();
+};
@@ -2,73 +2,168 @@
 
 #include <GfxRenderer.h>
 #include <Serialization.h>
+#include <Utf8.h>
 
-void TextBlock::render(const GfxRenderer& renderer, const int fontId, const int x, const int y) const {
-  // Validate iterator bounds before rendering
-  if (words.size() != wordXpos.size() || words.size() != wordStyles.size()) {
-    Serial.printf("[%lu] [TXB] Render skipped: size mismatch (words=%u, xpos=%u, styles=%u)\n", millis(),
-                  (uint32_t)words.size(), (uint32_t)wordXpos.size(), (uint32_t)wordStyles.size());
-    return;
+#include <cstring>
+
+namespace {
+void appendVarint(std::string& out, uint32_t value) {
+  while (value >= 0x80) {
+    out += static_cast<char>(value | 0x80);
+    value >>= 7;
   }
+  out += static_cast<char>(value);
+}
 
-  auto wordIt = words.begin();
-  auto wordStylesIt = wordStyles.begin();
-  auto wordXposIt = wordXpos.begin();
+bool readVarint(const uint8_t*& p, const uint8_t* end, uint32_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 35 && p < end; shift += 7) {
+    const uint8_t byte = *p++;
+    value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
 
-  for (size_t i = 0; i < words.size(); i++) {
-    renderer.drawText(fontId, *wordXposIt + x, y, wordIt->c_str(), true, *wordStylesIt);
+void TextBlock::render(const GfxRenderer& renderer, const int fontId, const int x, const int y) const {
+  // The whole line goes to the renderer in one call, the words only need their positions and styles
+  std::vector<GfxRenderer::TextRunWord> run;
+  run.reserve(words.size());
+  for (const auto& word : words) {
+    run.push_back({text.c_str() + word.offset, word.x, static_cast<EpdFontFamily::Style>(word.style)});
+  }
+  renderer.drawTextRun(fontId, x, y, run.data(), run.size());
+}
 
-    std::advance(wordIt, 1);
-    std::advance(wordStylesIt, 1);
-    std::advance(wordXposIt, 1);
+void TextBlock::collectCodepoints(std::vector<uint32_t>* codepointsByStyle) const {
+  for (const auto& word : words) {
+    std::vector<uint32_t>& codepoints = codepointsByStyle[word.style];
+    auto wordText = reinterpret_cast<const unsigned char*>(text.c_str() + word.offset);
+    uint32_t cp;
+    while ((cp = utf8NextCodepoint(&wordText))) {
+      codepoints.push_back(cp);
+    }
   }
 }
 
+// Line record layout, see docs/file-formats.md:
+//   u16 record length, varint word count, varint x deltas, varint style run count, (u8 style, varint run length)
+//   per run, u8 block style, then the words as NUL terminated UTF-8 up to the end of the record
 bool TextBlock::serialize(FsFile& file) const {
-  if (words.size() != wordXpos.size() || words.size() != wordStyles.size()) {
-    Serial.printf("[%lu] [TXB] Serialization failed: size mismatch (words=%u, xpos=%u, styles=%u)\n", millis(),
-                  words.size(), wordXpos.size(), wordStyles.size());
-    return false;
+  std::string record;
+  record.reserve(words.size() * 2 + text.size() + 8);
+  appendVarint(record, words.size());
+  uint16_t lastX = 0;
+  for (const auto& w : words) {
+    appendVarint(record, static_cast<uint16_t>(w.x - lastX));
+    lastX = w.x;
   }
 
-  // Word data
-  serialization::writePod(file, static_cast<uint32_t>(words.size()));
-  for (const auto& w : words) serialization::writeString(file, w);
-  for (auto x : wordXpos) serialization::writePod(file, x);
-  for (auto s : wordStyles) serialization::writePod(file, s);
-
-  // Block style
-  serialization::writePod(file, style);
+  size_t runCount = 0;
+  for (size_t i = 0; i < words.size(); i++) {
+    runCount += i == 0 || words[i].style != words[i - 1].style;
+  }
+  appendVarint(record, runCount);
+  for (size_t i = 0; i < words.size();) {
+    size_t runEnd = i + 1;
+    while (runEnd < words.size() && words[runEnd].style == words[i].style) {
+      runEnd++;
+    }
+    record += static_cast<char>(words[i].style);
+    appendVarint(record, runEnd - i);
+    i = runEnd;
+  }
+  record += static_cast<char>(style);
+  record += text;
 
+  if (record.size() > UINT16_MAX) {
+    Serial.printf("[%lu] [TXB] Serialization failed: line record of %u bytes\n", millis(),
+                  static_cast<unsigned>(record.size()));
+    return false;
+  }
+  serialization::writePod(file, static_cast<uint16_t>(record.size()));
+  file.write(reinterpret_cast<const uint8_t*>(record.data()), record.size());
   return true;
 }
 
-std::unique_ptr<TextBlock> TextBlock::deserialize(FsFile& file) {
-  uint32_t wc;
-  std::list<std::string> words;
-  std::list<uint16_t> wordXpos;
-  std::list<EpdFontFamily::Style> wordStyles;
-  BLOCK_STYLE style;
-
-  // Word count
-  serialization::readPod(file, wc);
+std::unique_ptr<TextBlock> TextBlock::deserialize(const uint8_t*& data, const uint8_t* end) {
+  uint16_t recordLength = 0;
+  if (!serialization::readPod(data, end, recordLength) || recordLength > end - data) {
+    Serial.printf("[%lu] [TXB] Deserialization failed: truncated line record\n", millis());
+    return nullptr;
+  }
 
+  const uint8_t* p = data;
+  const uint8_t* recordEnd = data + recordLength;
+  data = recordEnd;
+  uint32_t wc = 0;
   // Sanity check: prevent allocation of unreasonably large lists (max 10000 words per block)
-  if (wc > 10000) {
+  if (!readVarint(p, recordEnd, wc) || wc > 10000) {
     Serial.printf("[%lu] [TXB] Deserialization failed: word count %u exceeds maximum\n", millis(), wc);
     return nullptr;
   }
 
-  // Word data
-  words.resize(wc);
-  wordXpos.resize(wc);
-  wordStyles.resize(wc);
-  for (auto& w : words) serialization::readString(file, w);
-  for (auto& x : wordXpos) serialization::readPod(file, x);
-  for (auto& s : wordStyles) serialization::readPod(file, s);
+  std::vector<Word> words(wc);
+  uint16_t x = 0;
+  for (auto& w : words) {
+    uint32_t delta;
+    if (!readVarint(p, recordEnd, delta)) {
+      return nullptr;
+    }
+    x += delta;
+    w.x = x;
+  }
 
-  // Block style
-  serialization::readPod(file, style);
+  uint32_t runCount = 0;
+  if (!readVarint(p, recordEnd, runCount)) {
+    return nullptr;
+  }
+  size_t wordIndex = 0;
+  for (uint32_t run = 0; run < runCount; run++) {
+    uint32_t runLength;
+    if (p == recordEnd) {
+      return nullptr;
+    }
+    const uint8_t runStyle = *p++;
+    if (runStyle >= EpdFontStyles::STYLE_COUNT || !readVarint(p, recordEnd, runLength) ||
+        runLength > words.size() - wordIndex) {
+      return nullptr;
+    }
+    for (uint32_t i = 0; i < runLength; i++) {
+      words[wordIndex++].style = runStyle;
+    }
+  }
+  if (wordIndex != words.size() || p == recordEnd) {
+    Serial.printf("[%lu] [TXB] Deserialization failed: malformed line record\n", millis());
+    return nullptr;
+  }
+  const auto style = static_cast<BLOCK_STYLE>(*p++);
+
+  // The rest of the record is the block's text as is, only the word offsets need to be found
+  std::string text(reinterpret_cast<const char*>(p), recordEnd - p);
+  size_t offset = 0;
+  for (auto& w : words) {
+    const size_t length = offset < text.size() ? strnlen(text.c_str() + offset, text.size() - offset) : 0;
+    if (offset + length >= text.size()) {
+      Serial.printf("[%lu] [TXB] Deserialization failed: malformed line text\n", millis());
+      return nullptr;
+    }
+    w.offset = offset;
+    w.length = length;
+    offset += length + 1;
+  }
 
-  return std::unique_ptr<TextBlock>(new TextBlock(std::move(words), std::move(wordXpos), std::move(wordStyles), style));
+  return std::unique_ptr<TextBlock>(new TextBlock(std::move(text), std::move(words), style));
+}
+
+bool TextBlock::skip(FsFile& file, const uint64_t end) {
+  uint16_t recordLength;
+  if (file.position() + sizeof(recordLength) > end) {
+    return false;
+  }
+  serialization::readPod(file, recordLength);
+  return file.position() + recordLength <= end && file.seekCur(recordLength);
 }
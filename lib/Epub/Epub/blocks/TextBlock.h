@@ -2,9 +2,9 @@
 #include <EpdFontFamily.h>
 #include <SdFat.h>
 
-#include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "Block.h"
 
@@ -18,24 +18,36 @@ class TextBlock final : public Block {
     RIGHT_ALIGN = 3,
   };
 
+  // A word is the NUL terminated run of UTF-8 bytes at offset in the block's text, drawn at x
+  struct Word {
+    uint16_t offset;
+    uint16_t length;
+    uint16_t x;
+    uint8_t style;
+  };
+
  private:
-  std::list<std::string> words;
-  std::list<uint16_t> wordXpos;
-  std::list<EpdFontFamily::Style> wordStyles;
+  std::string text;
+  std::vector<Word> words;
   BLOCK_STYLE style;
 
  public:
-  explicit TextBlock(std::list<std::string> words, std::list<uint16_t> word_xpos, std::list<EpdFontFamily::Style> word_styles,
-                     const BLOCK_STYLE style)
-      : words(std::move(words)), wordXpos(std::move(word_xpos)), wordStyles(std::move(word_styles)), style(style) {}
+  explicit TextBlock(std::string text, std::vector<Word> words, const BLOCK_STYLE style)
+      : text(std::move(text)), words(std::move(words)), style(style) {}
   ~TextBlock() override = default;
   void setStyle(const BLOCK_STYLE style) { this->style = style; }
   BLOCK_STYLE getStyle() const { return style; }
   bool isEmpty() override { return words.empty(); }
-  void layout(GfxRenderer& renderer) override {};
+  void layout(GfxRenderer& /*renderer*/) override {};
   // given a renderer works out where to break the words into lines
   void render(const GfxRenderer& renderer, int fontId, int x, int y) const;
+  // appends the codepoints of every word to the list for its style (indexed by EpdFontFamily::Style)
+  void collectCodepoints(std::vector<uint32_t>* codepointsByStyle) const;
+  size_t memoryUsage() const { return sizeof(*this) + text.capacity() + words.capacity() * sizeof(Word); }
   BlockType getType() override { return TEXT_BLOCK; }
   bool serialize(FsFile& file) const;
-  static std::unique_ptr<TextBlock> deserialize(FsFile& file);
+  // reads one line record from a page buffer, advancing data past it
+  static std::unique_ptr<TextBlock> deserialize(const uint8_t*& data, const uint8_t* end);
+  // moves the file past one line record, false if the record does not end by end
+  static bool skip(FsFile& file, uint64_t end);
 };
@@ -84,7 +84,7 @@ void convert_to_utf8(const int code, std::string& res) {
     res += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
     res += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
     res += static_cast<char>(0x80 | (code & 0x3f));
-  } else if (code < 0x80000000) {
+  } else if (static_cast<unsigned>(code) < 0x80000000) {
     res += static_cast<char>(0xfc | (code >> 30));
     res += static_cast<char>(0x80 | ((code >> 24) & 0x3f));
     res += static_cast<char>(0x80 | ((code >> 18) & 0x3f));
@@ -130,14 +130,15 @@ bool process_string_entity(const std::string& entity, std::string& res) {
 // replace all the entities in the string
 std::string replaceHtmlEntities(const char* text) {
   std::string res;
-  res.reserve(strlen(text));
-  for (int i = 0; i < strlen(text); ++i) {
+  const int length = static_cast<int>(strlen(text));
+  res.reserve(length);
+  for (int i = 0; i < length; ++i) {
     bool flag = false;
     // do we have a potential entity?
     if (text[i] == '&') {
       // find the end of the entity
       int j = i + 1;
-      while (j < strlen(text) && text[j] != ';' && j - i < MAX_ENTITY_LENGTH) {
+      while (j < length && text[j] != ';' && j - i < MAX_ENTITY_LENGTH) {
         j++;
       }
       if (j - i > 2) {
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <climits>
+#include <cstdint>
+#include <string>
+
+// Where ChapterHtmlSlimParser can pick up again without the chapter before it: the start tag of a block, everything
+// before it laid out. Holds the parser state at that point; see ChapterHtmlSlimParser::parseAndBuildPages.
+struct ChapterCheckpoint {
+  uint32_t offset = 0;     // Of the start tag in the inflated chapter
+  uint32_t prologEnd = 0;  // Where the root element starts, the prolog before it is parsed again on resume
+  int pagesCompleted = 0;  // Pages handed to completePageFn before it
+  int16_t pageNextY = -1;  // Where the next line goes on the page in progress, -1 if no page was started yet
+  int depth = 0;
+  int skipUntilDepth = INT_MAX;
+  int boldUntilDepth = INT_MAX;
+  int italicUntilDepth = INT_MAX;
+  bool inPTag = false;
+  uint32_t pCharCount = 0;
+  std::string openTags;  // Start tags of the open elements, without attributes, to replay to a new parser
+};
@@ -2,7 +2,7 @@
 
 #include <GfxRenderer.h>
 #include <HardwareSerial.h>
-#include <SDCardManager.h>
+#include <ZipFile.h>
 #include <expat.h>
 
 #include "../Page.h"
@@ -50,7 +50,7 @@ bool ChapterHtmlSlimParser::matches(const char* tag_name, const char* possible_t
 }
 
 // 统一资源释放函数，避免内存泄漏
-void ChapterHtmlSlimParser::cleanupResources(XML_Parser parser, FsFile& file) {
+void ChapterHtmlSlimParser::cleanupResources(XML_Parser parser, ZipFileReader& reader) {
   // 新增日志：追踪资源释放
   //Serial.printf("[%lu] [EHP] 进入cleanupResources，开始释放资源\n", millis());
   if (parser) {
@@ -60,10 +60,9 @@ void ChapterHtmlSlimParser::cleanupResources(XML_Parser parser, FsFile& file) {
     XML_ParserFree(parser);
     //Serial.printf("[%lu] [EHP] 解析器资源释放完成\n", millis());
   }
-  if (file) {
-    file.close();
-    //Serial.printf("[%lu] [EHP] 文件资源关闭完成\n", millis());
-  }
+  this->parser = nullptr;
+  reader.close();
+  //Serial.printf("[%lu] [EHP] 文件资源关闭完成\n", millis());
 }
 
 // start a new text block if needed
@@ -86,8 +85,97 @@ void ChapterHtmlSlimParser::startNewTextBlock(const TextBlock::BLOCK_STYLE style
   //Serial.printf("[%lu] [EHP] startNewTextBlock执行完成，新样式：%d\n", millis(), style);
 }
 
-void XMLCALL ChapterHtmlSlimParser::startElement(void* userData, const XML_Char* name, const XML_Char** atts) {
+void ChapterHtmlSlimParser::recordCheckpoint() {
+  if (!checkpointFn || replaying || partWordBufferIndex > 0) {
+    return;
+  }
+  // startNewTextBlock would lay it out next, doing it first leaves no pending text at the checkpoint
+  if (currentTextBlock && !currentTextBlock->isEmpty()) {
+    makePages();
+  }
+  currentTextBlock.reset();
+
+  checkpoint.offset = static_cast<uint32_t>(XML_GetCurrentByteIndex(parser) + inputShift);
+  checkpoint.prologEnd = prologEnd;
+  checkpoint.pagesCompleted = pagesCompleted;
+  checkpoint.pageNextY = currentPage ? currentPageNextY : -1;
+  checkpoint.depth = depth;
+  checkpoint.skipUntilDepth = skipUntilDepth;
+  checkpoint.boldUntilDepth = boldUntilDepth;
+  checkpoint.italicUntilDepth = italicUntilDepth;
+  checkpoint.inPTag = isInPTag;
+  checkpoint.pCharCount = currentPCharCount;
+  // The element starting is parsed again from the chapter
+  checkpoint.openTags.assign(openTags, 0, openTagStarts.back());
+  checkpointFn(checkpoint);
+}
+
+bool ChapterHtmlSlimParser::resume(const Checkpoint& from) {
+  if (from.prologEnd > from.offset || from.offset > reader.getInflatedSize()) {
+    return false;
+  }
+  // Replayed tags are parsed as they are fed, not held back for more input
+  XML_SetReparseDeferralEnabled(parser, XML_FALSE);
+
+  // The prolog as it was, what it declares holds for the rest of the chapter
+  for (uint32_t fed = 0; fed < from.prologEnd;) {
+    void* const buf = XML_GetBuffer(parser, 1024);
+    if (!buf) {
+      return false;
+    }
+    const size_t len = reader.read(static_cast<uint8_t*>(buf), std::min<uint32_t>(1024, from.prologEnd - fed));
+    if (len == 0 || XML_ParseBuffer(parser, static_cast<int>(len), XML_FALSE) == XML_STATUS_ERROR) {
+      return false;
+    }
+    fed += len;
+  }
+  if (reader.skip(from.offset - from.prologEnd) != from.offset - from.prologEnd) {
+    return false;
+  }
+
+  replaying = true;
+  const bool replayed = XML_Parse(parser, from.openTags.data(), static_cast<int>(from.openTags.size()), XML_FALSE) !=
+                            XML_STATUS_ERROR &&
+                        openTags == from.openTags;
+  replaying = false;
+  if (!replayed) {
+    return false;
+  }
+  XML_SetReparseDeferralEnabled(parser, XML_TRUE);
+
+  inputShift = static_cast<int64_t>(from.offset) - from.prologEnd - static_cast<int64_t>(from.openTags.size());
+  prologEnd = from.prologEnd;
+  pagesCompleted = from.pagesCompleted;
+  depth = from.depth;
+  skipUntilDepth = from.skipUntilDepth;
+  boldUntilDepth = from.boldUntilDepth;
+  italicUntilDepth = from.italicUntilDepth;
+  isInPTag = from.inPTag;
+  currentPCharCount = from.pCharCount;
+  isVirtualP = false;
+  currentTextBlock.reset();
+  if (from.pageNextY >= 0) {
+    currentPage.reset(new Page());
+    currentPageNextY = from.pageNextY;
+  } else {
+    currentPage.reset();
+    currentPageNextY = 0;
+  }
+  return true;
+}
+
+void XMLCALL ChapterHtmlSlimParser::startElement(void* userData, const XML_Char* name, const XML_Char** /*atts*/) {
     auto* self = static_cast<ChapterHtmlSlimParser*>(userData);
+
+    // Open elements, replayed to a new parser when layout resumes at a checkpoint
+    self->openTagStarts.push_back(self->openTags.size());
+    self->openTags.append("<").append(name ? name : "").append(">");
+    if (self->replaying) {
+        return;
+    }
+    if (self->openTagStarts.size() == 1) {
+        self->prologEnd = static_cast<uint32_t>(XML_GetCurrentByteIndex(self->parser) + self->inputShift);
+    }
     
     // 新增日志：追踪标签解析入口（关键：定位哪个标签开始解析时崩溃）
     //Serial.printf("[%lu] [EHP] 进入startElement，当前深度：%d\n", millis(), self->depth);
@@ -124,6 +212,7 @@ void XMLCALL ChapterHtmlSlimParser::startElement(void* userData, const XML_Char*
     // 标题标签：居中对齐+粗体，兼容h1-h6所有层级
     if (matches(name, HEADER_TAGS, NUM_HEADER_TAGS)) {
         //Serial.printf("[%lu] [EHP] 标签<%s>是标题标签，创建居中对齐文本块\n", millis(), name);
+        self->recordCheckpoint();
         self->startNewTextBlock(TextBlock::CENTER_ALIGN);
         self->boldUntilDepth = std::min(self->boldUntilDepth, self->depth);
         //Serial.printf("[%lu] [EHP] 标题标签<%s>粗体深度设置为：%d\n", millis(), name, self->boldUntilDepth);
@@ -133,6 +222,7 @@ void XMLCALL ChapterHtmlSlimParser::startElement(void* userData, const XML_Char*
         //Serial.printf("[%lu] [EHP] 标签<%s>是块级标签，创建两端对齐文本块\n", millis(), name);
         // 所有文本块标签统一用JUSTIFIED样式，避免格式错乱
         // 无论是p/block/left/note，都正常创建文本块，提取内容
+        self->recordCheckpoint();
         self->startNewTextBlock(TextBlock::JUSTIFIED);
         
         // ===== 新增：判断是否是<p>标签，设置isInPTag为true =====
@@ -404,6 +494,11 @@ void XMLCALL ChapterHtmlSlimParser::endElement(void* userData, const XML_Char* n
   
   auto* self = static_cast<ChapterHtmlSlimParser*>(userData);
 
+  if (!self->openTagStarts.empty()) {
+    self->openTags.resize(self->openTagStarts.back());
+    self->openTagStarts.pop_back();
+  }
+
   if (self->partWordBufferIndex > 0) {
     // Only flush out part word buffer if we're closing a block tag or are at the top of the HTML file.
     // We don't want to flush out content when closing inline tags like <span>.
@@ -474,15 +569,20 @@ void XMLCALL ChapterHtmlSlimParser::endElement(void* userData, const XML_Char* n
   //Serial.printf("[%lu] [EHP] endElement：标签<%s>处理完成\n", millis(), (name ? name : "未知"));
 }
 
-bool ChapterHtmlSlimParser::parseAndBuildPages() {
+bool ChapterHtmlSlimParser::parseAndBuildPages(const Checkpoint* resumeFrom) {
   // 新增日志：追踪解析入口
-  //Serial.printf("[%lu] [EHP] 进入parseAndBuildPages，开始解析文件：%s\n", millis(), filepath);
+  //Serial.printf("[%lu] [EHP] 进入parseAndBuildPages，开始解析文件\n", millis());
   
   // 初始化正文块，设置默认样式
   //Serial.printf("[%lu] [EHP] parseAndBuildPages：初始化默认文本块（两端对齐）\n", millis());
   startNewTextBlock(TextBlock::JUSTIFIED);
+  openTags.clear();
+  openTagStarts.clear();
+  inputShift = 0;
+  prologEnd = 0;
+  pagesCompleted = 0;
 
-  const XML_Parser parser = XML_ParserCreate(nullptr);
+  parser = XML_ParserCreate(nullptr);
   int done;
 
   if (!parser) {
@@ -490,15 +590,9 @@ bool ChapterHtmlSlimParser::parseAndBuildPages() {
     return false;
   }
 
-  FsFile file;
-  if (!SdMan.openFileForRead("EHP", filepath, file)) {
-    XML_ParserFree(parser);
-    return false;
-  }
-
-  // Get file size for progress calculation
-  const size_t totalSize = file.size();
-  size_t bytesRead = 0;
+  // Get inflated size for progress calculation
+  const size_t totalSize = reader.getInflatedSize();
+  size_t bytesRead = resumeFrom ? resumeFrom->offset : 0;
   int lastProgress = -1;
   
   //Serial.printf("[%lu] [EHP] parseAndBuildPages：文件打开成功，文件大小：%lu 字节\n", millis(), totalSize);
@@ -508,19 +602,34 @@ bool ChapterHtmlSlimParser::parseAndBuildPages() {
   XML_SetCharacterDataHandler(parser, characterData);
   //Serial.printf("[%lu] [EHP] parseAndBuildPages：Expat解析器配置完成，开始循环读取文件\n", millis());
 
+  if (resumeFrom && !resume(*resumeFrom)) {
+    Serial.printf("[%lu] [EHP] Could not resume at offset %u\n", millis(), resumeFrom->offset);
+    cleanupResources(parser, reader);
+    return false;
+  }
+
   do {
+    // A background build hands over to input and rendering here, and stops if it is told to
+    if (yieldFn && !yieldFn()) {
+      Serial.printf("[%lu] [EHP] Parse stopped\n", millis());
+      cleanupResources(parser, reader);
+      return false;
+    }
+
     void* const buf = XML_GetBuffer(parser, 1024);
     if (!buf) {
       //Serial.printf("[%lu] [EHP] Couldn't allocate memory for buffer\n", millis());
-      cleanupResources(parser, file); // 统一释放资源
+      cleanupResources(parser, reader); // 统一释放资源
       return false;
     }
 
-    const size_t len = file.read(buf, 1024);
+    // Inflate straight into expat's buffer. After a resume the chunks end where they do in a parse from the start:
+    // characterData ends a word at the end of each chunk, so the pages would differ otherwise.
+    const size_t len = reader.read(static_cast<uint8_t*>(buf), 1024 - bytesRead % 1024);
 
-    if (len == 0 && file.available() > 0) {
+    if (reader.hasFailed()) {
       //Serial.printf("[%lu] [EHP] File read error\n", millis());
-      cleanupResources(parser, file); // 统一释放资源
+      cleanupResources(parser, reader); // 统一释放资源
       return false;
     }
 
@@ -535,12 +644,12 @@ bool ChapterHtmlSlimParser::parseAndBuildPages() {
       }
     }
 
-    done = file.available() == 0;
+    done = reader.isDone();
 
     if (XML_ParseBuffer(parser, static_cast<int>(len), done) == XML_STATUS_ERROR) {
       //Serial.printf("[%lu] [EHP] Parse error at line %lu:\n%s\n", millis(), XML_GetCurrentLineNumber(parser),
       //              XML_ErrorString(XML_GetErrorCode(parser)));
-      cleanupResources(parser, file); // 统一释放资源
+      cleanupResources(parser, reader); // 统一释放资源
       return false;
     }
   } while (!done);
@@ -569,13 +678,14 @@ bool ChapterHtmlSlimParser::parseAndBuildPages() {
 
   // 释放解析器和文件资源
   //Serial.printf("[%lu] [EHP] parseAndBuildPages：开始释放解析器和文件资源\n", millis());
-  cleanupResources(parser, file);
+  cleanupResources(parser, reader);
 
   // Process last page if there is still text
   //Serial.printf("[%lu] [EHP] parseAndBuildPages：开始处理最后一页文本\n", millis());
   if (currentTextBlock) {
     makePages();
     completePageFn(std::move(currentPage));
+    pagesCompleted++;
     currentPage.reset();
     currentTextBlock.reset();
     //Serial.printf("[%lu] [EHP] parseAndBuildPages：最后一页文本处理完成\n", millis());
@@ -604,6 +714,7 @@ void ChapterHtmlSlimParser::addLineToPage(std::shared_ptr<TextBlock> line) {
   if (currentPageNextY + lineHeight > viewportHeight) {
     //Serial.printf("[%lu] [EHP] addLineToPage：页面空间不足，创建新页面\n", millis());
     completePageFn(std::move(currentPage));
+    pagesCompleted++;
     currentPage.reset(new Page());
     currentPageNextY = 0;
   }
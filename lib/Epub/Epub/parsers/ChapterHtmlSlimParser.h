@@ -6,8 +6,10 @@
 #include <functional>
 #include <memory>
 #include <cstring>  // 新增：用于memset等内存操作
+#include <vector>
 
 #include "../ParsedText.h"
+#include "ChapterCheckpoint.h"
 #include "../blocks/TextBlock.h"
 #include <string>  // 新增：用于字符串处理
 #include <EpdFontFamily.h>
@@ -16,7 +18,7 @@
 
 class Page;
 class GfxRenderer;
-class FsFile;  // 新增：声明FsFile类（用于资源释放函数）
+class ZipFileReader;
 
 #define MAX_WORD_SIZE 200
 
@@ -24,11 +26,25 @@ class FsFile;  // 新增：声明FsFile类（用于资源释放函数）
 constexpr int MAX_UTF8_CHAR_LEN = 4;  // UTF-8字符最大字节长度（中文3字节）
 
 class ChapterHtmlSlimParser {
+ public:
+  using Checkpoint = ChapterCheckpoint;
+
+ private:
   // 原有成员变量（保留不变，补充部分默认初始化）
-  const std::string& filepath;
+  ZipFileReader& reader;  // Inflates the chapter straight from the epub, no temp file on SD
   GfxRenderer& renderer;
   std::function<void(std::unique_ptr<Page>)> completePageFn;
   std::function<void(int)> progressFn;  // Progress callback (0-100)
+  std::function<bool()> yieldFn;        // Called between chunks, returning false stops the parse
+  std::function<void(const Checkpoint&)> checkpointFn;
+  XML_Parser parser = nullptr;
+  Checkpoint checkpoint;
+  std::string openTags;
+  std::vector<size_t> openTagStarts;
+  bool replaying = false;   // Open tags of a checkpoint are fed to the parser, callbacks only track them
+  int64_t inputShift = 0;   // Offset in the chapter minus offset in what the parser was fed
+  uint32_t prologEnd = 0;
+  int pagesCompleted = 0;
   int depth = 0;
   int skipUntilDepth = INT_MAX;
   int boldUntilDepth = INT_MAX;
@@ -61,6 +77,9 @@ class ChapterHtmlSlimParser {
   // 原有成员函数声明（保留不变）
   void startNewTextBlock(TextBlock::BLOCK_STYLE style);
   void makePages();
+  // Lays out the block before the one starting and reports the checkpoint there
+  void recordCheckpoint();
+  bool resume(const Checkpoint& from);
   // XML callbacks
   static void XMLCALL startElement(void* userData, const XML_Char* name, const XML_Char** atts);
   static void XMLCALL characterData(void* userData, const XML_Char* s, int len);
@@ -110,25 +129,32 @@ class ChapterHtmlSlimParser {
   /**
    * @brief 统一释放expat解析器和文件资源，避免内存泄漏
    */
-  void cleanupResources(XML_Parser parser, FsFile& file);
+  void cleanupResources(XML_Parser parser, ZipFileReader& reader);
 
  public:
   // 原有构造函数（保留不变）
-  explicit ChapterHtmlSlimParser(const std::string& filepath, GfxRenderer& renderer, const int fontId,
+  explicit ChapterHtmlSlimParser(ZipFileReader& reader, GfxRenderer& renderer, const int fontId,
                                  const float lineCompression, const bool extraParagraphSpacing, const int viewportWidth,
                                  const int viewportHeight,
                                  const std::function<void(std::unique_ptr<Page>)>& completePageFn,
-                                 const std::function<void(int)>& progressFn = nullptr)
-      : filepath(filepath),
+                                 const std::function<void(int)>& progressFn = nullptr,
+                                 const std::function<bool()>& yieldFn = nullptr,
+                                 const std::function<void(const Checkpoint&)>& checkpointFn = nullptr)
+      : reader(reader),
         renderer(renderer),
+        completePageFn(completePageFn),
+        progressFn(progressFn),
+        yieldFn(yieldFn),
+        checkpointFn(checkpointFn),
         fontId(fontId),
         lineCompression(lineCompression),
         extraParagraphSpacing(extraParagraphSpacing),
         viewportWidth(viewportWidth),
-        viewportHeight(viewportHeight),
-        completePageFn(completePageFn),
-        progressFn(progressFn) {}
+        viewportHeight(viewportHeight) {}
   ~ChapterHtmlSlimParser() = default;
-  bool parseAndBuildPages();
+  // With resumeFrom, lays out only what follows that checkpoint of an earlier parse of the same chapter with the same
+  // settings: the prolog is parsed again and the rest of the chapter before the checkpoint is inflated but skipped.
+  // Pages are counted on from the checkpoint's; the page then in progress lacks the lines before it.
+  bool parseAndBuildPages(const Checkpoint* resumeFrom = nullptr);
   void addLineToPage(std::shared_ptr<TextBlock> line);
 };
\ No newline at end of file
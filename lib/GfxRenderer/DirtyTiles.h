@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+
+// Per-tile signatures of the frame last pushed to the panel, compared against a frame buffer to find the window that
+// actually changed. Tiles are TILE_WIDTH_BYTES * 8 x TILE_HEIGHT pixels, so windows stay byte-aligned. Works on a plain
+// 1 bit per pixel buffer of FRAME_WIDTH_BYTES x FRAME_HEIGHT and knows nothing about the display driver.
+template <int FRAME_WIDTH_BYTES, int FRAME_HEIGHT, int TILE_WIDTH_BYTES = 10, int TILE_HEIGHT = 24>
+class DirtyTiles {
+ public:
+  static constexpr int COLS = FRAME_WIDTH_BYTES / TILE_WIDTH_BYTES;
+  static constexpr int ROWS = FRAME_HEIGHT / TILE_HEIGHT;
+  static_assert(COLS * TILE_WIDTH_BYTES == FRAME_WIDTH_BYTES && ROWS * TILE_HEIGHT == FRAME_HEIGHT,
+                "Dirty tiles do not line up with the frame size");
+
+  // Changed area in frame pixels, empty when nothing changed
+  struct Window {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    bool empty() const { return width == 0; }
+    int coveragePercent() const { return width * height * 100 / (FRAME_WIDTH_BYTES * 8 * FRAME_HEIGHT); }
+  };
+
+  // Whether the signatures describe what the panel shows. Until then diff has nothing to compare against
+  bool valid() const { return signaturesValid; }
+  // Forgets the panel contents, e.g. after only part of the frame or a grayscale frame went out
+  void invalidate() { signaturesValid = false; }
+
+  // Records the frame as what the panel shows
+  void update(const uint8_t* frame) {
+    for (int row = 0; row < ROWS; row++) {
+      for (int col = 0; col < COLS; col++) {
+        signatures[row * COLS + col] = signature(frame, col, row);
+      }
+    }
+    signaturesValid = true;
+  }
+
+  // Returns the window bounding the tiles of the frame that differ from the recorded ones and records the frame, the
+  // caller is expected to push that window (or more) to the panel. Only meaningful while valid()
+  Window diff(const uint8_t* frame) {
+    int minCol = COLS, maxCol = -1;
+    int minRow = ROWS, maxRow = -1;
+    for (int row = 0; row < ROWS; row++) {
+      for (int col = 0; col < COLS; col++) {
+        const uint32_t current = signature(frame, col, row);
+        uint32_t& previous = signatures[row * COLS + col];
+        if (current != previous) {
+          previous = current;
+          minCol = col < minCol ? col : minCol;
+          maxCol = col > maxCol ? col : maxCol;
+          minRow = row < minRow ? row : minRow;
+          maxRow = row > maxRow ? row : maxRow;
+        }
+      }
+    }
+
+    Window window;
+    if (maxCol >= 0) {
+      window.x = minCol * TILE_WIDTH_BYTES * 8;
+      window.y = minRow * TILE_HEIGHT;
+      window.width = (maxCol - minCol + 1) * TILE_WIDTH_BYTES * 8;
+      window.height = (maxRow - minRow + 1) * TILE_HEIGHT;
+    }
+    return window;
+  }
+
+ private:
+  uint32_t signatures[COLS * ROWS] = {0};
+  bool signaturesValid = false;
+
+  static uint32_t signature(const uint8_t* frame, const int col, const int row) {
+    // FNV-1a over the tile bytes
+    uint32_t hash = 2166136261u;
+    const uint8_t* line = frame + row * TILE_HEIGHT * FRAME_WIDTH_BYTES + col * TILE_WIDTH_BYTES;
+    for (int y = 0; y < TILE_HEIGHT; y++, line += FRAME_WIDTH_BYTES) {
+      for (int x = 0; x < TILE_WIDTH_BYTES; x++) {
+        hash = (hash ^ line[x]) * 16777619u;
+      }
+    }
+    return hash;
+  }
+};
@@ -2,45 +2,152 @@
 #include <SDCardManager.h>
 #include <Utf8.h>
 
-void GfxRenderer::insertFont(const int fontId, EpdFontFamily font) { fontMap[fontId] = font; }
+#include <algorithm>
+
+void GfxRenderer::insertFont(const int fontId, EpdFontFamily font) {
+  fontMap[fontId] = font;
+  metricsCaches.clear();
+}
 
 void GfxRenderer::clearCustomFonts(const int startId) {
   for (auto it = fontMap.lower_bound(startId); it != fontMap.end();) {
     it = fontMap.erase(it);
   }
+  // Fonts may be freed and their addresses reused, drop all cached metrics
+  metricsCaches.clear();
 }
 
-void GfxRenderer::rotateCoordinates(const int x, const int y, int* rotatedX, int* rotatedY) const {
+namespace {
+using Orientation = GfxRenderer::Orientation;
+
+template <Orientation O>
+using OrientationTag = std::integral_constant<Orientation, O>;
+
+// Invokes fn with the orientation as a compile-time constant (OrientationTag), so the coordinate transform inside a
+// drawing loop is resolved once per draw call instead of once per pixel.
+template <typename Fn>
+void withOrientation(const Orientation orientation, Fn&& fn) {
   switch (orientation) {
-    case Portrait: {
-      // Logical portrait (480x800) → panel (800x480)
-      // Rotation: 90 degrees clockwise
-      *rotatedX = y;
-      *rotatedY = EInkDisplay::DISPLAY_HEIGHT - 1 - x;
+    case GfxRenderer::Portrait:
+      fn(OrientationTag<GfxRenderer::Portrait>{});
       break;
-    }
-    case LandscapeClockwise: {
-      // Logical landscape (800x480) rotated 180 degrees (swap top/bottom and left/right)
-      *rotatedX = EInkDisplay::DISPLAY_WIDTH - 1 - x;
-      *rotatedY = EInkDisplay::DISPLAY_HEIGHT - 1 - y;
+    case GfxRenderer::LandscapeClockwise:
+      fn(OrientationTag<GfxRenderer::LandscapeClockwise>{});
       break;
-    }
-    case PortraitInverted: {
-      // Logical portrait (480x800) → panel (800x480)
-      // Rotation: 90 degrees counter-clockwise
-      *rotatedX = EInkDisplay::DISPLAY_WIDTH - 1 - y;
-      *rotatedY = x;
+    case GfxRenderer::PortraitInverted:
+      fn(OrientationTag<GfxRenderer::PortraitInverted>{});
       break;
-    }
-    case LandscapeCounterClockwise: {
-      // Logical landscape (800x480) aligned with panel orientation
-      *rotatedX = x;
-      *rotatedY = y;
+    case GfxRenderer::LandscapeCounterClockwise:
+      fn(OrientationTag<GfxRenderer::LandscapeCounterClockwise>{});
       break;
+  }
+}
+
+template <Orientation O>
+constexpr int logicalWidth() {
+  return O == GfxRenderer::Portrait || O == GfxRenderer::PortraitInverted ? EInkDisplay::DISPLAY_HEIGHT
+                                                                          : EInkDisplay::DISPLAY_WIDTH;
+}
+
+template <Orientation O>
+constexpr int logicalHeight() {
+  return O == GfxRenderer::Portrait || O == GfxRenderer::PortraitInverted ? EInkDisplay::DISPLAY_WIDTH
+                                                                          : EInkDisplay::DISPLAY_HEIGHT;
+}
+
+template <Orientation O>
+inline void toPanel(const int x, const int y, int* panelX, int* panelY) {
+  if constexpr (O == GfxRenderer::Portrait) {
+    // Logical portrait (480x800) → panel (800x480)
+    // Rotation: 90 degrees clockwise
+    *panelX = y;
+    *panelY = EInkDisplay::DISPLAY_HEIGHT - 1 - x;
+  } else if constexpr (O == GfxRenderer::LandscapeClockwise) {
+    // Logical landscape (800x480) rotated 180 degrees (swap top/bottom and left/right)
+    *panelX = EInkDisplay::DISPLAY_WIDTH - 1 - x;
+    *panelY = EInkDisplay::DISPLAY_HEIGHT - 1 - y;
+  } else if constexpr (O == GfxRenderer::PortraitInverted) {
+    // Logical portrait (480x800) → panel (800x480)
+    // Rotation: 90 degrees counter-clockwise
+    *panelX = EInkDisplay::DISPLAY_WIDTH - 1 - y;
+    *panelY = x;
+  } else {
+    // Logical landscape (800x480) aligned with panel orientation
+    *panelX = x;
+    *panelY = y;
+  }
+}
+
+template <Orientation O>
+inline void setPixel(uint8_t* frameBuffer, const int x, const int y, const bool state) {
+  int panelX = 0;
+  int panelY = 0;
+  toPanel<O>(x, y, &panelX, &panelY);
+
+  // Bounds checking against physical panel dimensions
+  if (panelX < 0 || panelX >= EInkDisplay::DISPLAY_WIDTH || panelY < 0 || panelY >= EInkDisplay::DISPLAY_HEIGHT) {
+    return;
+  }
+
+  // MSB first
+  uint8_t* byte = frameBuffer + panelY * EInkDisplay::DISPLAY_WIDTH_BYTES + (panelX >> 3);
+  const uint8_t mask = 0x80 >> (panelX & 7);
+  if (state) {
+    *byte &= ~mask;  // Clear bit
+  } else {
+    *byte |= mask;  // Set bit
+  }
+}
+
+// Fills the inclusive panel rectangle with whole-byte memsets, masking only the partial bytes at either end of a row
+inline void fillPanelRect(uint8_t* frameBuffer, const int panelX0, const int panelY0, const int panelX1,
+                          const int panelY1, const bool state) {
+  const int firstByte = panelX0 >> 3;
+  const int lastByte = panelX1 >> 3;
+  uint8_t leftMask = 0xFF >> (panelX0 & 7);
+  const uint8_t rightMask = 0xFF << (7 - (panelX1 & 7));
+  if (firstByte == lastByte) {
+    leftMask &= rightMask;
+  }
+  // state == true draws black, which clears bits
+  const uint8_t fill = state ? 0x00 : 0xFF;
+
+  uint8_t* row = frameBuffer + panelY0 * EInkDisplay::DISPLAY_WIDTH_BYTES;
+  for (int panelY = panelY0; panelY <= panelY1; panelY++, row += EInkDisplay::DISPLAY_WIDTH_BYTES) {
+    row[firstByte] = state ? (row[firstByte] & ~leftMask) : (row[firstByte] | leftMask);
+    if (lastByte > firstByte) {
+      if (lastByte > firstByte + 1) {
+        memset(row + firstByte + 1, fill, lastByte - firstByte - 1);
+      }
+      row[lastByte] = state ? (row[lastByte] & ~rightMask) : (row[lastByte] | rightMask);
     }
   }
 }
 
+// Fills the inclusive logical rectangle, clipped to the logical screen. Every orientation maps a logical rectangle to
+// a panel rectangle, so this always resolves to row fills in panel space.
+template <Orientation O>
+void fillRectClipped(uint8_t* frameBuffer, int x0, int y0, int x1, int y1, const bool state) {
+  x0 = std::max(x0, 0);
+  y0 = std::max(y0, 0);
+  x1 = std::min(x1, logicalWidth<O>() - 1);
+  y1 = std::min(y1, logicalHeight<O>() - 1);
+  if (x0 > x1 || y0 > y1) {
+    return;
+  }
+
+  int panelX0 = 0, panelY0 = 0, panelX1 = 0, panelY1 = 0;
+  toPanel<O>(x0, y0, &panelX0, &panelY0);
+  toPanel<O>(x1, y1, &panelX1, &panelY1);
+  fillPanelRect(frameBuffer, std::min(panelX0, panelX1), std::min(panelY0, panelY1), std::max(panelX0, panelX1),
+                std::max(panelY0, panelY1), state);
+}
+}  // namespace
+
+void GfxRenderer::rotateCoordinates(const int x, const int y, int* rotatedX, int* rotatedY) const {
+  withOrientation(orientation, [&](auto tag) { toPanel<decltype(tag)::value>(x, y, rotatedX, rotatedY); });
+}
+
 void GfxRenderer::drawPixel(const int x, const int y, const bool state) const {
   uint8_t* frameBuffer = einkDisplay.getFrameBuffer();
 
@@ -50,37 +157,68 @@ void GfxRenderer::drawPixel(const int x, const int y, const bool state) const {
     return;
   }
 
-  int rotatedX = 0;
-  int rotatedY = 0;
-  rotateCoordinates(x, y, &rotatedX, &rotatedY);
+  withOrientation(orientation, [&](auto tag) { setPixel<decltype(tag)::value>(frameBuffer, x, y, state); });
+}
 
-  // Bounds checking against physical panel dimensions
-  if (rotatedX < 0 || rotatedX >= EInkDisplay::DISPLAY_WIDTH || rotatedY < 0 ||
-      rotatedY >= EInkDisplay::DISPLAY_HEIGHT) {
-    //Serial.printf("[%lu] [GFX] !! Outside range (%d, %d) -> (%d, %d)\n", millis(), x, y, rotatedX, rotatedY);
-    return;
+GlyphMetricsCache::Metrics GfxRenderer::lookupGlyphMetrics(const EpdFont* font, GlyphMetricsCache& cache,
+                                                           const uint32_t cp, const EpdFontFamily::Style style) {
+  GlyphMetricsCache::Metrics metrics;
+  if (cache.lookup(cp, &metrics)) {
+    return metrics;
   }
 
-  // Calculate byte position and bit position
-  const uint16_t byteIndex = rotatedY * EInkDisplay::DISPLAY_WIDTH_BYTES + (rotatedX / 8);
-  const uint8_t bitPosition = 7 - (rotatedX % 8);  // MSB first
+  const EpdGlyph* glyph = font->getGlyph(cp, style);
+  if (!glyph) {
+    glyph = font->getGlyph('?', style);
+  }
 
-  if (state) {
-    frameBuffer[byteIndex] &= ~(1 << bitPosition);  // Clear bit
+  if (glyph) {
+    metrics = {glyph->advanceX, glyph->width, glyph->left, true};
   } else {
-    frameBuffer[byteIndex] |= 1 << bitPosition;  // Set bit
+    metrics = {0, 0, 0, false};
   }
+  cache.insert(cp, metrics);
+  return metrics;
 }
 
 int GfxRenderer::getTextWidth(const int fontId, const char* text, const EpdFontFamily::Style style) const {
-  if (fontMap.count(fontId) == 0) {
+  const auto fontIt = fontMap.find(fontId);
+  if (fontIt == fontMap.end()) {
     Serial.printf("[%lu] [GFX] Font %d not found\n", millis(), fontId);
     return 0;
   }
 
-  int w = 0, h = 0;
-  fontMap.at(fontId).getTextDimensions(text, &w, &h, style);
-  return w;
+  const EpdFont* font = fontIt->second.getFont(style);
+  if (!font || text == nullptr) {
+    return 0;
+  }
+
+  // Same bounds as EpdFont::getTextDimensions, but from cached metrics so glyphs are not looked up again
+  GlyphMetricsCache& cache = metricsCaches[{font, style}];
+  int minX = 0, maxX = 0, cursorX = 0;
+  uint32_t cp;
+  while ((cp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&text)))) {
+    const GlyphMetricsCache::Metrics metrics = lookupGlyphMetrics(font, cache, cp, style);
+    if (!metrics.present) {
+      continue;
+    }
+
+    minX = std::min(minX, cursorX + metrics.left);
+    maxX = std::max(maxX, cursorX + metrics.left + metrics.width);
+    cursorX += metrics.advanceX;
+  }
+
+  return maxX - minX;
+}
+
+void GfxRenderer::prefetchGlyphs(const int fontId, const uint32_t* codepoints, const size_t count,
+                                 const EpdFontFamily::Style style) const {
+  const auto fontIt = fontMap.find(fontId);
+  if (fontIt == fontMap.end()) {
+    Serial.printf("[%lu] [GFX] Font %d not found\n", millis(), fontId);
+    return;
+  }
+  fontIt->second.prefetchGlyphs(codepoints, count, style);
 }
 
 void GfxRenderer::drawCenteredText(const int fontId, const int y, const char* text, const bool black,
@@ -91,52 +229,75 @@ void GfxRenderer::drawCenteredText(const int fontId, const int y, const char* te
 
 void GfxRenderer::drawText(const int fontId, const int x, const int y, const char* text, const bool black,
                            const EpdFontFamily::Style style) const {
-  const int yPos = y + getFontAscenderSize(fontId);
-  int xpos = x;
-
   // cannot draw a NULL / empty string
   if (text == nullptr || *text == '\0') {
     return;
   }
 
-  if (fontMap.count(fontId) == 0) {
+  const auto fontIt = fontMap.find(fontId);
+  if (fontIt == fontMap.end()) {
     Serial.printf("[%lu] [GFX] Font %d not found\n", millis(), fontId);
     return;
   }
-  const auto font = fontMap.at(fontId);
-
-  // no printable characters
-  if (!font.hasPrintableChars(text, style)) {
-    //Serial.printf("[%lu] [GFX] text '%s' has no printable chars\n", millis(), text);
-    return;
-  }
+  const EpdFontFamily& font = fontIt->second;
+  const EpdFontData* regularData = font.getData(EpdFontFamily::REGULAR);
+  const int yPos = y + (regularData ? regularData->ascender : 0);
+  int xpos = x;
 
+  // Glyphs without ink (spaces) are skipped by renderChar, so the string is decoded once
   uint32_t cp;
-  const char* p = text;
   while ((cp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&text)))) {
     renderChar(font, cp, &xpos, &yPos, black, style);
   }
 }
 
-void GfxRenderer::drawLine(int x1, int y1, int x2, int y2, const bool state) const {
-  if (x1 == x2) {
-    if (y2 < y1) {
-      std::swap(y1, y2);
-    }
-    for (int y = y1; y <= y2; y++) {
-      drawPixel(x1, y, state);
-    }
-  } else if (y1 == y2) {
-    if (x2 < x1) {
-      std::swap(x1, x2);
+void GfxRenderer::drawTextRun(const int fontId, const int x, const int y, const TextRunWord* words, const size_t count,
+                              const bool black) const {
+  const auto fontIt = fontMap.find(fontId);
+  if (fontIt == fontMap.end()) {
+    Serial.printf("[%lu] [GFX] Font %d not found\n", millis(), fontId);
+    return;
+  }
+  const EpdFontFamily& font = fontIt->second;
+  const EpdFontData* regularData = font.getData(EpdFontFamily::REGULAR);
+  const int yPos = y + (regularData ? regularData->ascender : 0);
+
+  for (size_t i = 0; i < count; i++) {
+    const char* text = words[i].text;
+    if (text == nullptr) {
+      continue;
     }
-    for (int x = x1; x <= x2; x++) {
-      drawPixel(x, y1, state);
+    int xpos = x + words[i].x;
+    uint32_t cp;
+    while ((cp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&text)))) {
+      renderChar(font, cp, &xpos, &yPos, black, words[i].style);
     }
-  } else {
+  }
+}
+
+void GfxRenderer::drawLine(int x1, int y1, int x2, int y2, const bool state) const {
+  if (x1 != x2 && y1 != y2) {
     // TODO: Implement
     Serial.printf("[%lu] [GFX] Line drawing not supported\n", millis());
+    return;
+  }
+
+  uint8_t* frameBuffer = einkDisplay.getFrameBuffer();
+  if (!frameBuffer) {
+    Serial.printf("[%lu] [GFX] !! No framebuffer\n", millis());
+    return;
+  }
+
+  if (x2 < x1) {
+    std::swap(x1, x2);
   }
+  if (y2 < y1) {
+    std::swap(y1, y2);
+  }
+
+  withOrientation(orientation, [&](auto tag) {
+    fillRectClipped<decltype(tag)::value>(frameBuffer, x1, y1, x2, y2, state);
+  });
 }
 
 void GfxRenderer::drawRect(const int x, const int y, const int width, const int height, const bool state) const {
@@ -147,9 +308,19 @@ void GfxRenderer::drawRect(const int x, const int y, const int width, const int
 }
 
 void GfxRenderer::fillRect(const int x, const int y, const int width, const int height, const bool state) const {
-  for (int fillY = y; fillY < y + height; fillY++) {
-    drawLine(x, fillY, x + width - 1, fillY, state);
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  uint8_t* frameBuffer = einkDisplay.getFrameBuffer();
+  if (!frameBuffer) {
+    Serial.printf("[%lu] [GFX] !! No framebuffer\n", millis());
+    return;
   }
+
+  withOrientation(orientation, [&](auto tag) {
+    fillRectClipped<decltype(tag)::value>(frameBuffer, x, y, x + width - 1, y + height - 1, state);
+  });
 }
 
 void GfxRenderer::drawImage(const uint8_t bitmap[], const int x, const int y, const int width, const int height) const {
@@ -195,57 +366,67 @@ void GfxRenderer::drawBitmap(const Bitmap& bitmap, const int x, const int y, con
     return;
   }
 
-  for (int bmpY = 0; bmpY < (bitmap.getHeight() - cropPixY); bmpY++) {
-    // The BMP's (0, 0) is the bottom-left corner (if the height is positive, top-left if negative).
-    // Screen's (0, 0) is the top-left corner.
-    int screenY = -cropPixY + (bitmap.isTopDown() ? bmpY : bitmap.getHeight() - 1 - bmpY);
-    if (isScaled) {
-      screenY = std::floor(screenY * scale);
-    }
-    screenY += y;  // the offset should not be scaled
-    if (screenY >= getScreenHeight()) {
-      break;
-    }
-    if (screenY < 0) {
-      continue;
-    }
-
-    if (bitmap.readNextRow(outputRow, rowBytes) != BmpReaderError::Ok) {
-      Serial.printf("[%lu] [GFX] Failed to read row %d from bitmap\n", millis(), bmpY);
-      free(outputRow);
-      free(rowBytes);
-      return;
-    }
+  uint8_t* frameBuffer = einkDisplay.getFrameBuffer();
+  if (!frameBuffer) {
+    Serial.printf("[%lu] [GFX] !! No framebuffer\n", millis());
+    free(outputRow);
+    free(rowBytes);
+    return;
+  }
 
-    if (bmpY < cropPixY) {
-      // Skip the row if it's outside the crop area
-      continue;
-    }
+  withOrientation(orientation, [&](auto tag) {
+    constexpr Orientation O = decltype(tag)::value;
 
-    for (int bmpX = cropPixX; bmpX < bitmap.getWidth() - cropPixX; bmpX++) {
-      int screenX = bmpX - cropPixX;
+    for (int bmpY = 0; bmpY < (bitmap.getHeight() - cropPixY); bmpY++) {
+      // The BMP's (0, 0) is the bottom-left corner (if the height is positive, top-left if negative).
+      // Screen's (0, 0) is the top-left corner.
+      int screenY = -cropPixY + (bitmap.isTopDown() ? bmpY : bitmap.getHeight() - 1 - bmpY);
       if (isScaled) {
-        screenX = std::floor(screenX * scale);
+        screenY = std::floor(screenY * scale);
       }
-      screenX += x;  // the offset should not be scaled
-      if (screenX >= getScreenWidth()) {
+      screenY += y;  // the offset should not be scaled
+      if (screenY >= logicalHeight<O>()) {
         break;
       }
-      if (screenX < 0) {
+      if (screenY < 0) {
+        continue;
+      }
+
+      if (bitmap.readNextRow(outputRow, rowBytes) != BmpReaderError::Ok) {
+        Serial.printf("[%lu] [GFX] Failed to read row %d from bitmap\n", millis(), bmpY);
+        return;
+      }
+
+      if (bmpY < cropPixY) {
+        // Skip the row if it's outside the crop area
         continue;
       }
 
-      const uint8_t val = outputRow[bmpX / 4] >> (6 - ((bmpX * 2) % 8)) & 0x3;
+      for (int bmpX = cropPixX; bmpX < bitmap.getWidth() - cropPixX; bmpX++) {
+        int screenX = bmpX - cropPixX;
+        if (isScaled) {
+          screenX = std::floor(screenX * scale);
+        }
+        screenX += x;  // the offset should not be scaled
+        if (screenX >= logicalWidth<O>()) {
+          break;
+        }
+        if (screenX < 0) {
+          continue;
+        }
+
+        const uint8_t val = outputRow[bmpX / 4] >> (6 - ((bmpX * 2) % 8)) & 0x3;
 
-      if (renderMode == BW && val < 3) {
-        drawPixel(screenX, screenY);
-      } else if (renderMode == GRAYSCALE_MSB && (val == 1 || val == 2)) {
-        drawPixel(screenX, screenY, false);
-      } else if (renderMode == GRAYSCALE_LSB && val == 1) {
-        drawPixel(screenX, screenY, false);
+        if (renderMode == BW && val < 3) {
+          setPixel<O>(frameBuffer, screenX, screenY, true);
+        } else if (renderMode == GRAYSCALE_MSB && (val == 1 || val == 2)) {
+          setPixel<O>(frameBuffer, screenX, screenY, false);
+        } else if (renderMode == GRAYSCALE_LSB && val == 1) {
+          setPixel<O>(frameBuffer, screenX, screenY, false);
+        }
       }
     }
-  }
+  });
 
   free(outputRow);
   free(rowBytes);
@@ -276,45 +457,55 @@ void GfxRenderer::drawBitmap1Bit(const Bitmap& bitmap, const int x, const int y,
     return;
   }
 
-  for (int bmpY = 0; bmpY < bitmap.getHeight(); bmpY++) {
-    // Read rows sequentially using readNextRow
-    if (bitmap.readNextRow(outputRow, rowBytes) != BmpReaderError::Ok) {
-      Serial.printf("[%lu] [GFX] Failed to read row %d from 1-bit bitmap\n", millis(), bmpY);
-      free(outputRow);
-      free(rowBytes);
-      return;
-    }
+  uint8_t* frameBuffer = einkDisplay.getFrameBuffer();
+  if (!frameBuffer) {
+    Serial.printf("[%lu] [GFX] !! No framebuffer\n", millis());
+    free(outputRow);
+    free(rowBytes);
+    return;
+  }
 
-    // Calculate screen Y based on whether BMP is top-down or bottom-up
-    const int bmpYOffset = bitmap.isTopDown() ? bmpY : bitmap.getHeight() - 1 - bmpY;
-    int screenY = y + (isScaled ? static_cast<int>(std::floor(bmpYOffset * scale)) : bmpYOffset);
-    if (screenY >= getScreenHeight()) {
-      continue;  // Continue reading to keep row counter in sync
-    }
-    if (screenY < 0) {
-      continue;
-    }
+  withOrientation(orientation, [&](auto tag) {
+    constexpr Orientation O = decltype(tag)::value;
 
-    for (int bmpX = 0; bmpX < bitmap.getWidth(); bmpX++) {
-      int screenX = x + (isScaled ? static_cast<int>(std::floor(bmpX * scale)) : bmpX);
-      if (screenX >= getScreenWidth()) {
-        break;
+    for (int bmpY = 0; bmpY < bitmap.getHeight(); bmpY++) {
+      // Read rows sequentially using readNextRow
+      if (bitmap.readNextRow(outputRow, rowBytes) != BmpReaderError::Ok) {
+        Serial.printf("[%lu] [GFX] Failed to read row %d from 1-bit bitmap\n", millis(), bmpY);
+        return;
       }
-      if (screenX < 0) {
+
+      // Calculate screen Y based on whether BMP is top-down or bottom-up
+      const int bmpYOffset = bitmap.isTopDown() ? bmpY : bitmap.getHeight() - 1 - bmpY;
+      int screenY = y + (isScaled ? static_cast<int>(std::floor(bmpYOffset * scale)) : bmpYOffset);
+      if (screenY >= logicalHeight<O>()) {
+        continue;  // Continue reading to keep row counter in sync
+      }
+      if (screenY < 0) {
         continue;
       }
 
-      // Get 2-bit value (result of readNextRow quantization)
-      const uint8_t val = outputRow[bmpX / 4] >> (6 - ((bmpX * 2) % 8)) & 0x3;
+      for (int bmpX = 0; bmpX < bitmap.getWidth(); bmpX++) {
+        int screenX = x + (isScaled ? static_cast<int>(std::floor(bmpX * scale)) : bmpX);
+        if (screenX >= logicalWidth<O>()) {
+          break;
+        }
+        if (screenX < 0) {
+          continue;
+        }
+
+        // Get 2-bit value (result of readNextRow quantization)
+        const uint8_t val = outputRow[bmpX / 4] >> (6 - ((bmpX * 2) % 8)) & 0x3;
 
-      // For 1-bit source: 0 or 1 -> map to black (0,1,2) or white (3)
-      // val < 3 means black pixel (draw it)
-      if (val < 3) {
-        drawPixel(screenX, screenY, true);
+        // For 1-bit source: 0 or 1 -> map to black (0,1,2) or white (3)
+        // val < 3 means black pixel (draw it)
+        if (val < 3) {
+          setPixel<O>(frameBuffer, screenX, screenY, true);
+        }
+        // White pixels (val == 3) are not drawn (leave background)
       }
-      // White pixels (val == 3) are not drawn (leave background)
     }
-  }
+  });
 
   free(outputRow);
   free(rowBytes);
@@ -379,8 +570,8 @@ void GfxRenderer::fillPolygon(const int* xPoints, const int* yPoints, int numPoi
       if (endX >= getScreenWidth()) endX = getScreenWidth() - 1;
 
       // Draw horizontal line
-      for (int x = startX; x <= endX; x++) {
-        drawPixel(x, scanY, state);
+      if (startX <= endX) {
+        drawLine(startX, scanY, endX, scanY, state);
       }
     }
   }
@@ -396,13 +587,73 @@ void GfxRenderer::invertScreen() const {
     Serial.printf("[%lu] [GFX] !! No framebuffer in invertScreen\n", millis());
     return;
   }
-  for (int i = 0; i < EInkDisplay::BUFFER_SIZE; i++) {
+  for (uint32_t i = 0; i < EInkDisplay::BUFFER_SIZE; i++) {
     buffer[i] = ~buffer[i];
   }
 }
 
 void GfxRenderer::displayBuffer(const EInkDisplay::RefreshMode refreshMode) const {
   einkDisplay.displayBuffer(refreshMode);
+  updateTileSignatures();
+}
+
+void GfxRenderer::displayWindow(const int x, const int y, const int width, const int height) const {
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  int panelX0 = 0, panelY0 = 0, panelX1 = 0, panelY1 = 0;
+  rotateCoordinates(x, y, &panelX0, &panelY0);
+  rotateCoordinates(x + width - 1, y + height - 1, &panelX1, &panelY1);
+
+  // The controller can only address whole bytes horizontally
+  const int left = std::max(0, std::min(panelX0, panelX1)) & ~7;
+  const int right = std::min(static_cast<int>(EInkDisplay::DISPLAY_WIDTH), (std::max(panelX0, panelX1) + 8) & ~7);
+  const int top = std::max(0, std::min(panelY0, panelY1));
+  const int bottom = std::min(static_cast<int>(EInkDisplay::DISPLAY_HEIGHT), std::max(panelY0, panelY1) + 1);
+  if (left >= right || top >= bottom) {
+    return;
+  }
+
+  einkDisplay.displayWindow(left, top, right - left, bottom - top);
+  // Only part of the frame buffer went out, so the panel no longer matches it as a whole
+  dirtyTiles.invalidate();
+}
+
+void GfxRenderer::updateTileSignatures() const {
+  const uint8_t* frameBuffer = einkDisplay.getFrameBuffer();
+  if (!frameBuffer) {
+    dirtyTiles.invalidate();
+    return;
+  }
+  dirtyTiles.update(frameBuffer);
+}
+
+void GfxRenderer::displayDirty() const {
+  const uint8_t* frameBuffer = einkDisplay.getFrameBuffer();
+  if (!frameBuffer) {
+    Serial.printf("[%lu] [GFX] !! No framebuffer in displayDirty\n", millis());
+    return;
+  }
+
+  if (!dirtyTiles.valid()) {
+    displayBuffer();
+    return;
+  }
+
+  const auto window = dirtyTiles.diff(frameBuffer);
+  if (window.empty()) {
+    // Nothing changed since the last refresh
+    return;
+  }
+
+  if (window.coveragePercent() > DIRTY_FULL_REFRESH_PERCENT) {
+    // Signatures are already up to date with the frame buffer
+    einkDisplay.displayBuffer(EInkDisplay::FAST_REFRESH);
+    return;
+  }
+
+  einkDisplay.displayWindow(window.x, window.y, window.width, window.height);
 }
 
 std::string GfxRenderer::truncatedText(const int fontId, const char* text, const int maxWidth,
@@ -591,12 +842,7 @@ void GfxRenderer::drawTextRotated90CW(const int fontId, const int x, const int y
     Serial.printf("[%lu] [GFX] Font %d not found\n", millis(), fontId);
     return;
   }
-  const auto font = fontMap.at(fontId);
-
-  // No printable characters
-  if (!font.hasPrintableChars(text, style)) {
-    return;
-  }
+  const EpdFontFamily& font = fontMap.at(fontId);
 
   // For 90° clockwise rotation:
   // Original (glyphX, glyphY) -> Rotated (glyphY, -glyphX)
@@ -615,7 +861,6 @@ void GfxRenderer::drawTextRotated90CW(const int fontId, const int x, const int y
     }
 
     const int is2Bit = font.getData(style)->is2Bit;
-    const uint32_t offset = glyph->dataOffset;
     const uint8_t width = glyph->width;
     const uint8_t height = glyph->height;
     const int left = glyph->left;
@@ -639,7 +884,7 @@ void GfxRenderer::drawTextRotated90CW(const int fontId, const int x, const int y
           if (is2Bit) {
             const uint8_t byte = bitmap[pixelPosition / 4];
             const uint8_t bit_index = (3 - pixelPosition % 4) * 2;
-            const uint8_t bmpVal = 3 - (byte >> bit_index) & 0x3;
+            const uint8_t bmpVal = (3 - (byte >> bit_index)) & 0x3;
 
             if (renderMode == BW && bmpVal < 3) {
               drawPixel(screenX, screenY, black);
@@ -669,13 +914,25 @@ uint8_t* GfxRenderer::getFrameBuffer() const { return einkDisplay.getFrameBuffer
 
 size_t GfxRenderer::getBufferSize() { return EInkDisplay::BUFFER_SIZE; }
 
-void GfxRenderer::grayscaleRevert() const { einkDisplay.grayscaleRevert(); }
+void GfxRenderer::grayscaleRevert() const {
+  einkDisplay.grayscaleRevert();
+  dirtyTiles.invalidate();
+}
 
-void GfxRenderer::copyGrayscaleLsbBuffers() const { einkDisplay.copyGrayscaleLsbBuffers(einkDisplay.getFrameBuffer()); }
+void GfxRenderer::copyGrayscaleLsbBuffers() const {
+  einkDisplay.copyGrayscaleLsbBuffers(einkDisplay.getFrameBuffer());
+  dirtyTiles.invalidate();
+}
 
-void GfxRenderer::copyGrayscaleMsbBuffers() const { einkDisplay.copyGrayscaleMsbBuffers(einkDisplay.getFrameBuffer()); }
+void GfxRenderer::copyGrayscaleMsbBuffers() const {
+  einkDisplay.copyGrayscaleMsbBuffers(einkDisplay.getFrameBuffer());
+  dirtyTiles.invalidate();
+}
 
-void GfxRenderer::displayGrayBuffer() const { einkDisplay.displayGrayBuffer(); }
+void GfxRenderer::displayGrayBuffer() const {
+  einkDisplay.displayGrayBuffer();
+  dirtyTiles.invalidate();
+}
 
 void GfxRenderer::freeBwBufferChunks() {
   for (auto& bwBufferChunk : bwBufferChunks) {
@@ -784,8 +1041,10 @@ void GfxRenderer::cleanupGrayscaleWithFrameBuffer() const {
 
 void GfxRenderer::renderChar(const EpdFontFamily& fontFamily, const uint32_t cp, int* x, const int* y,
                              const bool pixelState, const EpdFontFamily::Style style) const {
+  uint32_t drawnCp = cp;
   const EpdGlyph* glyph = fontFamily.getGlyph(cp, style);
   if (!glyph) {
+    drawnCp = '?';
     glyph = fontFamily.getGlyph('?', style);
   }
 
@@ -796,55 +1055,224 @@ void GfxRenderer::renderChar(const EpdFontFamily& fontFamily, const uint32_t cp,
 
   const EpdFont* font = fontFamily.getFont(style);
   if (!font) return;
+
+  // Nothing to draw or capture for glyphs without ink
+  if (glyph->width == 0 || glyph->height == 0) {
+    *x += glyph->advanceX;
+    return;
+  }
+
+  if (capturing) {
+    captureGlyph(font, drawnCp, *x, *y, pixelState, style);
+  }
+
+  blitGlyph(font, glyph, *x, *y, pixelState, style);
+  *x += glyph->advanceX;
+}
+
+void GfxRenderer::blitGlyph(const EpdFont* font, const EpdGlyph* glyph, const int x, const int y,
+                            const bool pixelState, const EpdFontFamily::Style style) const {
   const EpdFontData* data = font->getData(style);
   if (!data) return;
 
-  const int is2Bit = data->is2Bit;
-  const uint8_t width = glyph->width;
-  const uint8_t height = glyph->height;
-  const int left = glyph->left;
+  const int glyphWidth = glyph->width;
+  const int glyphHeight = glyph->height;
+  const int originX = x + glyph->left;
+  const int originY = y - glyph->top;
+
+  if (glyphWidth == 0 || glyphHeight == 0) {
+    return;
+  }
+
+  // Clip the glyph box against the logical screen once, instead of per pixel
+  const int startX = std::max(0, -originX);
+  const int endX = std::min(glyphWidth, getScreenWidth() - originX);
+  const int startY = std::max(0, -originY);
+  const int endY = std::min(glyphHeight, getScreenHeight() - originY);
+  if (startX >= endX || startY >= endY) {
+    return;
+  }
+
+  uint8_t* frameBuffer = einkDisplay.getFrameBuffer();
+  if (!frameBuffer) {
+    Serial.printf("[%lu] [GFX] !! No framebuffer\n", millis());
+    return;
+  }
 
   const uint8_t* bitmap = font->loadGlyphBitmap(glyph, nullptr, style);
+  if (bitmap == nullptr) {
+    return;
+  }
 
-  if (bitmap != nullptr) {
-    for (int glyphY = 0; glyphY < height; glyphY++) {
-      const int screenY = *y - glyph->top + glyphY;
-      for (int glyphX = 0; glyphX < width; glyphX++) {
-        const int pixelPosition = glyphY * width + glyphX;
-        const int screenX = *x + left + glyphX;
+  const bool is2Bit = data->is2Bit;
+
+  // Which raw glyph values produce ink in the current render mode, as a bitmask over the raw value.
+  // 2-bit raw values are 0 -> white, 1 -> light gray, 2 -> dark gray, 3 -> black.
+  //  - BW: anything that is not white (paints over the grays)
+  //  - GRAYSCALE_MSB: light and dark gray
+  //  - GRAYSCALE_LSB: dark gray only
+  // Gray buffers are flagged in reverse (0 leave alone, 1 update), so gray passes always set bits.
+  uint8_t inkMask = 0b0010;
+  bool state = pixelState;
+  if (is2Bit) {
+    switch (renderMode) {
+      case BW:
+        inkMask = 0b1110;
+        break;
+      case GRAYSCALE_MSB:
+        inkMask = 0b0110;
+        state = false;
+        break;
+      case GRAYSCALE_LSB:
+        inkMask = 0b0100;
+        state = false;
+        break;
+    }
+  }
 
+  // Every orientation maps either glyph rows or glyph columns onto panel rows. Walk the glyph along the axis that
+  // runs along a panel row so ink can be gathered into whole framebuffer bytes:
+  //  - outer: glyph axis selecting the panel row, panelY = panelRowBase + panelRowDir * outer
+  //  - inner: glyph axis running along the panel row, panelX = innerBase + innerDir * inner
+  withOrientation(orientation, [&](auto tag) {
+    constexpr Orientation O = decltype(tag)::value;
+    constexpr bool innerIsX = O == LandscapeClockwise || O == LandscapeCounterClockwise;
+    constexpr int innerDir = O == Portrait || O == LandscapeCounterClockwise ? 1 : -1;
+    constexpr int panelRowDir = O == PortraitInverted || O == LandscapeCounterClockwise ? 1 : -1;
+
+    // Panel position of the glyph origin, panel rows and columns then step by the directions above
+    int originPanelX = 0;
+    int originPanelY = 0;
+    toPanel<O>(originX, originY, &originPanelX, &originPanelY);
+
+    const int outerStart = innerIsX ? startY : startX;
+    const int outerEnd = innerIsX ? endY : endX;
+    const int innerStart = innerIsX ? startX : startY;
+    const int innerEnd = innerIsX ? endX : endY;
+    // Bit index step in the glyph bitmap for one step along each axis
+    const int outerStride = innerIsX ? glyphWidth : 1;
+    const int innerStride = innerIsX ? 1 : glyphWidth;
+
+    for (int outer = outerStart; outer < outerEnd; outer++) {
+      uint8_t* row = frameBuffer + (originPanelY + panelRowDir * outer) * EInkDisplay::DISPLAY_WIDTH_BYTES;
+      int pixelPosition = outer * outerStride + innerStart * innerStride;
+      int panelX = originPanelX + innerDir * innerStart;
+      int currentByte = panelX >> 3;
+      uint8_t mask = 0;
+
+      for (int inner = innerStart; inner < innerEnd; inner++, pixelPosition += innerStride, panelX += innerDir) {
+        uint8_t raw;
         if (is2Bit) {
-          const uint8_t byte = bitmap[pixelPosition / 4];
-          const uint8_t bit_index = (3 - pixelPosition % 4) * 2;
-          // the direct bit from the font is 0 -> white, 1 -> light gray, 2 -> dark gray, 3 -> black
-          // we swap this to better match the way images and screen think about colors:
-          // 0 -> black, 1 -> dark grey, 2 -> light grey, 3 -> white
-          const uint8_t bmpVal = 3 - (byte >> bit_index) & 0x3;
-
-          if (renderMode == BW && bmpVal < 3) {
-            // Black (also paints over the grays in BW mode)
-            drawPixel(screenX, screenY, pixelState);
-          } else if (renderMode == GRAYSCALE_MSB && (bmpVal == 1 || bmpVal == 2)) {
-            // Light gray (also mark the MSB if it's going to be a dark gray too)
-            // We have to flag pixels in reverse for the gray buffers, as 0 leave alone, 1 update
-            drawPixel(screenX, screenY, false);
-          } else if (renderMode == GRAYSCALE_LSB && bmpVal == 1) {
-            // Dark gray
-            drawPixel(screenX, screenY, false);
-          }
+          raw = (bitmap[pixelPosition >> 2] >> ((3 - (pixelPosition & 3)) * 2)) & 0x3;
         } else {
-          const uint8_t byte = bitmap[pixelPosition / 8];
-          const uint8_t bit_index = 7 - (pixelPosition % 8);
+          raw = (bitmap[pixelPosition >> 3] >> (7 - (pixelPosition & 7))) & 0x1;
+        }
 
-          if ((byte >> bit_index) & 1) {
-            drawPixel(screenX, screenY, pixelState);
+        const int byteIndex = panelX >> 3;
+        if (byteIndex != currentByte) {
+          if (mask) {
+            row[currentByte] = state ? (row[currentByte] & ~mask) : (row[currentByte] | mask);
+            mask = 0;
           }
+          currentByte = byteIndex;
+        }
+
+        if ((inkMask >> raw) & 1) {
+          mask |= 0x80 >> (panelX & 7);
         }
       }
+
+      if (mask) {
+        row[currentByte] = state ? (row[currentByte] & ~mask) : (row[currentByte] | mask);
+      }
     }
+  });
+}
+
+void GfxRenderer::captureGlyph(const EpdFont* font, const uint32_t cp, const int x, const int y, const bool pixelState,
+                               const EpdFontFamily::Style style) const {
+  if (captureOverflow) {
+    return;
   }
 
-  *x += glyph->advanceX;
+  size_t slot = 0;
+  while (slot < MAX_CAPTURE_FONTS && captureFonts[slot] && captureFonts[slot] != font) {
+    slot++;
+  }
+  if (slot == MAX_CAPTURE_FONTS || capturedGlyphs.size() >= MAX_CAPTURED_GLYPHS || cp > 0x1FFFFF) {
+    captureOverflow = true;
+    return;
+  }
+  captureFonts[slot] = font;
+
+  const EpdFontData* data = font->getData(style);
+  if (data && data->is2Bit) {
+    captureHasGrayscale = true;
+  }
+
+  capturedGlyphs.push_back({cp | static_cast<uint32_t>(style) << 21 | static_cast<uint32_t>(pixelState) << 23 |
+                                static_cast<uint32_t>(slot) << 24,
+                            static_cast<int16_t>(x), static_cast<int16_t>(y)});
+}
+
+/**
+ * Start recording every glyph drawn through drawText. Used by readers to rasterize the grayscale planes of a page
+ * from the glyphs placed during the BW pass instead of rendering the whole page again for each plane.
+ */
+void GfxRenderer::beginGlyphCapture() {
+  clearGlyphCapture();
+  capturedGlyphs.reserve(256);
+  capturing = true;
+}
+
+void GfxRenderer::clearGlyphCapture() {
+  capturing = false;
+  captureOverflow = false;
+  captureHasGrayscale = false;
+  for (auto& captureFont : captureFonts) {
+    captureFont = nullptr;
+  }
+  std::vector<CapturedGlyph>().swap(capturedGlyphs);
+}
+
+/**
+ * Blit the captured glyphs again using the current render mode.
+ * Font pointers are only valid for as long as the fonts used during capture stay loaded.
+ */
+void GfxRenderer::drawCapturedGlyphs() const {
+  for (const auto& captured : capturedGlyphs) {
+    const EpdFont* font = captureFonts[captured.packed >> 24 & 0x7];
+    const uint32_t cp = captured.packed & 0x1FFFFF;
+    const auto style = static_cast<EpdFontFamily::Style>(captured.packed >> 21 & 0x3);
+    const bool pixelState = captured.packed >> 23 & 0x1;
+
+    const EpdGlyph* glyph = font->getGlyph(cp, style);
+    if (glyph) {
+      blitGlyph(font, glyph, captured.x, captured.y, pixelState, style);
+    }
+  }
+}
+
+/**
+ * Replaces the storeBwBuffer / per-plane page render / restoreBwBuffer sequence when a glyph capture is available.
+ * The frame buffer is used as scratch for both planes, so callers must redraw the BW frame afterwards and then call
+ * `cleanupGrayscaleWithFrameBuffer`.
+ */
+void GfxRenderer::displayCapturedGrayscale() {
+  const RenderMode previousMode = renderMode;
+
+  clearScreen(0x00);
+  renderMode = GRAYSCALE_LSB;
+  drawCapturedGlyphs();
+  copyGrayscaleLsbBuffers();
+
+  clearScreen(0x00);
+  renderMode = GRAYSCALE_MSB;
+  drawCapturedGlyphs();
+  copyGrayscaleMsbBuffers();
+
+  renderMode = previousMode;
+  displayGrayBuffer();
 }
 
 void GfxRenderer::getOrientedViewableTRBL(int* outTop, int* outRight, int* outBottom, int* outLeft) const {
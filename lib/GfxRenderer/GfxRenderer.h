@@ -6,8 +6,11 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "Bitmap.h"
+#include "DirtyTiles.h"
+#include "GlyphMetricsCache.h"
 
 class GfxRenderer {
  public:
@@ -32,8 +35,38 @@ class GfxRenderer {
   Orientation orientation;
   uint8_t* bwBufferChunks[BW_BUFFER_NUM_CHUNKS] = {nullptr};
   std::map<int, EpdFontFamily> fontMap;
+
+  // Measurement cache per (font, style), dropped whenever the font map changes
+  mutable std::map<std::pair<const EpdFont*, int>, GlyphMetricsCache> metricsCaches;
+  static GlyphMetricsCache::Metrics lookupGlyphMetrics(const EpdFont* font, GlyphMetricsCache& cache, uint32_t cp,
+                                                      EpdFontFamily::Style style);
+
+  // Glyph capture: resolved glyph placements recorded while drawing text, so the same glyphs can be blitted again
+  // for the grayscale planes without decoding and measuring the text a second time.
+  struct CapturedGlyph {
+    uint32_t packed;  // codepoint (21 bits) | style (2 bits) | black (1 bit) | font slot (3 bits)
+    int16_t x;        // pen position
+    int16_t y;        // baseline
+  };
+  static constexpr size_t MAX_CAPTURE_FONTS = 8;
+  static constexpr size_t MAX_CAPTURED_GLYPHS = 2048;
+  mutable std::vector<CapturedGlyph> capturedGlyphs;
+  mutable const EpdFont* captureFonts[MAX_CAPTURE_FONTS] = {nullptr};
+  mutable bool capturing = false;
+  mutable bool captureOverflow = false;
+  mutable bool captureHasGrayscale = false;
+
+  // Above this share of the screen displayDirty does a full fast refresh, which is cheaper than a window update
+  static constexpr int DIRTY_FULL_REFRESH_PERCENT = 40;
+  // Signatures of the frame last pushed to the panel, so displayDirty only refreshes what changed
+  mutable DirtyTiles<EInkDisplay::DISPLAY_WIDTH_BYTES, EInkDisplay::DISPLAY_HEIGHT> dirtyTiles;
+  void updateTileSignatures() const;
+
   void renderChar(const EpdFontFamily& fontFamily, uint32_t cp, int* x, const int* y, bool pixelState,
                   EpdFontFamily::Style style) const;
+  void blitGlyph(const EpdFont* font, const EpdGlyph* glyph, int x, int y, bool pixelState,
+                 EpdFontFamily::Style style) const;
+  void captureGlyph(const EpdFont* font, uint32_t cp, int x, int y, bool pixelState, EpdFontFamily::Style style) const;
   void freeBwBufferChunks();
 
 
@@ -60,6 +93,9 @@ class GfxRenderer {
   void displayBuffer(EInkDisplay::RefreshMode refreshMode = EInkDisplay::FAST_REFRESH) const;
   // EXPERIMENTAL: Windowed update - display only a rectangular region
   void displayWindow(int x, int y, int width, int height) const;
+  // Push only the part of the frame buffer that changed since the last display call. Falls back to a full fast
+  // refresh when most of the screen changed or the panel contents are unknown (e.g. after a grayscale refresh).
+  void displayDirty() const;
   void invertScreen() const;
   void clearScreen(uint8_t color = 0xFF) const;
 
@@ -77,10 +113,21 @@ class GfxRenderer {
 
   // Text
   int getTextWidth(int fontId, const char* text, EpdFontFamily::Style style = EpdFontStyles::REGULAR) const;
+  // Batch-load the glyphs of text that is about to be drawn, see EpdFont::prefetchGlyphs
+  void prefetchGlyphs(int fontId, const uint32_t* codepoints, size_t count,
+                      EpdFontFamily::Style style = EpdFontStyles::REGULAR) const;
   void drawCenteredText(int fontId, int y, const char* text, bool black = true,
                         EpdFontFamily::Style style = EpdFontStyles::REGULAR) const;
   void drawText(int fontId, int x, int y, const char* text, bool black = true,
                 EpdFontFamily::Style style = EpdFontStyles::REGULAR) const;
+  // One word of a line drawn with drawTextRun, x relative to the run
+  struct TextRunWord {
+    const char* text;
+    int x;
+    EpdFontFamily::Style style;
+  };
+  // Draws the words of one line, resolving the font and baseline once for all of them
+  void drawTextRun(int fontId, int x, int y, const TextRunWord* words, size_t count, bool black = true) const;
   int getSpaceWidth(int fontId) const;
   int getFontAscenderSize(int fontId) const;
   int getLineHeight(int fontId) const;
@@ -107,6 +154,17 @@ class GfxRenderer {
   void restoreBwBuffer();  // Restore and free the stored buffer
   void cleanupGrayscaleWithFrameBuffer() const;
 
+  // Glyph capture for single-layout grayscale rendering
+  void beginGlyphCapture();
+  void endGlyphCapture() { capturing = false; }
+  void clearGlyphCapture();
+  // True if the capture completed and contains anti-aliased (2-bit) glyphs worth a grayscale pass
+  bool hasCapturedGrayscale() const { return !captureOverflow && captureHasGrayscale; }
+  bool glyphCaptureOverflowed() const { return captureOverflow; }
+  void drawCapturedGlyphs() const;
+  // Builds the LSB and MSB planes from the captured glyphs and shows them. Leaves the frame buffer dirty.
+  void displayCapturedGrayscale();
+
   // Low level functions
   uint8_t* getFrameBuffer() const;
   static size_t getBufferSize();
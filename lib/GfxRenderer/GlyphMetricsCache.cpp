@@ -0,0 +1,106 @@
+#include "GlyphMetricsCache.h"
+
+#include <cstdlib>
+#include <cstring>
+
+GlyphMetricsCache::~GlyphMetricsCache() { clear(); }
+
+void GlyphMetricsCache::clear() {
+  for (auto& page : densePages) {
+    free(page);
+    page = nullptr;
+  }
+  std::vector<Metrics>().swap(palette);
+  free(sparse);
+  sparse = nullptr;
+  sparseCount = 0;
+}
+
+bool GlyphMetricsCache::lookup(const uint32_t cp, Metrics* out) const {
+  if (cp >= DENSE_FIRST && cp <= DENSE_LAST) {
+    const uint32_t index = cp - DENSE_FIRST;
+    const uint8_t* page = densePages[index >> DENSE_PAGE_BITS];
+    if (!page) {
+      return false;
+    }
+    const uint8_t slot = page[index & (DENSE_PAGE_SIZE - 1)];
+    if (slot == 0) {
+      return false;
+    }
+    *out = palette[slot - 1];
+    return true;
+  }
+
+  if (!sparse || cp == 0) {
+    return false;
+  }
+  // Linear probing
+  for (size_t i = sparseSlot(cp);; i = (i + 1) & (SPARSE_CAPACITY - 1)) {
+    if (sparse[i].cp == cp) {
+      *out = sparse[i].metrics;
+      return true;
+    }
+    if (sparse[i].cp == 0) {
+      return false;
+    }
+  }
+}
+
+int GlyphMetricsCache::paletteIndex(const Metrics& metrics) {
+  for (size_t i = 0; i < palette.size(); i++) {
+    const Metrics& entry = palette[i];
+    if (entry.advanceX == metrics.advanceX && entry.left == metrics.left && entry.width == metrics.width &&
+        entry.present == metrics.present) {
+      return static_cast<int>(i) + 1;
+    }
+  }
+  if (palette.size() >= MAX_PALETTE_SIZE) {
+    return 0;
+  }
+  palette.push_back(metrics);
+  return static_cast<int>(palette.size());
+}
+
+bool GlyphMetricsCache::insert(const uint32_t cp, const Metrics& metrics) {
+  if (cp >= DENSE_FIRST && cp <= DENSE_LAST) {
+    const uint32_t index = cp - DENSE_FIRST;
+    uint8_t*& page = densePages[index >> DENSE_PAGE_BITS];
+    if (!page) {
+      page = static_cast<uint8_t*>(calloc(DENSE_PAGE_SIZE, 1));
+      if (!page) {
+        return false;
+      }
+    }
+    const int slot = paletteIndex(metrics);
+    if (slot == 0) {
+      return false;
+    }
+    page[index & (DENSE_PAGE_SIZE - 1)] = static_cast<uint8_t>(slot);
+    return true;
+  }
+
+  if (cp == 0) {
+    return false;
+  }
+  if (!sparse) {
+    sparse = static_cast<SparseEntry*>(calloc(SPARSE_CAPACITY, sizeof(SparseEntry)));
+    if (!sparse) {
+      return false;
+    }
+  }
+  if (sparseCount >= SPARSE_MAX_LOAD) {
+    // Start over rather than degrade probing, the working set of a book outside the CJK block is small
+    memset(sparse, 0, SPARSE_CAPACITY * sizeof(SparseEntry));
+    sparseCount = 0;
+  }
+  for (size_t i = sparseSlot(cp);; i = (i + 1) & (SPARSE_CAPACITY - 1)) {
+    if (sparse[i].cp == cp || sparse[i].cp == 0) {
+      if (sparse[i].cp == 0) {
+        sparseCount++;
+      }
+      sparse[i].cp = cp;
+      sparse[i].metrics = metrics;
+      return true;
+    }
+  }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Codepoint → glyph metrics cache used for text measurement, so layout does not have to look up glyphs (binary
+ * search, or SD reads for custom fonts) for every word it measures.
+ *
+ * CJK Unified Ideographs (0x4E00-0x9FFF) are indexed directly: lazily allocated pages of one byte per codepoint
+ * holding an index into a small palette of distinct metrics, which stays tiny because CJK glyphs of a font share only
+ * a handful of advance/left/width combinations. Everything else goes through a small open-addressing hash table.
+ */
+class GlyphMetricsCache {
+ public:
+  struct Metrics {
+    uint8_t advanceX;
+    uint8_t width;
+    int16_t left;
+    bool present;  // false if the font has neither the glyph nor the '?' fallback
+  };
+
+  GlyphMetricsCache() = default;
+  ~GlyphMetricsCache();
+  GlyphMetricsCache(const GlyphMetricsCache&) = delete;
+  GlyphMetricsCache& operator=(const GlyphMetricsCache&) = delete;
+
+  bool lookup(uint32_t cp, Metrics* out) const;
+  // Returns false if the metrics could not be stored (palette or memory exhausted)
+  bool insert(uint32_t cp, const Metrics& metrics);
+  void clear();
+
+ private:
+  static constexpr uint32_t DENSE_FIRST = 0x4E00;
+  static constexpr uint32_t DENSE_LAST = 0x9FFF;
+  static constexpr int DENSE_PAGE_BITS = 8;
+  static constexpr uint32_t DENSE_PAGE_SIZE = 1u << DENSE_PAGE_BITS;
+  static constexpr uint32_t DENSE_PAGE_COUNT = (DENSE_LAST - DENSE_FIRST + 1) / DENSE_PAGE_SIZE;
+  static_assert(DENSE_PAGE_COUNT * DENSE_PAGE_SIZE == DENSE_LAST - DENSE_FIRST + 1,
+                "Dense range must be a whole number of pages");
+  static constexpr size_t MAX_PALETTE_SIZE = 255;  // palette index 0 means "not cached"
+
+  static constexpr int SPARSE_BITS = 9;
+  static constexpr size_t SPARSE_CAPACITY = 1u << SPARSE_BITS;
+  static constexpr size_t SPARSE_MAX_LOAD = SPARSE_CAPACITY * 3 / 4;
+  struct SparseEntry {
+    uint32_t cp;  // 0 marks an empty slot, codepoint 0 is never measured
+    Metrics metrics;
+  };
+
+  uint8_t* densePages[DENSE_PAGE_COUNT] = {nullptr};
+  std::vector<Metrics> palette;
+  SparseEntry* sparse = nullptr;
+  size_t sparseCount = 0;
+
+  int paletteIndex(const Metrics& metrics);
+  // Fibonacci hashing, the top bits of the product are the well mixed ones
+  static size_t sparseSlot(const uint32_t cp) { return (cp * 2654435761u) >> (32 - SPARSE_BITS); }
+};
@@ -0,0 +1,53 @@
+#include "Jobs.h"
+
+#include <climits>
+
+Job::State SequenceJob::resume(const Deadline& deadline) {
+  do {
+    if (next >= steps.size()) {
+      return State::Done;
+    }
+    if (!steps[next++]()) {
+      return State::Failed;
+    }
+  } while (!deadline.expired());
+  return next >= steps.size() ? State::Done : State::Running;
+}
+
+bool JobScheduler::add(std::unique_ptr<Job> job) {
+  if (!job) {
+    return false;
+  }
+  jobs.push_back(std::move(job));
+  return true;
+}
+
+bool JobScheduler::runFor(const unsigned long sliceMs) {
+  const Deadline deadline(clock, sliceMs);
+  // Every job gets at least one resume per slice, so a job that overruns its deadline can't starve the others
+  size_t unvisited = jobs.size();
+  while (!jobs.empty() && (unvisited > 0 || !deadline.expired())) {
+    if (next >= jobs.size()) {
+      next = 0;
+    }
+    if (unvisited > 0) {
+      unvisited--;
+    }
+    if (jobs[next]->resume(deadline) == Job::State::Running) {
+      next++;
+    } else {
+      jobs.erase(jobs.begin() + next);
+    }
+  }
+  return !jobs.empty();
+}
+
+void JobScheduler::runAll() {
+  while (runFor(ULONG_MAX)) {
+  }
+}
+
+void JobScheduler::clear() {
+  jobs.clear();
+  next = 0;
+}
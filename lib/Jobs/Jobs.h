@@ -0,0 +1,72 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Cooperative jobs for long work that would otherwise freeze an activity: a job does a bounded amount of work each
+// time it is resumed and returns before its deadline, so the task running the scheduler can handle input and render
+// in between. Nothing here depends on Arduino or FreeRTOS, the clock is passed in (millis() on the device).
+
+using JobClock = unsigned long (*)();
+
+// End of the current time slice. Jobs check it between units of work; a unit already started always finishes
+class Deadline {
+  JobClock clock;
+  unsigned long start;
+  unsigned long sliceMs;
+
+ public:
+  Deadline(const JobClock clock, const unsigned long sliceMs) : clock(clock), start(clock()), sliceMs(sliceMs) {}
+  bool expired() const { return clock() - start >= sliceMs; }
+};
+
+class Job {
+ public:
+  enum class State { Running, Done, Failed };
+
+  virtual ~Job() = default;
+  // Works until the deadline expires or the job ends, always doing at least one unit of work so a job resumed on an
+  // already expired deadline still progresses. Called again later while it returns Running
+  virtual State resume(const Deadline& deadline) = 0;
+};
+
+// Job from a function, for work that keeps its state in captures or in its owner
+class FunctionJob final : public Job {
+  std::function<State(const Deadline&)> fn;
+
+ public:
+  explicit FunctionJob(std::function<State(const Deadline&)> fn) : fn(std::move(fn)) {}
+  State resume(const Deadline& deadline) override { return fn(deadline); }
+};
+
+// Job made of steps that each run to completion, for work that can only be split at a few points. A step returning
+// false fails the job and skips the remaining steps
+class SequenceJob final : public Job {
+  std::vector<std::function<bool()>> steps;
+  size_t next = 0;
+
+ public:
+  explicit SequenceJob(std::vector<std::function<bool()>> steps) : steps(std::move(steps)) {}
+  State resume(const Deadline& deadline) override;
+};
+
+// Runs its jobs round robin in time slices. Not thread safe, all calls must come from the task that runs it.
+// Finished jobs are destroyed, as are pending ones when the scheduler is cleared or destroyed
+class JobScheduler {
+  JobClock clock;
+  std::vector<std::unique_ptr<Job>> jobs;
+  size_t next = 0;
+
+ public:
+  explicit JobScheduler(const JobClock clock) : clock(clock) {}
+  bool add(std::unique_ptr<Job> job);
+  // Resumes jobs until the slice is used up or none are left, returns whether any are left
+  bool runFor(unsigned long sliceMs);
+  // Runs every job to its end
+  void runAll();
+  void clear();
+  bool empty() const { return jobs.empty(); }
+  size_t size() const { return jobs.size(); }
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 class FsFile;
 class Print;
 class ZipFile;
@@ -8,10 +10,11 @@ class JpegToBmpConverter {
   static unsigned char jpegReadCallback(unsigned char* pBuf, unsigned char buf_size,
                                         unsigned char* pBytes_actually_read, void* pCallback_data);
   static bool jpegFileToBmpStreamInternal(class FsFile& jpegFile, Print& bmpOut, int targetWidth, int targetHeight,
-                                          bool oneBit);
+                                          bool oneBit, const std::function<bool()>& yieldFn = nullptr);
 
  public:
-  static bool jpegFileToBmpStream(FsFile& jpegFile, Print& bmpOut);
+  // yieldFn is called between rows of MCUs, returning false stops the conversion, which then fails
+  static bool jpegFileToBmpStream(FsFile& jpegFile, Print& bmpOut, const std::function<bool()>& yieldFn = nullptr);
   // Convert with custom target size (for thumbnails)
   static bool jpegFileToBmpStreamWithSize(FsFile& jpegFile, Print& bmpOut, int targetMaxWidth, int targetMaxHeight);
   // Convert to 1-bit BMP (black and white only, no grays) for fast home screen rendering
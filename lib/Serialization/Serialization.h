@@ -1,6 +1,7 @@
 #pragma once
 #include <SdFat.h>
 
+#include <cstring>
 #include <iostream>
 
 namespace serialization {
@@ -24,19 +25,30 @@ static void readPod(FsFile& file, T& value) {
   file.read(reinterpret_cast<uint8_t*>(&value), sizeof(T));
 }
 
-static void writeString(std::ostream& os, const std::string& s) {
+// Reads from an in-memory buffer, advancing data; fails without reading past end
+template <typename T>
+static bool readPod(const uint8_t*& data, const uint8_t* end, T& value) {
+  if (static_cast<size_t>(end - data) < sizeof(T)) {
+    return false;
+  }
+  memcpy(&value, data, sizeof(T));
+  data += sizeof(T);
+  return true;
+}
+
+inline void writeString(std::ostream& os, const std::string& s) {
   const uint32_t len = s.size();
   writePod(os, len);
   os.write(s.data(), len);
 }
 
-static void writeString(FsFile& file, const std::string& s) {
+inline void writeString(FsFile& file, const std::string& s) {
   const uint32_t len = s.size();
   writePod(file, len);
   file.write(reinterpret_cast<const uint8_t*>(s.data()), len);
 }
 
-static void readString(std::istream& is, std::string& s) {
+inline void readString(std::istream& is, std::string& s) {
   uint32_t len;
   readPod(is, len);
   if (len > 4096) {
@@ -49,7 +61,7 @@ static void readString(std::istream& is, std::string& s) {
   }
 }
 
-static void readString(FsFile& file, std::string& s) {
+inline void readString(FsFile& file, std::string& s) {
   uint32_t len;
   readPod(file, len);
   if (len > 4096) {
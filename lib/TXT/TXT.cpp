@@ -6,6 +6,7 @@
  *           4. 新增：复用EPUB的addWord逻辑拆分UTF-8字符，和EPUB渲染完全对齐
  */
 #include "Txt.h"
+#include <CodepointSet.h>
 #include <HardwareSerial.h>
 #include <../Utf8/Utf8.h>          
 #include <../Epub/Epub/htmlEntities.h>  
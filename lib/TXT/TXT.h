@@ -11,6 +11,10 @@
 // 替换为你项目中实际定义EpdFontStyle的头文件路径（比如EpdFontFamily.h）
 #include <EpdFontFamily.h>
 
+#include "TxtCharsetScanner.h"
+
+class CodepointSet;
+
 // 宏定义常量 (按需修改数值即可，和你需求一致)
 #define MAX_SAVE_CHAPTER  30    // 最多存30章
 #define TITLE_KEEP_LENGTH 20    // 标题截取前20个UTF8字符
@@ -225,4 +229,4 @@ public:
      */
     void SectionLayout(uint32_t beginbype,uint32_t endbype);
 
-};
\ No newline at end of file
+};
@@ -0,0 +1,71 @@
+#include "TxtCharsetScanner.h"
+
+#include <CodepointSet.h>
+#include <Utf8.h>
+
+#include <cstring>
+
+bool TxtCharsetScanner::begin(const std::string& path) {
+    close();
+    if (!SdMan.openFileForRead("TXT", path, file)) {
+        return false;
+    }
+    // 显示任务的栈较小，缓冲区放在堆上；多留4字节放上一块末尾被截断的字符和结尾的0
+    buf.reset(new (std::nothrow) unsigned char[CHUNK_SIZE + 4]);
+    if (!buf) {
+        file.close();
+        return false;
+    }
+    carry = 0;
+    return true;
+}
+
+bool TxtCharsetScanner::scanChunk(CodepointSet& charset) {
+    if (!buf) {
+        return false;
+    }
+    const int bytesRead = file.read(buf.get() + carry, CHUNK_SIZE);
+    if (bytesRead <= 0) {
+        close();
+        return false;
+    }
+    const size_t length = carry + bytesRead;
+
+    // 找到最后一个完整字符的结尾，被截断的多字节字符留给下一块
+    size_t end = length;
+    size_t lead = length;
+    while (lead > 0 && length - lead < 3 && (buf[lead - 1] & 0xC0) == 0x80) {
+        lead--;
+    }
+    if (lead > 0 && buf[lead - 1] >= 0xC0) {
+        const unsigned char c = buf[lead - 1];
+        const size_t need = c >= 0xF0 ? 4 : (c >= 0xE0 ? 3 : 2);
+        if (length - (lead - 1) < need) {
+            end = lead - 1;
+        }
+    }
+
+    // utf8NextCodepoint以0结尾判断越界，临时写入结尾0
+    const unsigned char saved = buf[end];
+    buf[end] = 0;
+    const unsigned char* p = buf.get();
+    while (p < buf.get() + end) {
+        const uint32_t cp = utf8NextCodepoint(&p);
+        if (cp >= 0x20) {
+            charset.add(cp);
+        }
+    }
+    buf[end] = saved;
+
+    carry = length - end;
+    memmove(buf.get(), buf.get() + end, carry);
+    return true;
+}
+
+void TxtCharsetScanner::close() {
+    if (file) {
+        file.close();
+    }
+    buf.reset();
+    carry = 0;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <SDCardManager.h>
+
+#include <memory>
+#include <string>
+
+class CodepointSet;
+
+/**
+ * @brief 分块扫描整个TXT文件，收集书中出现的全部字符（用于生成本书的字体子集）
+ *        每次只读一块，供后台任务分多次完成
+ */
+class TxtCharsetScanner {
+    FsFile file;
+    std::unique_ptr<unsigned char[]> buf;
+    size_t carry = 0;
+
+public:
+    static constexpr size_t CHUNK_SIZE = 4096;
+
+    ~TxtCharsetScanner() { close(); }
+    // 打开文件并分配缓冲区，失败返回false
+    bool begin(const std::string& path);
+    // 扫描下一块，读完整个文件后返回false
+    bool scanChunk(CodepointSet& charset);
+    void close();
+};
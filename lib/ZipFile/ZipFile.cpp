@@ -295,7 +295,7 @@ uint8_t* ZipFile::readFileToMemory(const char* filename, size_t* size, const boo
   const auto dataSize = trailingNullByte ? inflatedDataSize + 1 : inflatedDataSize;
   const auto data = static_cast<uint8_t*>(malloc(dataSize));
   if (data == nullptr) {
-    Serial.printf("[%lu] [ZIP] Failed to allocate memory for output buffer (%zu bytes)\n", millis(), dataSize);
+    Serial.printf("[%lu] [ZIP] Failed to allocate memory for output buffer (%u bytes)\n", millis(), dataSize);
     if (!wasOpen) {
       close();
     }
@@ -333,7 +333,8 @@ uint8_t* ZipFile::readFileToMemory(const char* filename, size_t* size, const boo
     }
 
     if (dataRead != deflatedDataSize) {
-      Serial.printf("[%lu] [ZIP] Failed to read data, expected %d got %d\n", millis(), deflatedDataSize, dataRead);
+      Serial.printf("[%lu] [ZIP] Failed to read data, expected %u got %u\n", millis(), deflatedDataSize,
+                    static_cast<unsigned>(dataRead));
       free(deflatedData);
       free(data);
       return nullptr;
@@ -548,3 +549,205 @@ bool ZipFile::readFileToStream(const char* filename, Print& out, const size_t ch
   Serial.printf("[%lu] [ZIP] Unsupported compression method\n", millis());
   return false;
 }
+
+size_t ZipFileReader::inflateStateBytes(const size_t chunkSize) {
+  return sizeof(tinfl_decompressor) + TINFL_LZ_DICT_SIZE + chunkSize;
+}
+
+bool ZipFileReader::open(const char* filename, const size_t chunkSize, const std::string& spoolPath) {
+  close();
+  if (!zip.open()) {
+    return false;
+  }
+
+  if (!zip.loadFileStatSlim(filename, &fileStat)) {
+    zip.close();
+    return false;
+  }
+
+  const long fileOffset = zip.getDataOffset(fileStat);
+  if (fileOffset < 0) {
+    zip.close();
+    return false;
+  }
+  zip.file.seek(fileOffset);
+
+  this->chunkSize = chunkSize;
+  done = false;
+  failed = false;
+
+  if (fileStat.method == MZ_NO_COMPRESSION) {
+    // Stored entries are read straight into the caller's buffer, no inflate state needed
+    fileRemainingBytes = fileStat.uncompressedSize;
+    done = fileRemainingBytes == 0;
+    return true;
+  }
+
+  if (fileStat.method != MZ_DEFLATED) {
+    Serial.printf("[%lu] [ZIP] Unsupported compression method\n", millis());
+    close();
+    return false;
+  }
+  if (!spoolPath.empty()) {
+    return openSpooled(filename, spoolPath);
+  }
+  fileRemainingBytes = fileStat.compressedSize;
+
+  inflator = static_cast<tinfl_decompressor*>(malloc(sizeof(tinfl_decompressor)));
+  fileReadBuffer = static_cast<uint8_t*>(malloc(chunkSize));
+  dictionary = static_cast<uint8_t*>(malloc(TINFL_LZ_DICT_SIZE));
+  if (!inflator || !fileReadBuffer || !dictionary) {
+    Serial.printf("[%lu] [ZIP] Failed to allocate memory for streaming inflate\n", millis());
+    close();
+    return false;
+  }
+  memset(inflator, 0, sizeof(tinfl_decompressor));
+  tinfl_init(inflator);
+  return true;
+}
+
+bool ZipFileReader::openSpooled(const char* filename, const std::string& path) {
+  // readFileToStream frees its inflate state before returning, and the zip isn't needed once the entry is on SD
+  FsFile out;
+  bool inflated = false;
+  if (SdMan.openFileForWrite("ZIP", path, out)) {
+    inflated = zip.readFileToStream(filename, out, chunkSize);
+    out.close();
+  }
+  zip.close();
+  spoolPath = path;
+  if (!inflated || !SdMan.openFileForRead("ZIP", path, spool)) {
+    Serial.printf("[%lu] [ZIP] Failed to spool %s to %s\n", millis(), filename, path.c_str());
+    close();
+    return false;
+  }
+  done = spool.available() == 0;
+  return true;
+}
+
+void ZipFileReader::close() {
+  if (spool.isOpen()) {
+    spool.close();
+  }
+  if (!spoolPath.empty()) {
+    SdMan.remove(spoolPath.c_str());
+    spoolPath.clear();
+  }
+  free(inflator);
+  free(fileReadBuffer);
+  free(dictionary);
+  inflator = nullptr;
+  fileReadBuffer = nullptr;
+  dictionary = nullptr;
+  fileRemainingBytes = 0;
+  fileReadBufferFilledBytes = 0;
+  fileReadBufferCursor = 0;
+  dictionaryCursor = 0;
+  pendingCursor = 0;
+  pendingBytes = 0;
+  zip.close();
+}
+
+size_t ZipFileReader::read(uint8_t* buffer, const size_t size) {
+  size_t copied = 0;
+  while (copied < size && !failed) {
+    // Hand out what the last inflate step produced before producing more
+    if (pendingBytes > 0) {
+      const size_t toCopy = pendingBytes < size - copied ? pendingBytes : size - copied;
+      memcpy(buffer + copied, dictionary + pendingCursor, toCopy);
+      pendingCursor += toCopy;
+      pendingBytes -= toCopy;
+      copied += toCopy;
+      continue;
+    }
+    if (done) {
+      break;
+    }
+
+    if (spool.isOpen()) {
+      const int dataRead = spool.read(buffer + copied, size - copied);
+      if (dataRead <= 0) {
+        Serial.printf("[%lu] [ZIP] Could not read more bytes from spool file\n", millis());
+        failed = true;
+        break;
+      }
+      copied += dataRead;
+      done = spool.available() == 0;
+      continue;
+    }
+
+    if (fileStat.method == MZ_NO_COMPRESSION) {
+      const size_t toRead = fileRemainingBytes < size - copied ? fileRemainingBytes : size - copied;
+      const size_t dataRead = zip.file.read(buffer + copied, toRead);
+      if (dataRead == 0) {
+        Serial.printf("[%lu] [ZIP] Could not read more bytes\n", millis());
+        failed = true;
+        break;
+      }
+      copied += dataRead;
+      fileRemainingBytes -= dataRead;
+      done = fileRemainingBytes == 0;
+      continue;
+    }
+
+    // Load more compressed bytes when needed
+    if (fileReadBufferCursor >= fileReadBufferFilledBytes && fileRemainingBytes > 0) {
+      fileReadBufferFilledBytes =
+          zip.file.read(fileReadBuffer, fileRemainingBytes < chunkSize ? fileRemainingBytes : chunkSize);
+      fileReadBufferCursor = 0;
+      if (fileReadBufferFilledBytes == 0) {
+        Serial.printf("[%lu] [ZIP] Could not read more bytes\n", millis());
+        failed = true;
+        break;
+      }
+      fileRemainingBytes -= fileReadBufferFilledBytes;
+    }
+
+    size_t inBytes = fileReadBufferFilledBytes - fileReadBufferCursor;
+    size_t outBytes = TINFL_LZ_DICT_SIZE - dictionaryCursor;
+    const tinfl_status status = tinfl_decompress(inflator, fileReadBuffer + fileReadBufferCursor, &inBytes,
+                                                 dictionary, dictionary + dictionaryCursor, &outBytes,
+                                                 fileRemainingBytes > 0 ? TINFL_FLAG_HAS_MORE_INPUT : 0);
+    fileReadBufferCursor += inBytes;
+    pendingCursor = dictionaryCursor;
+    pendingBytes = outBytes;
+    dictionaryCursor = (dictionaryCursor + outBytes) & (TINFL_LZ_DICT_SIZE - 1);
+
+    if (status < 0) {
+      Serial.printf("[%lu] [ZIP] tinfl_decompress() failed with status %d\n", millis(), status);
+      failed = true;
+    } else if (status == TINFL_STATUS_DONE) {
+      Serial.printf("[%lu] [ZIP] Decompressed %d bytes into %d bytes\n", millis(), fileStat.compressedSize,
+                    fileStat.uncompressedSize);
+      done = true;
+    } else if (inBytes == 0 && outBytes == 0) {
+      // All compressed bytes are consumed and the inflator can't make progress
+      Serial.printf("[%lu] [ZIP] Unexpected EOF\n", millis());
+      failed = true;
+    }
+  }
+
+  return copied;
+}
+
+size_t ZipFileReader::skip(const size_t size) {
+  size_t skipped = 0;
+  uint8_t scratch[256];
+  while (skipped < size && !failed) {
+    // What inflate already produced is dropped without a copy
+    if (pendingBytes > 0) {
+      const size_t toDrop = pendingBytes < size - skipped ? pendingBytes : size - skipped;
+      pendingCursor += toDrop;
+      pendingBytes -= toDrop;
+      skipped += toDrop;
+      continue;
+    }
+    const size_t toRead = size - skipped < sizeof(scratch) ? size - skipped : sizeof(scratch);
+    const size_t dataRead = read(scratch, toRead);
+    if (dataRead == 0) {
+      break;
+    }
+    skipped += dataRead;
+  }
+  return skipped;
+}
@@ -4,7 +4,12 @@
 #include <string>
 #include <unordered_map>
 
+struct tinfl_decompressor_tag;
+
 class ZipFile {
+  friend class ZipFileReader;
+
+
  public:
   struct FileStatSlim {
     uint16_t method;             // Compression method
@@ -44,3 +49,52 @@ class ZipFile {
   uint8_t* readFileToMemory(const char* filename, size_t* size = nullptr, bool trailingNullByte = false);
   bool readFileToStream(const char* filename, Print& out, size_t chunkSize);
 };
+
+// Pull based reading of one zip entry, for consumers that drive the reads themselves (e.g. an XML parser filling its
+// own buffer). Unlike ZipFile::readFileToStream the zip stays open and the inflate state (decompressor, read buffer
+// and 32KB dictionary) lives in between read() calls, until close() or destruction. When the heap can't spare that for
+// so long, the entry can be spooled instead: inflated to a temp file on open and read back from it.
+class ZipFileReader {
+  std::string zipPath;
+  ZipFile zip;  // Refers to zipPath
+  ZipFile::FileStatSlim fileStat = {};
+  tinfl_decompressor_tag* inflator = nullptr;
+  uint8_t* fileReadBuffer = nullptr;
+  uint8_t* dictionary = nullptr;
+  size_t chunkSize = 0;
+  size_t fileRemainingBytes = 0;
+  size_t fileReadBufferFilledBytes = 0;
+  size_t fileReadBufferCursor = 0;
+  size_t dictionaryCursor = 0;  // Where the next inflated bytes go in the circular dictionary
+  size_t pendingCursor = 0;     // Inflated bytes in the dictionary not yet handed out by read()
+  size_t pendingBytes = 0;
+  bool done = false;
+  bool failed = false;
+  FsFile spool;
+  std::string spoolPath;
+
+  bool openSpooled(const char* filename, const std::string& path);
+
+ public:
+  explicit ZipFileReader(std::string zipPath) : zipPath(std::move(zipPath)), zip(this->zipPath) {}
+  ~ZipFileReader() { close(); }
+  ZipFileReader(const ZipFileReader&) = delete;
+  ZipFileReader& operator=(const ZipFileReader&) = delete;
+
+  // With a spoolPath a deflated entry is inflated to that file and read from it, the inflate state is only allocated
+  // during open. The file is removed on close()
+  bool open(const char* filename, size_t chunkSize, const std::string& spoolPath = "");
+  void close();
+  // Heap an open deflated entry holds on to while it isn't spooled
+  static size_t inflateStateBytes(size_t chunkSize);
+  // Copies up to size inflated bytes into buffer. Returns 0 once the entry is exhausted or on failure, which
+  // hasFailed() tells apart.
+  size_t read(uint8_t* buffer, size_t size);
+  // Inflates and drops up to size bytes, returns how many. An entry can't be entered part way, inflating needs what
+  // came before.
+  size_t skip(size_t size);
+  // True once every inflated byte of the entry was handed out
+  bool isDone() const { return done && pendingBytes == 0; }
+  bool hasFailed() const { return failed; }
+  size_t getInflatedSize() const { return fileStat.uncompressedSize; }
+};
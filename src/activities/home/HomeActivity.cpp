@@ -17,11 +17,21 @@
 #include "fontIds.h"
 #include "util/StringUtils.h"
 
+namespace {
+// Slice the load task runs jobs for before handing the rendering mutex over
+constexpr unsigned long jobSliceMs = 30;
+}  // namespace
+
 void HomeActivity::taskTrampoline(void* param) {
   auto* self = static_cast<HomeActivity*>(param);
   self->displayTaskLoop();
 }
 
+void HomeActivity::loadTaskTrampoline(void* param) {
+  auto* self = static_cast<HomeActivity*>(param);
+  self->loadTask();
+}
+
 int HomeActivity::getMenuItemCount() const {
   int count = 3;  // Browse files, File transfer, Settings
   if (hasContinueReading) count++;
@@ -41,49 +51,16 @@ void HomeActivity::onEnter() {
   hasOpdsUrl = strlen(SETTINGS.opdsServerUrl) > 0;
 
   if (hasContinueReading) {
-    // Extract filename from path for display
+    // Extract filename from path for display, until the metadata is loaded
     lastBookTitle = APP_STATE.openEpubPath;
     const size_t lastSlash = lastBookTitle.find_last_of('/');
     if (lastSlash != std::string::npos) {
       lastBookTitle = lastBookTitle.substr(lastSlash + 1);
     }
 
-    // If epub, try to load the metadata for title/author and cover
-    if (StringUtils::checkFileExtension(lastBookTitle, ".epub")) {
-      Epub epub(APP_STATE.openEpubPath, "/.crosspoint");
-      epub.load(false);
-      if (!epub.getTitle().empty()) {
-        lastBookTitle = std::string(epub.getTitle());
-      }
-      if (!epub.getAuthor().empty()) {
-        lastBookAuthor = std::string(epub.getAuthor());
-      }
-      // Try to generate thumbnail image for Continue Reading card
-      if (epub.generateCoverBmp()) {
-        coverBmpPath = epub.getCoverBmpPath();
-        hasCoverImage = true;
-      }
-    } else if (StringUtils::checkFileExtension(lastBookTitle, ".xtch") ||
-               StringUtils::checkFileExtension(lastBookTitle, ".xtc")) {
-      // Handle XTC file
-      Xtc xtc(APP_STATE.openEpubPath, "/.crosspoint");
-      if (xtc.load()) {
-        if (!xtc.getTitle().empty()) {
-          lastBookTitle = std::string(xtc.getTitle());
-        }
-        // Try to generate thumbnail image for Continue Reading card
-        if (xtc.generateCoverBmp()) {
-          coverBmpPath = xtc.generateCoverBmp();
-          hasCoverImage = true;
-        }
-      }
-      // Remove extension from title if we don't have metadata
-      if (StringUtils::checkFileExtension(lastBookTitle, ".xtch")) {
-        lastBookTitle.resize(lastBookTitle.length() - 5);
-      } else if (StringUtils::checkFileExtension(lastBookTitle, ".xtc")) {
-        lastBookTitle.resize(lastBookTitle.length() - 4);
-      }
-    }
+    // Generating the cover is a JPEG decode, seconds on a book's first open. The metadata and the cover are loaded
+    // by a task of their own so the menu is drawn first, and the card fills in once they are there
+    addLastBookJob();
   }
 
   selectorIndex = 0;
@@ -97,6 +74,17 @@ void HomeActivity::onEnter() {
               1,                  // Priority
               &displayTaskHandle  // Task handle
   );
+
+  if (!jobs.empty()) {
+    loadStopRequested = false;
+    // Below the display task, so it only runs while input and rendering are idle
+    xTaskCreate(&HomeActivity::loadTaskTrampoline, "HomeLoadTask",
+                8192,              // Stack size (loads the EPUB and decodes its cover like the main loop did)
+                this,              // Parameters
+                tskIDLE_PRIORITY,  // Priority
+                &loadTaskHandle    // Task handle
+    );
+  }
 }
 
 void HomeActivity::onExit() {
@@ -104,17 +92,94 @@ void HomeActivity::onExit() {
 
   // Wait until not rendering to delete task to avoid killing mid-instruction to EPD
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
+  if (loadTaskHandle) {
+    loadStopRequested = true;
+    // The load task is waiting for the mutex held here, it sees the request and clears its handle
+    while (loadTaskHandle) {
+      vTaskDelay(5 / portTICK_PERIOD_MS);
+    }
+  }
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
   renderingMutex = nullptr;
+  jobs.clear();
 
   // Free the stored cover buffer if any
   freeCoverBuffer();
 }
 
+void HomeActivity::addLastBookJob() {
+  if (StringUtils::checkFileExtension(lastBookTitle, ".epub")) {
+    std::shared_ptr<Epub> epub(new (std::nothrow) Epub(APP_STATE.openEpubPath, "/.crosspoint"));
+    if (!epub) {
+      return;
+    }
+    jobs.add(std::unique_ptr<Job>(new (std::nothrow) SequenceJob({
+        [this, epub] {
+          // Try to load the metadata for title/author
+          epub->load(false);
+          if (!epub->getTitle().empty()) {
+            lastBookTitle = std::string(epub->getTitle());
+          }
+          if (!epub->getAuthor().empty()) {
+            lastBookAuthor = std::string(epub->getAuthor());
+          }
+          updateRequired = true;
+          return true;
+        },
+        [this, epub] {
+          // Try to generate thumbnail image for Continue Reading card, rendering goes first between rows of the decode
+          if (epub->generateCoverBmp([this] {
+                xSemaphoreGive(renderingMutex);
+                return takeMutexForLoad();
+              })) {
+            coverBmpPath = epub->getCoverBmpPath();
+            hasCoverImage = true;
+            updateRequired = true;
+          }
+          return true;
+        },
+    })));
+  } else if (StringUtils::checkFileExtension(lastBookTitle, ".xtch") ||
+             StringUtils::checkFileExtension(lastBookTitle, ".xtc")) {
+    // Handle XTC file
+    std::shared_ptr<Xtc> xtc(new (std::nothrow) Xtc(APP_STATE.openEpubPath, "/.crosspoint"));
+    // Remove extension from title if we don't have metadata
+    if (StringUtils::checkFileExtension(lastBookTitle, ".xtch")) {
+      lastBookTitle.resize(lastBookTitle.length() - 5);
+    } else if (StringUtils::checkFileExtension(lastBookTitle, ".xtc")) {
+      lastBookTitle.resize(lastBookTitle.length() - 4);
+    }
+    if (!xtc) {
+      return;
+    }
+    jobs.add(std::unique_ptr<Job>(new (std::nothrow) SequenceJob({
+        [this, xtc] {
+          if (!xtc->load()) {
+            return false;
+          }
+          if (!xtc->getTitle().empty()) {
+            lastBookTitle = std::string(xtc->getTitle());
+            updateRequired = true;
+          }
+          return true;
+        },
+        [this, xtc] {
+          // Try to generate thumbnail image for Continue Reading card
+          if (xtc->generateCoverBmp()) {
+            coverBmpPath = xtc->getCoverBmpPath();
+            hasCoverImage = true;
+            updateRequired = true;
+          }
+          return true;
+        },
+    })));
+  }
+}
+
 bool HomeActivity::storeCoverBuffer() {
   uint8_t* frameBuffer = renderer.getFrameBuffer();
   if (!frameBuffer) {
@@ -206,6 +271,40 @@ void HomeActivity::displayTaskLoop() {
   }
 }
 
+// Takes the rendering mutex in short waits so a stop request is seen even while the requester holds it
+bool HomeActivity::takeMutexForLoad() {
+  while (xSemaphoreTake(renderingMutex, 10 / portTICK_PERIOD_MS) != pdTRUE) {
+    if (loadStopRequested) {
+      return false;
+    }
+  }
+  if (loadStopRequested) {
+    xSemaphoreGive(renderingMutex);
+    return false;
+  }
+  return true;
+}
+
+void HomeActivity::loadTask() {
+  // Jobs run with the rendering mutex held, which is handed over between slices and rows of the cover decode. Once a
+  // stop is requested the mutex is not taken again, onExit holds it and waits for this task to finish.
+  while (takeMutexForLoad()) {
+    jobs.runFor(jobSliceMs);
+    if (loadStopRequested) {
+      // Stopped during the cover decode, which left the mutex to onExit
+      break;
+    }
+    const bool done = jobs.empty();
+    xSemaphoreGive(renderingMutex);
+    if (done) {
+      break;
+    }
+  }
+
+  loadTaskHandle = nullptr;
+  vTaskDelete(nullptr);
+}
+
 void HomeActivity::render() {
   // If we have a stored cover buffer, restore it instead of clearing
   const bool bufferRestored = coverBufferStored && restoreCoverBuffer();
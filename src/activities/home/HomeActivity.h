@@ -2,6 +2,7 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 #include <freertos/task.h>
+#include <Jobs.h>
 
 #include <functional>
 
@@ -9,6 +10,9 @@
 
 class HomeActivity final : public Activity {
   TaskHandle_t displayTaskHandle = nullptr;
+  // Runs the jobs below at a lower priority than the display task, see loadTask
+  TaskHandle_t loadTaskHandle = nullptr;
+  bool loadStopRequested = false;
   SemaphoreHandle_t renderingMutex = nullptr;
   int selectorIndex = 0;
   bool updateRequired = false;
@@ -21,6 +25,8 @@ class HomeActivity final : public Activity {
   std::string lastBookTitle;
   std::string lastBookAuthor;
   std::string coverBmpPath;
+  // Loads the last book's metadata and cover
+  JobScheduler jobs{millis};
   const std::function<void()> onContinueReading;
   const std::function<void()> onReaderOpen;
   const std::function<void()> onSettingsOpen;
@@ -29,8 +35,12 @@ class HomeActivity final : public Activity {
 
   static void taskTrampoline(void* param);
   [[noreturn]] void displayTaskLoop();
+  static void loadTaskTrampoline(void* param);
+  void loadTask();
+  bool takeMutexForLoad();
   void render();
   int getMenuItemCount() const;
+  void addLastBookJob();
   bool storeCoverBuffer();    // Store frame buffer for cover image
   bool restoreCoverBuffer();  // Restore frame buffer from stored cover
   void freeCoverBuffer();     // Free the stored cover buffer
@@ -49,4 +59,5 @@ class HomeActivity final : public Activity {
   void onEnter() override;
   void onExit() override;
   void loop() override;
+  bool preventAutoSleep() override { return loadTaskHandle != nullptr; }
 };
@@ -1,5 +1,6 @@
 #include "EpubReaderActivity.h"
 
+#include <CustomEpdFont.h>
 #include <Epub/Page.h>
 #include <FsHelpers.h>
 #include <GfxRenderer.h>
@@ -11,6 +12,7 @@
 #include "MappedInputManager.h"
 #include "ScreenComponents.h"
 #include "fontIds.h"
+#include "managers/FontManager.h"
 
 namespace {
 constexpr int pagesPerRefresh = 15;
@@ -19,6 +21,10 @@ constexpr unsigned long goHomeMs = 1000;
 constexpr int topPadding = 5;
 constexpr int horizontalPadding = 5;
 constexpr int statusBarMargin = 19;
+// Start laying out the next chapter in the background once this few pages of the current one are left
+constexpr int prelayoutPagesLeft = 5;
+// Glyphs of the font subset written per turn of the layout task, between which the rendering mutex is handed over
+constexpr uint32_t subsetGlyphsPerStep = 32;
 }  // namespace
 
 void EpubReaderActivity::taskTrampoline(void* param) {
@@ -26,6 +32,11 @@ void EpubReaderActivity::taskTrampoline(void* param) {
   self->displayTaskLoop();
 }
 
+void EpubReaderActivity::layoutTaskTrampoline(void* param) {
+  auto* self = static_cast<EpubReaderActivity*>(param);
+  self->layoutTask();
+}
+
 void EpubReaderActivity::onEnter() {
   ActivityWithSubactivity::onEnter();
 
@@ -55,6 +66,14 @@ void EpubReaderActivity::onEnter() {
 
   epub->setupCacheDir();
 
+  if (FontManager::getInstance().hasReaderFont()) {
+    bookCharset.load(FontManager::getCharsetPath(epub->getCachePath()));
+    // No subset for this font yet (e.g. the font was changed), the layout task writes it from the charset after the
+    // first page
+    bookCharsetChanged =
+        !FontManager::getInstance().attachBookSubset(epub->getCachePath()) && bookCharset.size() > 0;
+  }
+
   FsFile f;
   if (SdMan.openFileForRead("ERS", epub->getCachePath() + "/progress.bin", f)) {
     uint8_t data[4];
@@ -99,12 +118,16 @@ void EpubReaderActivity::onExit() {
 
   // Wait until not rendering to delete task to avoid killing mid-instruction to EPD
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
+  // A chapter being laid out keeps its pages so far, it resumes when the book is opened again
+  stopLayout();
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
   renderingMutex = nullptr;
+  FontManager::getInstance().detachBookSubset();
+  bookCharset.clear();
   section.reset();
   epub.reset();
 }
@@ -120,6 +143,8 @@ void EpubReaderActivity::loop() {
   if (mappedInput.wasReleased(MappedInputManager::Button::Confirm)) {
     // Don't start activity transition while rendering
     xSemaphoreTake(renderingMutex, portMAX_DELAY);
+    // The sub activity renders on its own, so layout must not be measuring text or reading SD meanwhile
+    stopLayout();
     exitActivity();
     enterNewActivity(new EpubReaderChapterSelectionActivity(
         this->renderer, this->mappedInput, epub, currentSpineIndex,
@@ -131,7 +156,7 @@ void EpubReaderActivity::loop() {
           if (currentSpineIndex != newSpineIndex) {
             currentSpineIndex = newSpineIndex;
             nextPageNumber = 0;
-            section.reset();
+            resetSection();
           }
           exitActivity();
           updateRequired = true;
@@ -159,6 +184,7 @@ void EpubReaderActivity::loop() {
   if (!prevReleased && !nextReleased) {
     return;
   }
+  pageTurnStartedAt = millis();
 
   // any botton press when at end of the book goes back to the last page
   if (currentSpineIndex > 0 && currentSpineIndex >= epub->getSpineItemsCount()) {
@@ -175,7 +201,7 @@ void EpubReaderActivity::loop() {
     xSemaphoreTake(renderingMutex, portMAX_DELAY);
     nextPageNumber = 0;
     currentSpineIndex = nextReleased ? currentSpineIndex + 1 : currentSpineIndex - 1;
-    section.reset();
+    resetSection();
     xSemaphoreGive(renderingMutex);
     updateRequired = true;
     return;
@@ -195,21 +221,23 @@ void EpubReaderActivity::loop() {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       nextPageNumber = UINT16_MAX;
       currentSpineIndex--;
-      section.reset();
+      resetSection();
       xSemaphoreGive(renderingMutex);
     }
     updateRequired = true;
   } else {
-    if (section->currentPage < section->pageCount - 1) {
+    // Past the last page laid out so far the next one is waited for, only a complete chapter moves on to the next.
+    // The layout task grows pageCount and completes the section under the semaphore, and we don't want to delete the
+    // section mid-render either
+    xSemaphoreTake(renderingMutex, portMAX_DELAY);
+    if (section->currentPage < section->pageCount - 1 || !section->isComplete()) {
       section->currentPage++;
     } else {
-      // We don't want to delete the section mid-render, so grab the semaphore
-      xSemaphoreTake(renderingMutex, portMAX_DELAY);
       nextPageNumber = 0;
       currentSpineIndex++;
-      section.reset();
-      xSemaphoreGive(renderingMutex);
+      resetSection();
     }
+    xSemaphoreGive(renderingMutex);
     updateRequired = true;
   }
 }
@@ -221,11 +249,169 @@ void EpubReaderActivity::displayTaskLoop() {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       renderScreen();
       xSemaphoreGive(renderingMutex);
+      // The page is on screen, use the time until the next button press
+      prefetchAdjacentPages();
+      startPrelayout();
     }
     vTaskDelay(10 / portTICK_PERIOD_MS);
   }
 }
 
+void EpubReaderActivity::prefetchAdjacentPages() {
+  xSemaphoreTake(renderingMutex, portMAX_DELAY);
+  if (section) {
+    const int page = section->currentPage;
+    // Forward turns are the common case so the next page goes first, a new button press skips the rest
+    if (!updateRequired) {
+      section->prefetchPage(page + 1);
+    }
+    if (!updateRequired) {
+      section->prefetchPage(page - 1);
+    }
+  }
+  xSemaphoreGive(renderingMutex);
+}
+
+void EpubReaderActivity::startPrelayout() {
+  xSemaphoreTake(renderingMutex, portMAX_DELAY);
+  const int nextSpineIndex = currentSpineIndex + 1;
+  if (!layoutTaskHandle && !updateRequired) {
+    if (section && section->isComplete() && section->currentPage >= section->pageCount - prelayoutPagesLeft &&
+        nextSpineIndex != layoutSpineIndex && nextSpineIndex < epub->getSpineItemsCount()) {
+      startLayout(nextSpineIndex);
+    } else if (bookCharsetChanged) {
+      // Nothing to lay out, only the font subset to write
+      startLayout(-1);
+    }
+  }
+  xSemaphoreGive(renderingMutex);
+}
+
+// Must be called with the rendering mutex held
+void EpubReaderActivity::startLayout(const int spineIndex) {
+  layoutSpineIndex = spineIndex;
+  layoutStopRequested = false;
+  // Below the display task, so it only runs while input and rendering are idle
+  xTaskCreate(&EpubReaderActivity::layoutTaskTrampoline, "EpubLayoutTask",
+              6144,              // Stack size
+              this,              // Parameters
+              tskIDLE_PRIORITY,  // Priority
+              &layoutTaskHandle  // Task handle
+  );
+}
+
+// Must be called with the rendering mutex held
+void EpubReaderActivity::stopLayout() {
+  if (!layoutTaskHandle) {
+    return;
+  }
+  layoutStopRequested = true;
+  // The layout task is waiting for the mutex held here, it sees the request, cleans up and clears its handle
+  while (layoutTaskHandle) {
+    vTaskDelay(5 / portTICK_PERIOD_MS);
+  }
+  layoutSpineIndex = -1;
+}
+
+// Must be called with the rendering mutex held
+void EpubReaderActivity::resetSection() {
+  // The layout task may be building this section in place
+  stopLayout();
+  section.reset();
+  layoutFailed = false;
+  waitingForLayout = false;
+}
+
+// Takes the rendering mutex in short waits so a stop request is seen even while the requester holds it
+bool EpubReaderActivity::takeMutexForLayout() {
+  while (xSemaphoreTake(renderingMutex, 10 / portTICK_PERIOD_MS) != pdTRUE) {
+    if (layoutStopRequested) {
+      return false;
+    }
+  }
+  if (layoutStopRequested) {
+    xSemaphoreGive(renderingMutex);
+    return false;
+  }
+  return true;
+}
+
+void EpubReaderActivity::layoutTask() {
+  // Work happens with the rendering mutex held, which is handed over between chunks. Once a stop is requested
+  // the mutex is not taken again, the requester holds it and waits for this task to finish.
+  if (takeMutexForLayout()) {
+    if (layoutSpineIndex >= 0) {
+      const auto start = millis();
+      // The chapter on screen is built in place so the reader can show its pages as they are laid out
+      const bool inPlace = section && layoutSpineIndex == currentSpineIndex;
+      std::unique_ptr<Section> otherSection;
+      Section* target = section.get();
+      bool built = false;
+      if (!inPlace) {
+        otherSection.reset(new Section(epub, layoutSpineIndex, renderer));
+        target = otherSection.get();
+        built = target->loadSectionFile(SETTINGS.getReaderFontId(), SETTINGS.getReaderLineCompression(),
+                                        SETTINGS.extraParagraphSpacing, viewportWidth, viewportHeight) &&
+                target->isComplete();
+      }
+      if (!built) {
+        const size_t charsetSize = bookCharset.size();
+        CodepointSet* charset = FontManager::getInstance().hasReaderFont() ? &bookCharset : nullptr;
+        built = target->createSectionFile(SETTINGS.getReaderFontId(), SETTINGS.getReaderLineCompression(),
+                                          SETTINGS.extraParagraphSpacing, viewportWidth, viewportHeight, nullptr,
+                                          nullptr, charset, [this] {
+                                            xSemaphoreGive(renderingMutex);
+                                            return takeMutexForLayout();
+                                          });
+        bookCharsetChanged |= bookCharset.size() != charsetSize;
+      }
+      otherSection.reset();
+      Serial.printf("[%lu] [ERS] Background layout of spine %d %s after %lums\n", millis(), layoutSpineIndex,
+                    built ? "done" : "stopped", millis() - start);
+      if (!layoutStopRequested) {
+        layoutFailed = !built && inPlace;
+      }
+    }
+    // The new chapter's characters are read from the subset once it is rewritten
+    if (!layoutStopRequested && bookCharsetChanged) {
+      updateBookSubset();
+    }
+    if (!layoutStopRequested) {
+      xSemaphoreGive(renderingMutex);
+    }
+  }
+
+  layoutTaskHandle = nullptr;
+  vTaskDelete(nullptr);
+}
+
+// Runs on the layout task with the rendering mutex held, handed over between steps of the writer. Glyphs come from
+// the full font until the subset is attached again.
+void EpubReaderActivity::updateBookSubset() {
+  const auto start = millis();
+  std::unique_ptr<CustomEpdFont::SubsetWriter> writer;
+  if (bookCharset.save(FontManager::getCharsetPath(epub->getCachePath()))) {
+    writer = FontManager::getInstance().beginBookSubsetUpdate(epub->getCachePath(), bookCharset);
+  }
+  while (writer && !writer->done()) {
+    if (!writer->step(subsetGlyphsPerStep)) {
+      writer.reset();
+      break;
+    }
+    xSemaphoreGive(renderingMutex);
+    if (!takeMutexForLayout()) {
+      // The partial file goes with the writer, the subset is written again from the start next time
+      return;
+    }
+  }
+  // Failures are not retried until the charset changes again
+  bookCharsetChanged = false;
+  if (writer && FontManager::getInstance().attachBookSubset(epub->getCachePath())) {
+    Serial.printf("[%lu] [ERS] Updated font subset to %u characters in %lums\n", millis(),
+                  static_cast<unsigned>(bookCharset.size()), millis() - start);
+  }
+}
+
 // TODO: Failure handling
 void EpubReaderActivity::renderScreen() {
   if (!epub) {
@@ -261,72 +447,69 @@ void EpubReaderActivity::renderScreen() {
   if (!section) {
     const auto filepath = epub->getSpineItem(currentSpineIndex).href;
     Serial.printf("[%lu] [ERS] Loading file: %s, index: %d\n", millis(), filepath.c_str(), currentSpineIndex);
+    // Layout of another chapter, or of this one in a section of its own, gives way. Its pages so far are kept.
+    stopLayout();
     section = std::unique_ptr<Section>(new Section(epub, currentSpineIndex, renderer));
 
-    const auto viewportWidth = renderer.getScreenWidth() - orientedMarginLeft - orientedMarginRight;
-    const auto viewportHeight = renderer.getScreenHeight() - orientedMarginTop - orientedMarginBottom;
+    viewportWidth = renderer.getScreenWidth() - orientedMarginLeft - orientedMarginRight;
+    viewportHeight = renderer.getScreenHeight() - orientedMarginTop - orientedMarginBottom;
 
     if (!section->loadSectionFile(SETTINGS.getReaderFontId(), SETTINGS.getReaderLineCompression(),
                                   SETTINGS.extraParagraphSpacing, viewportWidth, viewportHeight)) {
-      Serial.printf("[%lu] [ERS] Cache not found, building...\n", millis());
-
-      // Progress bar dimensions
-      constexpr int barWidth = 200;
-      constexpr int barHeight = 10;
-      constexpr int boxMargin = 20;
-      const int textWidth = renderer.getTextWidth(UI_12_FONT_ID, "Indexing...");
-      const int boxWidthWithBar = (barWidth > textWidth ? barWidth : textWidth) + boxMargin * 2;
-      const int boxWidthNoBar = textWidth + boxMargin * 2;
-      const int boxHeightWithBar = renderer.getLineHeight(UI_12_FONT_ID) + barHeight + boxMargin * 3;
-      const int boxHeightNoBar = renderer.getLineHeight(UI_12_FONT_ID) + boxMargin * 2;
-      const int boxXWithBar = (renderer.getScreenWidth() - boxWidthWithBar) / 2;
-      const int boxXNoBar = (renderer.getScreenWidth() - boxWidthNoBar) / 2;
-      constexpr int boxY = 50;
-      const int barX = boxXWithBar + (boxWidthWithBar - barWidth) / 2;
-      const int barY = boxY + renderer.getLineHeight(UI_12_FONT_ID) + boxMargin * 2;
-
-      // Always show "Indexing..." text first
-      {
-        renderer.fillRect(boxXNoBar, boxY, boxWidthNoBar, boxHeightNoBar, false);
-        renderer.drawText(UI_12_FONT_ID, boxXNoBar + boxMargin, boxY + boxMargin, "Indexing...");
-        renderer.drawRect(boxXNoBar + 5, boxY + 5, boxWidthNoBar - 10, boxHeightNoBar - 10);
-        renderer.displayBuffer();
-        pagesUntilFullRefresh = 0;
-      }
-
-      // Setup callback - only called for chapters >= 50KB, redraws with progress bar
-      auto progressSetup = [this, boxXWithBar, boxWidthWithBar, boxHeightWithBar, barX, barY] {
-        renderer.fillRect(boxXWithBar, boxY, boxWidthWithBar, boxHeightWithBar, false);
-        renderer.drawText(UI_12_FONT_ID, boxXWithBar + boxMargin, boxY + boxMargin, "Indexing...");
-        renderer.drawRect(boxXWithBar + 5, boxY + 5, boxWidthWithBar - 10, boxHeightWithBar - 10);
-        renderer.drawRect(barX, barY, barWidth, barHeight);
-        renderer.displayBuffer();
-      };
-
-      // Progress callback to update progress bar
-      auto progressCallback = [this, barX, barY, barWidth, barHeight](int progress) {
-        const int fillWidth = (barWidth - 2) * progress / 100;
-        renderer.fillRect(barX + 1, barY + 1, fillWidth, barHeight - 2, true);
-        renderer.displayBuffer(EInkDisplay::FAST_REFRESH);
-      };
-
-      if (!section->createSectionFile(SETTINGS.getReaderFontId(), SETTINGS.getReaderLineCompression(),
-                                      SETTINGS.extraParagraphSpacing, viewportWidth, viewportHeight, progressSetup,
-                                      progressCallback)) {
-        Serial.printf("[%lu] [ERS] Failed to persist page data to SD\n", millis());
-        section.reset();
-        return;
-      }
+      Serial.printf("[%lu] [ERS] Cache not found, building in the background...\n", millis());
+    } else if (!section->isComplete()) {
+      Serial.printf("[%lu] [ERS] Cache partly built, resuming after %d pages...\n", millis(), section->pageCount);
     } else {
       Serial.printf("[%lu] [ERS] Cache found, skipping build...\n", millis());
     }
+    section->currentPage = nextPageNumber;
+  }
 
-    if (nextPageNumber == UINT16_MAX) {
-      section->currentPage = section->pageCount - 1;
-    } else {
-      section->currentPage = nextPageNumber;
+  if (!section->isComplete()) {
+    if (layoutFailed) {
+      Serial.printf("[%lu] [ERS] Failed to persist page data to SD\n", millis());
+      resetSection();
+      return;
+    }
+    // Writing the font subset gives way to the chapter on screen
+    if (layoutTaskHandle && layoutSpineIndex != currentSpineIndex) {
+      stopLayout();
+    }
+    if (!layoutTaskHandle) {
+      startLayout(currentSpineIndex);
+    }
+
+    // Pages show as soon as they are laid out, the last page (coming back from the next chapter) needs all of them
+    if (section->currentPage >= section->pageCount) {
+      if (!waitingForLayout) {
+        constexpr int boxMargin = 20;
+        constexpr int boxY = 50;
+        const int boxWidth = renderer.getTextWidth(UI_12_FONT_ID, "Indexing...") + boxMargin * 2;
+        const int boxHeight = renderer.getLineHeight(UI_12_FONT_ID) + boxMargin * 2;
+        const int boxX = (renderer.getScreenWidth() - boxWidth) / 2;
+        renderer.fillRect(boxX, boxY, boxWidth, boxHeight, false);
+        renderer.drawText(UI_12_FONT_ID, boxX + boxMargin, boxY + boxMargin, "Indexing...");
+        renderer.drawRect(boxX + 5, boxY + 5, boxWidth - 10, boxHeight - 10);
+        renderer.displayBuffer();
+        pagesUntilFullRefresh = 0;
+        waitingForLayout = true;
+      }
+      // Check again once the layout task had a turn
+      updateRequired = true;
+      return;
     }
   }
+  waitingForLayout = false;
+
+  if (section->currentPage == UINT16_MAX) {
+    section->currentPage = section->pageCount - 1;
+  } else if (section->currentPage >= section->pageCount && section->pageCount > 0) {
+    // Turned past the last page laid out while the chapter turned out to end there
+    nextPageNumber = 0;
+    currentSpineIndex++;
+    resetSection();
+    return renderScreen();
+  }
 
   renderer.clearScreen();
 
@@ -347,16 +530,22 @@ void EpubReaderActivity::renderScreen() {
   }
 
   {
-    auto p = section->loadPageFromSectionFile();
+    const auto loadStart = millis();
+    auto p = section->loadPage(section->currentPage);
     if (!p) {
       Serial.printf("[%lu] [ERS] Failed to load page from SD - clearing section cache\n", millis());
+      // Layout must not be writing to the file while it is removed
+      stopLayout();
       section->clearCache();
-      section.reset();
+      resetSection();
       return renderScreen();
     }
+    Serial.printf("[%lu] [ERS] Loaded page %d in %lums\n", millis(), section->currentPage, millis() - loadStart);
     const auto start = millis();
-    renderContents(std::move(p), orientedMarginTop, orientedMarginRight, orientedMarginBottom, orientedMarginLeft);
-    Serial.printf("[%lu] [ERS] Rendered page in %dms\n", millis(), millis() - start);
+    const uint32_t fontReadsBefore = CustomEpdFont::getSdReadCount();
+    renderContents(*p, orientedMarginTop, orientedMarginRight, orientedMarginBottom, orientedMarginLeft);
+    Serial.printf("[%lu] [ERS] Rendered page in %dms, %u font reads\n", millis(), millis() - start,
+                  CustomEpdFont::getSdReadCount() - fontReadsBefore);
   }
 
   FsFile f;
@@ -371,11 +560,20 @@ void EpubReaderActivity::renderScreen() {
   }
 }
 
-void EpubReaderActivity::renderContents(std::unique_ptr<Page> page, const int orientedMarginTop,
-                                        const int orientedMarginRight, const int orientedMarginBottom,
-                                        const int orientedMarginLeft) {
-  page->render(renderer, SETTINGS.getReaderFontId(), orientedMarginLeft, orientedMarginTop);
+void EpubReaderActivity::renderContents(const Page& page, const int orientedMarginTop, const int orientedMarginRight,
+                                        const int orientedMarginBottom, const int orientedMarginLeft) {
+  // Capture the placed glyphs so the grayscale planes can be derived without rendering the page again
+  renderer.beginGlyphCapture();
+  page.render(renderer, SETTINGS.getReaderFontId(), orientedMarginLeft, orientedMarginTop);
+  renderer.endGlyphCapture();
   renderStatusBar(orientedMarginRight, orientedMarginBottom, orientedMarginLeft);
+  if (pageTurnStartedAt) {
+    const uint32_t hits = section->getPageCacheHits();
+    const uint32_t loads = hits + section->getPageCacheMisses();
+    Serial.printf("[%lu] [ERS] Page turn to refresh start in %lums, page cache hit rate %u/%u\n", millis(),
+                  millis() - pageTurnStartedAt, hits, loads);
+    pageTurnStartedAt = 0;
+  }
   if (pagesUntilFullRefresh <= 1) {
     renderer.displayBuffer(EInkDisplay::HALF_REFRESH);
     pagesUntilFullRefresh = SETTINGS.getRefreshFrequency();
@@ -384,28 +582,49 @@ void EpubReaderActivity::renderContents(std::unique_ptr<Page> page, const int or
     pagesUntilFullRefresh--;
   }
 
-  // Save bw buffer to reset buffer state after grayscale data sync
-  bool bufferStored = renderer.storeBwBuffer();
+  if (!SETTINGS.textAntiAliasing) {
+    renderer.clearGlyphCapture();
+    return;
+  }
 
-  // grayscale rendering
-  // TODO: Only do this if font supports it
-  if (SETTINGS.textAntiAliasing ){//&& bufferStored) {
-    renderer.clearScreen(0x00);
-    renderer.setRenderMode(GfxRenderer::GRAYSCALE_LSB);
-    page->render(renderer, SETTINGS.getReaderFontId(), orientedMarginLeft, orientedMarginTop);
-    renderer.copyGrayscaleLsbBuffers();
+  if (!renderer.glyphCaptureOverflowed()) {
+    if (renderer.hasCapturedGrayscale()) {
+      // Both gray planes come from the captured glyphs. The frame buffer is used as scratch for them, so redraw the
+      // BW frame afterwards instead of keeping a 48KB copy of it around.
+      renderer.displayCapturedGrayscale();
+      renderer.clearScreen();
+      renderer.drawCapturedGlyphs();
+      renderStatusBar(orientedMarginRight, orientedMarginBottom, orientedMarginLeft);
+      renderer.cleanupGrayscaleWithFrameBuffer();
+    }
+    // Otherwise nothing on this page is anti-aliased (1-bit font) and the BW frame is already final
+    renderer.clearGlyphCapture();
+    return;
+  }
 
-    // Render and copy to MSB buffer
-    renderer.clearScreen(0x00);
-    renderer.setRenderMode(GfxRenderer::GRAYSCALE_MSB);
-    page->render(renderer, SETTINGS.getReaderFontId(), orientedMarginLeft, orientedMarginTop);
-    renderer.copyGrayscaleMsbBuffers();
+  // Too many glyphs to capture: fall back to rendering the page once per plane
+  renderer.clearGlyphCapture();
 
-    // display grayscale part
-    renderer.displayGrayBuffer();
-    renderer.setRenderMode(GfxRenderer::BW);
+  // Save bw buffer to reset buffer state after grayscale data sync
+  if (!renderer.storeBwBuffer()) {
+    return;
   }
 
+  renderer.clearScreen(0x00);
+  renderer.setRenderMode(GfxRenderer::GRAYSCALE_LSB);
+  page.render(renderer, SETTINGS.getReaderFontId(), orientedMarginLeft, orientedMarginTop);
+  renderer.copyGrayscaleLsbBuffers();
+
+  // Render and copy to MSB buffer
+  renderer.clearScreen(0x00);
+  renderer.setRenderMode(GfxRenderer::GRAYSCALE_MSB);
+  page.render(renderer, SETTINGS.getReaderFontId(), orientedMarginLeft, orientedMarginTop);
+  renderer.copyGrayscaleMsbBuffers();
+
+  // display grayscale part
+  renderer.displayGrayBuffer();
+  renderer.setRenderMode(GfxRenderer::BW);
+
   // restore the bw data
   renderer.restoreBwBuffer();
 }
@@ -426,13 +645,16 @@ void EpubReaderActivity::renderStatusBar(const int orientedMarginRight, const in
   int progressTextWidth = 0;
 
   if (showProgress) {
-    // Calculate progress in book
-    const float sectionChapterProg = static_cast<float>(section->currentPage) / section->pageCount;
-    const uint8_t bookProgress = epub->calculateProgress(currentSpineIndex, sectionChapterProg);
-
-    // Right aligned text for progress counter
-    const std::string progress = std::to_string(section->currentPage + 1) + "/" + std::to_string(section->pageCount) +
-                                 "  " + std::to_string(bookProgress) + "%";
+    // Right aligned text for progress counter. While the chapter is still being laid out its page count only grows,
+    // so it is shown as a lower bound and the book progress, which depends on it, is left out until it is known
+    std::string progress = std::to_string(section->currentPage + 1) + "/" + std::to_string(section->pageCount);
+    if (section->isComplete()) {
+      const float sectionChapterProg = static_cast<float>(section->currentPage) / section->pageCount;
+      const uint8_t bookProgress = epub->calculateProgress(currentSpineIndex, sectionChapterProg);
+      progress += "  " + std::to_string(bookProgress) + "%";
+    } else {
+      progress += "+";
+    }
     progressTextWidth = renderer.getTextWidth(SMALL_FONT_ID, progress.c_str());
     renderer.drawText(SMALL_FONT_ID, renderer.getScreenWidth() - orientedMarginRight - progressTextWidth, textY,
                       progress.c_str());
@@ -1,4 +1,5 @@
 #pragma once
+#include <CodepointSet.h>
 #include <Epub.h>
 #include <Epub/Section.h>
 #include <freertos/FreeRTOS.h>
@@ -11,19 +12,42 @@ class EpubReaderActivity final : public ActivityWithSubactivity {
   std::shared_ptr<Epub> epub;
   std::unique_ptr<Section> section = nullptr;
   TaskHandle_t displayTaskHandle = nullptr;
+  // Background layout of the chapter on screen, whose pages show as they are laid out, or of the next chapter. The
+  // task then rewrites the font subset if the book's charset changed, or is started for only that.
+  TaskHandle_t layoutTaskHandle = nullptr;
+  int layoutSpineIndex = -1;  // Chapter the layout task was last started for, -1 to allow a new start or for no chapter
+  bool layoutStopRequested = false;
+  bool layoutFailed = false;      // The chapter on screen could not be laid out
+  bool waitingForLayout = false;  // "Indexing..." is shown until the page to show is laid out
+  int viewportWidth = 0;
+  int viewportHeight = 0;
   SemaphoreHandle_t renderingMutex = nullptr;
   int currentSpineIndex = 0;
   int nextPageNumber = 0;
   int pagesUntilFullRefresh = 0;
   bool updateRequired = false;
+  // When the button for the page being rendered was released, 0 if it was not a page turn
+  unsigned long pageTurnStartedAt = 0;
+  // Characters of the chapters laid out so far, the font subset in the book cache is written from it
+  CodepointSet bookCharset;
+  bool bookCharsetChanged = false;
   const std::function<void()> onGoBack;
   const std::function<void()> onGoHome;
 
   static void taskTrampoline(void* param);
   [[noreturn]] void displayTaskLoop();
+  static void layoutTaskTrampoline(void* param);
+  void layoutTask();
+  void startLayout(int spineIndex);
+  void startPrelayout();
+  void stopLayout();
+  bool takeMutexForLayout();
+  void updateBookSubset();
+  void resetSection();
   void renderScreen();
-  void renderContents(std::unique_ptr<Page> page, int orientedMarginTop, int orientedMarginRight,
-                      int orientedMarginBottom, int orientedMarginLeft);
+  void prefetchAdjacentPages();
+  void renderContents(const Page& page, int orientedMarginTop, int orientedMarginRight, int orientedMarginBottom,
+                      int orientedMarginLeft);
   void renderStatusBar(int orientedMarginRight, int orientedMarginBottom, int orientedMarginLeft) const;
 
  public:
@@ -36,4 +60,5 @@ class EpubReaderActivity final : public ActivityWithSubactivity {
   void onEnter() override;
   void onExit() override;
   void loop() override;
+  bool preventAutoSleep() override { return layoutTaskHandle != nullptr; }
 };
@@ -133,5 +133,5 @@ void EpubReaderChapterSelectionActivity::renderScreen() {
                       tocIndex != selectorIndex);
   }
 
-  renderer.displayBuffer();
+  renderer.displayDirty();
 }
@@ -428,7 +428,7 @@ void FileSelectionActivity::render() const {
   const int fileListStartY = topMenuY + menuTileHeight + 40;
   if (files.empty()) {
     renderer.drawText(UI_10_FONT_ID, 20, fileListStartY, "No books found");
-    renderer.displayBuffer();
+    renderer.displayDirty();
     return;
   }
 
@@ -441,7 +441,8 @@ void FileSelectionActivity::render() const {
   }
   drawDashedLine(renderer, 0, topMenuY+menuTileHeight+20, 480, 10);
 
-  renderer.displayBuffer();
+  // Only the moved selection usually changes, push just that window
+  renderer.displayDirty();
 }
 
 void FileSelectionActivity::drawDashedLine(GfxRenderer& renderer, int x1, int y, int x2, bool isDark) const {
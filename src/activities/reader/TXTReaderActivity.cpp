@@ -1,4 +1,6 @@
 #include "TXTReaderActivity.h"
+#include <CodepointSet.h>
+#include <CustomEpdFont.h>
 #include <FsHelpers.h>
 #include <GfxRenderer.h>
 #include <SDCardManager.h>
@@ -9,6 +11,7 @@
 #include "MappedInputManager.h"
 #include "ScreenComponents.h"
 #include "fontIds.h"
+#include "managers/FontManager.h"
 
 #include <../../lib/Utf8/Utf8.h>  
 #include <Serialization.h> //存进度需要
@@ -31,6 +34,79 @@ constexpr int LINE_HEIGHT = 24;
 // 进度文件专属魔数和版本号
 constexpr uint32_t PROGRESS_MAGIC  = 0x50524F47;  // "PROG" 对应 progress.bin
 constexpr uint8_t  PROGRESS_VERSION = 1;          // 版本号，改格式就+1
+// 没有画面要刷新时，后台任务每次运行的时间片；翻页最多多等一个时间片
+constexpr unsigned long jobSliceMs = 30;
+
+// 每次写入子集时处理的字形数，写一步远小于一个时间片
+constexpr uint32_t subsetGlyphsPerStep = 32;
+
+// 分块扫描全文收集字符集，扫完后保存字符集，再分步写出本书的字体子集。
+// 字符集已有缓存时（例如换了字体）跳过扫描，直接读取字符集重新生成子集
+class BookSubsetJob final : public Job {
+  std::string filepath;
+  std::string cachePath;
+  TxtCharsetScanner scanner;
+  CodepointSet charset;
+  std::unique_ptr<CustomEpdFont::SubsetWriter> writer;
+  bool scan;
+  unsigned long start = 0;
+  bool started = false;
+
+ public:
+  BookSubsetJob(std::string filepath, std::string cachePath, const bool scan)
+      : filepath(std::move(filepath)), cachePath(std::move(cachePath)), scan(scan) {}
+
+  State resume(const Deadline& deadline) override {
+    if (!started) {
+      started = true;
+      start = millis();
+      if (!scan) {
+        if (!charset.load(FontManager::getCharsetPath(cachePath))) {
+          return State::Failed;
+        }
+        return beginWrite();
+      }
+      if (!scanner.begin(filepath)) {
+        Serial.printf("[%lu] [TXT] 扫描字符集失败\n", millis());
+        return State::Failed;
+      }
+    }
+    do {
+      if (writer) {
+        // 子集写完前不挂载，期间字形仍从完整字体读取
+        if (!writer->step(subsetGlyphsPerStep)) {
+          return State::Failed;
+        }
+        if (writer->done()) {
+          return finish();
+        }
+      } else if (!scanner.scanChunk(charset)) {
+        if (!charset.save(FontManager::getCharsetPath(cachePath))) {
+          return State::Failed;
+        }
+        const State state = beginWrite();
+        if (state != State::Running) {
+          return state;
+        }
+      }
+    } while (!deadline.expired());
+    return State::Running;
+  }
+
+ private:
+  State beginWrite() {
+    writer = FontManager::getInstance().beginBookSubsetUpdate(cachePath, charset);
+    return writer ? State::Running : State::Failed;
+  }
+
+  State finish() {
+    writer.reset();
+    FontManager::getInstance().attachBookSubset(cachePath);
+    Serial.printf("[%lu] [TXT] 字体子集生成完成：%u个字符，耗时%lums\n", millis(), static_cast<unsigned>(charset.size()),
+                  millis() - start);
+    return State::Done;
+  }
+};
 }  // namespace
 
 void TXTReaderActivity::taskTrampoline(void* param) {
@@ -75,6 +151,17 @@ void TXTReaderActivity::onEnter() {
   // 加载进度（调用txt->getCachePath()）
   loadProgress();
 
+  // 使用SD卡字体时，优先从缓存目录中的字体子集读取字形
+  if (FontManager::getInstance().hasReaderFont()) {
+    if (!SdMan.exists(FontManager::getCharsetPath(txt->getCachePath()).c_str())) {
+      // 本书还没有字符集缓存：首页先显示，显示任务空闲时再分片扫描全文，不耽误打开书和翻页
+      jobs.add(std::unique_ptr<Job>(new (std::nothrow) BookSubsetJob(txt->getPath(), txt->getCachePath(), true)));
+    } else if (!FontManager::getInstance().attachBookSubset(txt->getCachePath())) {
+      // 字符集已有但子集文件不存在（例如换了字体）：同样放到后台分步按字符集重新生成
+      jobs.add(std::unique_ptr<Job>(new (std::nothrow) BookSubsetJob(txt->getPath(), txt->getCachePath(), false)));
+    }
+  }
+
 
   APP_STATE.openEpubPath = txt->getPath();
   APP_STATE.saveToFile();
@@ -104,6 +191,9 @@ void TXTReaderActivity::onExit() {
   }
   vSemaphoreDelete(renderingMutex);
   renderingMutex = nullptr;
+  // 没扫完的字符集直接丢弃，下次打开重新扫描
+  jobs.clear();
+  FontManager::getInstance().detachBookSubset();
   section.reset();
   txt.reset();
 }
@@ -219,6 +309,10 @@ const bool prevReleased = mappedInput.wasReleased(MappedInputManager::Button::Pa
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       renderScreen();
       xSemaphoreGive(renderingMutex);
+    } else if (!jobs.empty()) {
+      xSemaphoreTake(renderingMutex, portMAX_DELAY);
+      jobs.runFor(jobSliceMs);
+      xSemaphoreGive(renderingMutex);
     }
     vTaskDelay(10 / portTICK_PERIOD_MS);
   }
@@ -290,8 +384,10 @@ void TXTReaderActivity::renderScreen() {
     return renderScreen();
   }
   const auto start = millis();
+  const uint32_t fontReadsBefore = CustomEpdFont::getSdReadCount();
   renderContents(std::move(pageContent), orientedMarginTop, orientedMarginRight, orientedMarginBottom, orientedMarginLeft);
-  Serial.printf("[%lu] [TXT] Rendered page in %dms\n", millis(), millis() - start);
+  Serial.printf("[%lu] [TXT] Rendered page in %dms, %u font reads\n", millis(), millis() - start,
+                CustomEpdFont::getSdReadCount() - fontReadsBefore);
 
 
 }
@@ -325,6 +421,15 @@ void TXTReaderActivity::renderpage(std::unique_ptr<std::string>& pageContent,  /
     // 仅在非灰度渲染时执行savePage（避免重复保存）
     if (!isForGrayscale) {
         savePage();
+
+        // 按字体文件顺序批量预读本页字形，避免逐字随机读SD卡（灰度渲染时缓存已命中，无需重复）
+        std::vector<uint32_t> pageCodepoints;
+        auto text = reinterpret_cast<const unsigned char*>(pageContent->c_str());
+        uint32_t cp;
+        while ((cp = utf8NextCodepoint(&text))) {
+            pageCodepoints.push_back(cp);
+        }
+        renderer.prefetchGlyphs(fontId, pageCodepoints.data(), pageCodepoints.size(), EpdFontFamily::REGULAR);
     }
     
     // 空数组防护
@@ -717,5 +822,3 @@ bool TXTReaderActivity::saveScreenToBMP(const char* filename) {
     Serial.printf("[%lu] [BMP] 变换完成！已保存为 %s\n", millis(), filename);
     return true;
 }
-
-
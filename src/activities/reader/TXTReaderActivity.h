@@ -4,6 +4,7 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 #include <freertos/task.h>
+#include <Jobs.h>
 
 // 修正头文件路径（根据项目实际结构调整，若ActivityWithSubactivity.h在activities目录下）
 #include "../ActivityWithSubactivity.h"
@@ -48,6 +49,8 @@ class TXTReaderActivity final : public ActivityWithSubactivity {
     return std::unique_ptr<std::string>(content);
   }
   bool updateRequired = false;
+  // 显示任务空闲时运行的后台任务（目前只有扫描全文生成字体子集）
+  JobScheduler jobs{millis};
   const std::function<void()> onGoBack;
   const std::function<void()> onGoHome;
   bool saveScreenToBMP(const char* filename); 
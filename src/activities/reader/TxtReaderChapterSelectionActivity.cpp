@@ -268,5 +268,5 @@ void TxtReaderChapterSelectionActivity::renderScreen() {
       //Serial.printf("[%lu] [TRC] 查看为啥不匹配：i:%d,selectorIndex: %d \n", millis(),i,selectorIndex);
   }
 
-  renderer.displayBuffer();
+  renderer.displayDirty();
 }
\ No newline at end of file
@@ -138,5 +138,5 @@ void XtcReaderChapterSelectionActivity::renderScreen() {
       //renderer.drawText(UI_10_FONT_ID, 20, drawY, title, i!= selectorIndex); // ✅ 核心修复：选中态正常，必加！
   }
 
-  renderer.displayBuffer();
+  renderer.displayDirty();
 }
\ No newline at end of file
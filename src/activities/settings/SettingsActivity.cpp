@@ -355,6 +355,6 @@ void SettingsActivity::render() const {
   const auto labels = mappedInput.mapLabels("保存并退出", "切换", "", "");
   renderer.drawButtonHints(UI_10_FONT_ID, labels.btn1, labels.btn2, labels.btn3, labels.btn4);
 
-  // Always use standard refresh for settings screen
-  renderer.displayBuffer();
+  // Selection moves only touch a couple of rows, push just the changed window
+  renderer.displayDirty();
 }
\ No newline at end of file
@@ -279,8 +279,9 @@ void setup() {
   Serial.printf("[%lu] [DBG] setupDisplayAndFonts done\n", millis());
   Serial.flush();
 
+  const unsigned long fontLoadStart = millis();
   EpdFontLoader::loadFontsFromSd(renderer);
-  Serial.printf("[%lu] [DBG] loadFontsFromSd done\n", millis());
+  Serial.printf("[%lu] [DBG] loadFontsFromSd done in %lu ms\n", millis(), millis() - fontLoadStart);
   Serial.flush();
 
   exitActivity();
@@ -3,9 +3,13 @@
 #include <GfxRenderer.h>  // for EpdFontData usage validation if needed
 #include <HardwareSerial.h>
 #include <SDCardManager.h>
+#include <Serialization.h>
 
 #include <algorithm>
+#include <cctype>
+#include <cstring>
 
+#include "CodepointSet.h"
 #include "CustomEpdFont.h"
 
 FontManager& FontManager::getInstance() {
@@ -21,93 +25,87 @@ FontManager::~FontManager() {
   }
 }
 
-const std::vector<std::string>& FontManager::getAvailableFamilies() {
-  if (!scanned) {
-    scanFonts();
+namespace {
+constexpr char FONT_DIR[] = "/fonts";
+constexpr char FONT_INDEX_FILE[] = "/.crosspoint/fonts.idx";
+constexpr uint32_t FONT_INDEX_MAGIC = 0x58444946;  // "FIDX"
+constexpr uint8_t FONT_INDEX_VERSION = 2;
+
+bool endsWith(const std::string& s, const char* suffix) {
+  const size_t len = strlen(suffix);
+  return s.size() >= len && s.compare(s.size() - len, len, suffix) == 0;
+}
+
+// FNV-1a
+uint32_t fingerprintAdd(uint32_t hash, const void* data, const size_t len) {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < len; i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
   }
-  return availableFamilies;
+  return hash;
 }
 
-void FontManager::scanFonts() {
-  Serial.println("[FM] Scanning fonts...");
-  availableFamilies.clear();
-  scanned = true;
+// Expected format: Family-Style-Size.epdfont or Family_Size.epdfont, or just Family.epdfont (V1 single file). The
+// family is everything before the first '-', or the first '_' if there is no '-'.
+void parseFontFileName(FontFileInfo& info) {
+  const std::string name = info.fileName.substr(0, info.fileName.size() - 8);
+  size_t pos = name.find('-');
+  if (pos == std::string::npos) {
+    pos = name.find('_');
+  }
+  info.family = name.substr(0, pos);
+}
+
+// Lists the font files in /fonts. The fingerprint covers the directory's modify time, the entry count and the name,
+// size and modify time of every font file: FAT does not always update the directory time when a file is replaced.
+bool readFontDir(std::vector<std::string>& fileNames, uint32_t& fingerprint) {
+  fileNames.clear();
+  fingerprint = 2166136261u;
 
   FsFile fontDir;
-  if (!SdMan.openFileForRead("FontScan", "/fonts", fontDir)) {
+  if (!SdMan.openFileForRead("FontScan", FONT_DIR, fontDir)) {
     Serial.println("[FM] Failed to open /fonts directory");
-    // Even if failed, we proceed to sort empty list to avoid crashes
-    return;
+    return false;
   }
-
   if (!fontDir.isDirectory()) {
     Serial.println("[FM] /fonts is not a directory");
     fontDir.close();
-    return;
+    return false;
   }
 
-  Serial.println("[FM] /fonts opened. Iterating files...");
+  uint16_t date = 0, time = 0;
+  fontDir.getModifyDateTime(&date, &time);
+  fingerprint = fingerprintAdd(fingerprint, &date, sizeof(date));
+  fingerprint = fingerprintAdd(fingerprint, &time, sizeof(time));
+
+  uint32_t entryCount = 0;
   FsFile file;
   while (file.openNext(&fontDir, O_READ)) {
+    entryCount++;
     if (!file.isDirectory()) {
       char filename[128];
       file.getName(filename, sizeof(filename));
-      Serial.printf("[FM] Checking: %s\n", filename);
-
-      String name = String(filename);
-      if (name.endsWith(".epdfont")) {
-        // Expected format: Family-Style-Size.epdfont or Family_Size.epdfont
-        // Or just Family.epdfont (V1 single file)
-
-        String family;
-        int separator = name.indexOf('-');
-        if (separator < 0) separator = name.indexOf('_');
-
-        if (separator > 0) {
-          family = name.substring(0, separator);
-        } else {
-          // No separator, take the whole name (minus .epdfont)
-          family = name.substring(0, name.length() - 8);
-        }
-
-        if (family.length() > 0) {
-          if (std::find(availableFamilies.begin(), availableFamilies.end(), family.c_str()) ==
-              availableFamilies.end()) {
-            availableFamilies.push_back(family.c_str());
-            Serial.printf("[FM] Added family: %s\n", family.c_str());
-          }
-        }
+      std::string name = filename;
+      if (endsWith(name, ".epdfont") || endsWith(name, ".epdhot")) {
+        const uint32_t size = file.fileSize();
+        file.getModifyDateTime(&date, &time);
+        fingerprint = fingerprintAdd(fingerprint, name.data(), name.size() + 1);
+        fingerprint = fingerprintAdd(fingerprint, &size, sizeof(size));
+        fingerprint = fingerprintAdd(fingerprint, &date, sizeof(date));
+        fingerprint = fingerprintAdd(fingerprint, &time, sizeof(time));
+        fileNames.push_back(std::move(name));
       }
     }
     file.close();
   }
   fontDir.close();
 
-  std::sort(availableFamilies.begin(), availableFamilies.end());
-  Serial.printf("[FM] Scan complete. Found %d families\n", availableFamilies.size());
+  fingerprint = fingerprintAdd(fingerprint, &entryCount, sizeof(entryCount));
+  return true;
 }
 
-struct EpdfHeader {
-  char magic[4];
-  uint32_t intervalCount;
-  uint32_t totalGlyphCount;
-  uint8_t advanceY;
-  int32_t ascender;
-  int32_t descender;
-  uint8_t is2Bit;
-};
-
-// Helper to load a single font file
-CustomEpdFont* loadFontFile(const String& path) {
-  Serial.printf("[FontMgr] Loading file: %s\n", path.c_str());
-  Serial.flush();
-  FsFile f;
-  if (!SdMan.openFileForRead("FontLoading", path.c_str(), f)) {
-    Serial.printf("[FontMgr] Failed to open: %s\n", path.c_str());
-    Serial.flush();
-    return nullptr;
-  }
-
+// Reads the header of an .epdfont file into the header fields of info
+bool readFontHeader(FsFile& f, const char* path, FontFileInfo& info) {
   // Read custom header format (detected from file dump)
   // 0: Magic (4)
   // 4: IntervalCount (4)
@@ -124,18 +122,16 @@ CustomEpdFont* loadFontFile(const String& path) {
 
   uint32_t buf[12];  // 48 bytes
   if (f.read(buf, 48) != 48) {
-    Serial.printf("[FontMgr] Header read failed for %s\n", path.c_str());
-    f.close();
-    return nullptr;
+    Serial.printf("[FontMgr] Header read failed for %s\n", path);
+    return false;
   }
 
   if (strncmp((char*)&buf[0], "EPDF", 4) != 0) {
-    Serial.printf("[FontMgr] Invalid magic for %s\n", path.c_str());
-    f.close();
-    return nullptr;
+    Serial.printf("[FontMgr] Invalid magic for %s\n", path);
+    return false;
   }
 
-  Serial.printf("[FontMgr] Header Dump %s: ", path.c_str());
+  Serial.printf("[FontMgr] Header Dump %s: ", path);
   for (int i = 0; i < 12; i++) Serial.printf("%08X ", buf[i]);
   Serial.println();
 
@@ -146,6 +142,9 @@ CustomEpdFont* loadFontFile(const String& path) {
    *   Offset 20 (buf[5]) is OffsetIntervals. It matches header size = 32.
    *   Offset 4 (buf[1]) low 16 bits is Version = 1.
    *
+   * V2:
+   *   Same layout as V1 with Version = 2. Glyph bitmaps may be stored as pixel runs.
+   *
    * V0:
    *   Offset 36 (buf[9]) is OffsetIntervals. It matches header size = 48.
    */
@@ -156,6 +155,10 @@ CustomEpdFont* loadFontFile(const String& path) {
   if (buf[5] == 32 && (buf[1] & 0xFFFF) == 1) {
     version = 1;
   }
+  // Check for V2
+  else if (buf[5] == 32 && (buf[1] & 0xFFFF) == 2) {
+    version = 2;
+  }
   // Check for V0
   else if (buf[9] == 48) {
     version = 0;
@@ -166,73 +169,64 @@ CustomEpdFont* loadFontFile(const String& path) {
     version = 0;
   }
 
-  uint32_t intervalCount, fileSize, glyphCount, offsetIntervals, offsetGlyphs, offsetBitmaps;
-  uint8_t height, advanceY;
-  int32_t ascender, descender;
-  bool is2Bit;
-
-  if (version == 1) {
-    // V1 Parsing
+  if (version == 1 || version == 2) {
+    // V1 / V2 Parsing (same header layout)
     uint8_t* b8 = (uint8_t*)buf;
 
-    is2Bit = (b8[6] != 0);
-    advanceY = b8[8];
-    ascender = (int8_t)b8[9];
-    descender = (int8_t)b8[10];
-
-    intervalCount = b8[12] | (b8[13] << 8) | (b8[14] << 16) | (b8[15] << 24);
-    glyphCount = b8[16] | (b8[17] << 8) | (b8[18] << 16) | (b8[19] << 24);
-    offsetIntervals = b8[20] | (b8[21] << 8) | (b8[22] << 16) | (b8[23] << 24);
-    offsetGlyphs = b8[24] | (b8[25] << 8) | (b8[26] << 16) | (b8[27] << 24);
-    offsetBitmaps = b8[28] | (b8[29] << 8) | (b8[30] << 16) | (b8[31] << 24);
-
-    height = advanceY;
-    fileSize = 0;  // Unknown
+    info.is2Bit = (b8[6] != 0);
+    info.advanceY = b8[8];
+    info.ascender = (int8_t)b8[9];
+    info.descender = (int8_t)b8[10];
 
+    info.intervalCount = b8[12] | (b8[13] << 8) | (b8[14] << 16) | (b8[15] << 24);
+    info.offsetIntervals = b8[20] | (b8[21] << 8) | (b8[22] << 16) | (b8[23] << 24);
+    info.offsetGlyphs = b8[24] | (b8[25] << 8) | (b8[26] << 16) | (b8[27] << 24);
+    info.offsetBitmaps = b8[28] | (b8[29] << 8) | (b8[30] << 16) | (b8[31] << 24);
   } else if (version == 0) {
     // V0 Parsing
     // We already read 48 bytes into buf
-    intervalCount = buf[1];
-    fileSize = buf[2];
-    height = buf[3];
-    glyphCount = buf[4];
-    ascender = (int32_t)buf[5];
-    descender = (int32_t)buf[7];
-    is2Bit = (buf[8] != 0);
-
-    offsetIntervals = buf[9];
-    offsetGlyphs = buf[10];
-    offsetBitmaps = buf[11];
+    info.intervalCount = buf[1];
+    info.advanceY = (uint8_t)buf[3];
+    info.ascender = (int32_t)buf[5];
+    info.descender = (int32_t)buf[7];
+    info.is2Bit = (buf[8] != 0);
+
+    info.offsetIntervals = buf[9];
+    info.offsetGlyphs = buf[10];
+    info.offsetBitmaps = buf[11];
   } else {
-    Serial.printf("[FontMgr] Unknown version for %s\n", path.c_str());
-    f.close();
-    return nullptr;
+    Serial.printf("[FontMgr] Unknown version for %s\n", path);
+    return false;
   }
+  info.version = version;
 
   // Validation
   // For V1, we trust offsets generated by the tool
-  if (offsetIntervals == 0 || offsetGlyphs == 0 || offsetBitmaps == 0) {
+  if (info.offsetIntervals == 0 || info.offsetGlyphs == 0 || info.offsetBitmaps == 0) {
     Serial.println("[FontMgr] Invalid offsets in header");
-    f.close();
-    return nullptr;
+    return false;
   }
+  return true;
+}
 
+// Creates the font from its parsed header, only the intervals are read from the file. Closes f.
+CustomEpdFont* createFont(FsFile& f, const char* path, const FontFileInfo& info) {
   // We need to load intervals into RAM
-  EpdUnicodeInterval* intervals = new (std::nothrow) EpdUnicodeInterval[intervalCount];
+  EpdUnicodeInterval* intervals = new (std::nothrow) EpdUnicodeInterval[info.intervalCount];
   if (!intervals) {
-    Serial.printf("[FontMgr] Failed to allocate intervals: %d\n", intervalCount);
+    Serial.printf("[FontMgr] Failed to allocate intervals: %d\n", info.intervalCount);
     f.close();
     return nullptr;
   }
 
-  if (!f.seekSet(offsetIntervals)) {
+  if (!f.seekSet(info.offsetIntervals)) {
     Serial.println("[FontMgr] Failed to seek to intervals");
     delete[] intervals;
     f.close();
     return nullptr;
   }
 
-  f.read((uint8_t*)intervals, intervalCount * sizeof(EpdUnicodeInterval));
+  f.read((uint8_t*)intervals, info.intervalCount * sizeof(EpdUnicodeInterval));
 
   f.close();
 
@@ -243,50 +237,258 @@ CustomEpdFont* loadFontFile(const String& path) {
     delete[] intervals;
     return nullptr;
   }
-  fontData->intervalCount = intervalCount;
+  fontData->intervalCount = info.intervalCount;
   fontData->intervals = intervals;
   fontData->glyph = nullptr;
-  fontData->advanceY = (uint8_t)height;
-  fontData->ascender = ascender;
-  fontData->descender = descender;
-  fontData->is2Bit = is2Bit;
+  fontData->advanceY = info.advanceY;
+  fontData->ascender = info.ascender;
+  fontData->descender = info.descender;
+  fontData->is2Bit = info.is2Bit;
   fontData->bitmap = nullptr;
+  // Direct glyph lookup for the BMP, CJK fonts would otherwise search thousands of intervals per character
+  fontData->pageTable = EpdFont::buildPageTable(fontData);
+  if (!fontData->pageTable) {
+    Serial.printf("[FontMgr] No glyph page table for %s, using interval search\n", path);
+  }
 
-  return new CustomEpdFont(path, fontData, offsetIntervals, offsetGlyphs, offsetBitmaps, version);
+  return new CustomEpdFont(path, fontData, info.offsetIntervals, info.offsetGlyphs, info.offsetBitmaps, info.version);
 }
+}  // namespace
 
-EpdFontFamily* FontManager::getCustomFontFamily(const std::string& familyName, int fontSize) {
-  if (loadedFonts[familyName][fontSize]) {
-    return loadedFonts[familyName][fontSize];
+const std::vector<std::string>& FontManager::getAvailableFamilies() {
+  loadFontIndex();
+  return availableFamilies;
+}
+
+void FontManager::scanFonts() {
+  Serial.println("[FM] Scanning fonts...");
+  scanned = true;
+
+  std::vector<std::string> fileNames;
+  uint32_t fingerprint;
+  if (!readFontDir(fileNames, fingerprint)) {
+    // Even if failed, we proceed with an empty list to avoid crashes
+    setFontFiles({});
+    return;
   }
 
-  String basePath = "/fonts/" + String(familyName.c_str()) + "-";
-  String sizeStr = String(fontSize);
+  std::vector<FontFileInfo> files;
+  for (const auto& name : fileNames) {
+    if (!endsWith(name, ".epdfont")) {
+      continue;
+    }
+    Serial.printf("[FM] Checking: %s\n", name.c_str());
+
+    FontFileInfo info;
+    info.fileName = name;
+    const std::string path = std::string(FONT_DIR) + "/" + name;
+    FsFile f;
+    if (!SdMan.openFileForRead("FontScan", path, f)) {
+      continue;
+    }
+    const bool valid = readFontHeader(f, path.c_str(), info);
+    f.close();
+    if (!valid) {
+      continue;
+    }
 
-  CustomEpdFont* regular = loadFontFile(basePath + "Regular-" + sizeStr + ".epdfont");
+    parseFontFileName(info);
+    const std::string hotPackName = name.substr(0, name.size() - 8) + ".epdhot";
+    info.hasHotPack = std::find(fileNames.begin(), fileNames.end(), hotPackName) != fileNames.end();
+    files.push_back(std::move(info));
+  }
 
-  if (!regular) regular = loadFontFile("/fonts/" + String(familyName.c_str()) + "_Regular_" + sizeStr + ".epdfont");
-  if (!regular) regular = loadFontFile("/fonts/" + String(familyName.c_str()) + "_" + sizeStr + ".epdfont");
-  if (!regular) regular = loadFontFile("/fonts/" + String(familyName.c_str()) + ".epdfont");
-  if (!regular) regular = loadFontFile("/fonts/" + String(familyName.c_str()) + "-Regular.epdfont");
-  if (!regular) regular = loadFontFile("/fonts/" + String(familyName.c_str()) + "_Regular.epdfont");
-  if (!regular) regular = loadFontFile("/fonts/" + String(familyName.c_str()) + "-" + sizeStr + ".epdfont");
+  setFontFiles(std::move(files));
+  writeFontIndex(fingerprint);
+  Serial.printf("[FM] Scan complete. Found %d families\n", availableFamilies.size());
+}
 
-  CustomEpdFont* bold = loadFontFile(basePath + "Bold-" + sizeStr + ".epdfont");
-  if (!bold) bold = loadFontFile("/fonts/" + String(familyName.c_str()) + "_Bold_" + sizeStr + ".epdfont");
-  if (!bold) bold = loadFontFile("/fonts/" + String(familyName.c_str()) + "-Bold.epdfont");
-  if (!bold) bold = loadFontFile("/fonts/" + String(familyName.c_str()) + "_Bold.epdfont");
+void FontManager::loadFontIndex() {
+  if (scanned) {
+    return;
+  }
 
-  CustomEpdFont* italic = loadFontFile(basePath + "Italic-" + sizeStr + ".epdfont");
-  if (!italic) italic = loadFontFile("/fonts/" + String(familyName.c_str()) + "_Italic_" + sizeStr + ".epdfont");
-  if (!italic) italic = loadFontFile("/fonts/" + String(familyName.c_str()) + "-Italic.epdfont");
-  if (!italic) italic = loadFontFile("/fonts/" + String(familyName.c_str()) + "_Italic.epdfont");
+  std::vector<std::string> fileNames;
+  uint32_t fingerprint;
+  if (!readFontDir(fileNames, fingerprint)) {
+    scanned = true;
+    setFontFiles({});
+    return;
+  }
+  if (readFontIndex(fingerprint)) {
+    scanned = true;
+    Serial.printf("[%lu] [FM] Font index loaded: %d files, %d families\n", millis(), fontFiles.size(),
+                  availableFamilies.size());
+    return;
+  }
+  scanFonts();
+}
 
-  CustomEpdFont* boldItalic = loadFontFile(basePath + "BoldItalic-" + sizeStr + ".epdfont");
-  if (!boldItalic)
-    boldItalic = loadFontFile("/fonts/" + String(familyName.c_str()) + "_BoldItalic_" + sizeStr + ".epdfont");
-  if (!boldItalic) boldItalic = loadFontFile("/fonts/" + String(familyName.c_str()) + "-BoldItalic.epdfont");
-  if (!boldItalic) boldItalic = loadFontFile("/fonts/" + String(familyName.c_str()) + "_BoldItalic.epdfont");
+// File layout: magic, version, fingerprint, file count, then per file its name, family, hot pack flag
+// and header fields, then the magic again
+bool FontManager::readFontIndex(const uint32_t fingerprint) {
+  FsFile file;
+  if (!SdMan.exists(FONT_INDEX_FILE) || !SdMan.openFileForRead("FM", FONT_INDEX_FILE, file)) {
+    return false;
+  }
+
+  uint32_t magic = 0, storedFingerprint = 0, count = 0;
+  uint8_t version = 0;
+  serialization::readPod(file, magic);
+  serialization::readPod(file, version);
+  serialization::readPod(file, storedFingerprint);
+  serialization::readPod(file, count);
+  if (magic != FONT_INDEX_MAGIC || version != FONT_INDEX_VERSION || storedFingerprint != fingerprint || count > 256) {
+    file.close();
+    Serial.printf("[%lu] [FM] Font index is stale\n", millis());
+    return false;
+  }
+
+  std::vector<FontFileInfo> files(count);
+  for (auto& info : files) {
+    serialization::readString(file, info.fileName);
+    serialization::readString(file, info.family);
+    serialization::readPod(file, info.hasHotPack);
+    serialization::readPod(file, info.version);
+    serialization::readPod(file, info.is2Bit);
+    serialization::readPod(file, info.advanceY);
+    serialization::readPod(file, info.ascender);
+    serialization::readPod(file, info.descender);
+    serialization::readPod(file, info.intervalCount);
+    serialization::readPod(file, info.offsetIntervals);
+    serialization::readPod(file, info.offsetGlyphs);
+    serialization::readPod(file, info.offsetBitmaps);
+  }
+  // The magic is repeated at the end, a truncated index does not have it
+  magic = 0;
+  serialization::readPod(file, magic);
+  file.close();
+  const bool ok = magic == FONT_INDEX_MAGIC;
+  if (ok) {
+    setFontFiles(std::move(files));
+  }
+  return ok;
+}
+
+void FontManager::writeFontIndex(const uint32_t fingerprint) const {
+  FsFile file;
+  SdMan.mkdir("/.crosspoint");
+  if (!SdMan.openFileForWrite("FM", FONT_INDEX_FILE, file)) {
+    return;
+  }
+  serialization::writePod(file, FONT_INDEX_MAGIC);
+  serialization::writePod(file, FONT_INDEX_VERSION);
+  serialization::writePod(file, fingerprint);
+  serialization::writePod(file, static_cast<uint32_t>(fontFiles.size()));
+  for (const auto& info : fontFiles) {
+    serialization::writeString(file, info.fileName);
+    serialization::writeString(file, info.family);
+    serialization::writePod(file, info.hasHotPack);
+    serialization::writePod(file, info.version);
+    serialization::writePod(file, info.is2Bit);
+    serialization::writePod(file, info.advanceY);
+    serialization::writePod(file, info.ascender);
+    serialization::writePod(file, info.descender);
+    serialization::writePod(file, info.intervalCount);
+    serialization::writePod(file, info.offsetIntervals);
+    serialization::writePod(file, info.offsetGlyphs);
+    serialization::writePod(file, info.offsetBitmaps);
+  }
+  serialization::writePod(file, FONT_INDEX_MAGIC);
+  file.close();
+}
+
+void FontManager::setFontFiles(std::vector<FontFileInfo> files) {
+  fontFiles = std::move(files);
+  availableFamilies.clear();
+  for (const auto& info : fontFiles) {
+    if (!info.family.empty() &&
+        std::find(availableFamilies.begin(), availableFamilies.end(), info.family) == availableFamilies.end()) {
+      availableFamilies.push_back(info.family);
+    }
+  }
+  std::sort(availableFamilies.begin(), availableFamilies.end());
+}
+
+const FontFileInfo* FontManager::findFontFile(const std::string& fileName) const {
+  for (const auto& info : fontFiles) {
+    if (info.fileName == fileName) {
+      return &info;
+    }
+  }
+  return nullptr;
+}
+
+// Helper to load a single font file
+CustomEpdFont* loadFontFile(const String& path) {
+  Serial.printf("[FontMgr] Loading file: %s\n", path.c_str());
+  Serial.flush();
+  FsFile f;
+  if (!SdMan.openFileForRead("FontLoading", path.c_str(), f)) {
+    Serial.printf("[FontMgr] Failed to open: %s\n", path.c_str());
+    Serial.flush();
+    return nullptr;
+  }
+
+  FontFileInfo info;
+  if (!readFontHeader(f, path.c_str(), info)) {
+    f.close();
+    return nullptr;
+  }
+  return createFont(f, path.c_str(), info);
+}
+
+// Loads the first file of a style the index has, trying the same names in the same order as before the index:
+// Family-Style-Size, Family_Style_Size, then (regular only) Family_Size and Family, then Family-Style and
+// Family_Style, and last (regular only) Family-Size
+CustomEpdFont* FontManager::loadFontStyle(const std::string& familyName, const int style, const int fontSize) const {
+  static constexpr const char* styleNames[] = {"Regular", "Bold", "Italic", "BoldItalic"};
+  const std::string styleName = styleNames[style];
+  const std::string size = std::to_string(fontSize);
+  const bool regular = style == EpdFontFamily::REGULAR;
+  const std::string candidates[] = {
+      familyName + "-" + styleName + "-" + size,
+      familyName + "_" + styleName + "_" + size,
+      regular ? familyName + "_" + size : "",
+      regular ? familyName : "",
+      familyName + "-" + styleName,
+      familyName + "_" + styleName,
+      regular ? familyName + "-" + size : "",
+  };
+  const FontFileInfo* info = nullptr;
+  for (const auto& candidate : candidates) {
+    if (!candidate.empty() && (info = findFontFile(candidate + ".epdfont"))) {
+      break;
+    }
+  }
+  if (!info) {
+    return nullptr;
+  }
+
+  const std::string path = std::string(FONT_DIR) + "/" + info->fileName;
+  Serial.printf("[FontMgr] Loading file: %s\n", path.c_str());
+  FsFile f;
+  if (!SdMan.openFileForRead("FontLoading", path, f)) {
+    return nullptr;
+  }
+  CustomEpdFont* font = createFont(f, path.c_str(), *info);
+  // Body text is set in the regular style, keep its most frequent glyphs resident if the font has a hot pack
+  if (font && info->hasHotPack && style == EpdFontFamily::REGULAR) {
+    font->loadHotPack();
+  }
+  return font;
+}
+
+EpdFontFamily* FontManager::getCustomFontFamily(const std::string& familyName, int fontSize) {
+  if (loadedFonts[familyName][fontSize]) {
+    return loadedFonts[familyName][fontSize];
+  }
+
+  loadFontIndex();
+  CustomEpdFont* regular = loadFontStyle(familyName, EpdFontFamily::REGULAR, fontSize);
+  CustomEpdFont* bold = loadFontStyle(familyName, EpdFontFamily::BOLD, fontSize);
+  CustomEpdFont* italic = loadFontStyle(familyName, EpdFontFamily::ITALIC, fontSize);
+  CustomEpdFont* boldItalic = loadFontStyle(familyName, EpdFontFamily::BOLD_ITALIC, fontSize);
 
   if (!regular) {
     if (bold) regular = bold;
@@ -295,8 +497,73 @@ EpdFontFamily* FontManager::getCustomFontFamily(const std::string& familyName, i
   if (regular) {
     EpdFontFamily* family = new EpdFontFamily(regular, bold, italic, boldItalic);
     loadedFonts[familyName][fontSize] = family;
+    regularFonts[familyName][fontSize] = regular;
     return family;
   }
 
   return nullptr;
 }
+
+void FontManager::setReaderFont(const std::string& familyName, const int fontSize) {
+  CustomEpdFont* font = nullptr;
+  if (!familyName.empty()) {
+    const auto family = regularFonts.find(familyName);
+    if (family != regularFonts.end()) {
+      const auto size = family->second.find(fontSize);
+      if (size != family->second.end()) {
+        font = size->second;
+      }
+    }
+  }
+
+  if (font != readerFont) {
+    detachBookSubset();
+  }
+  readerFont = font;
+  readerFontKey = font ? familyName + "-" + std::to_string(fontSize) : "";
+}
+
+std::string FontManager::getSubsetPath(const std::string& cachePath) const {
+  return cachePath + "/font_" + readerFontKey + ".epdfont";
+}
+
+bool FontManager::attachBookSubset(const std::string& cachePath) {
+  if (!readerFont) {
+    return false;
+  }
+
+  const std::string subsetPath = getSubsetPath(cachePath);
+  if (!SdMan.exists(subsetPath.c_str())) {
+    return false;
+  }
+
+  CustomEpdFont* subset = loadFontFile(subsetPath.c_str());
+  if (!subset) {
+    return false;
+  }
+  readerFont->attachSubset(subset);
+  Serial.printf("[%lu] [FM] Attached book subset %s\n", millis(), subsetPath.c_str());
+  return true;
+}
+
+std::unique_ptr<CustomEpdFont::SubsetWriter> FontManager::beginBookSubsetUpdate(const std::string& cachePath,
+                                                                                const CodepointSet& charset) {
+  if (!readerFont) {
+    return nullptr;
+  }
+
+  // The subset file is about to be rewritten, stop reading from it first
+  readerFont->attachSubset(nullptr);
+  std::unique_ptr<CustomEpdFont::SubsetWriter> writer(
+      new (std::nothrow) CustomEpdFont::SubsetWriter(*readerFont, getSubsetPath(cachePath).c_str()));
+  if (!writer || !writer->begin(charset)) {
+    return nullptr;
+  }
+  return writer;
+}
+
+void FontManager::detachBookSubset() {
+  if (readerFont && readerFont->hasSubset()) {
+    readerFont->attachSubset(nullptr);
+  }
+}
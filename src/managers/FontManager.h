@@ -1,16 +1,35 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "CustomEpdFont.h"
 #include "EpdFontFamily.h"
 
+// Entry of the font index: what the file name says about a font in /fonts plus the header fields needed to load it
+struct FontFileInfo {
+  std::string fileName;
+  std::string family;
+  bool hasHotPack = false;
+
+  uint8_t version = 0;
+  bool is2Bit = false;
+  uint8_t advanceY = 0;
+  int32_t ascender = 0;
+  int32_t descender = 0;
+  uint32_t intervalCount = 0;
+  uint32_t offsetIntervals = 0;
+  uint32_t offsetGlyphs = 0;
+  uint32_t offsetBitmaps = 0;
+};
+
 class FontManager {
  public:
   static FontManager& getInstance();
 
-  // Scan SD card for fonts
+  // Scan SD card for fonts and rewrite the font index
   void scanFonts();
 
   // Get list of available font family names
@@ -19,13 +38,45 @@ class FontManager {
   // Load a specific family and size (returns pointer to cached family or new one)
   EpdFontFamily* getCustomFontFamily(const std::string& familyName, int fontSize);
 
+  // Custom family and size the reader text is set in, empty name if a builtin font is used
+  void setReaderFont(const std::string& familyName, int fontSize);
+  bool hasReaderFont() const { return readerFont != nullptr; }
+
+  // Per-book subset of the reader font, kept in the book's cache directory next to the charset it was written from.
+  // Glyphs in the subset are looked up in a small dense file instead of the full font.
+  static std::string getCharsetPath(const std::string& cachePath) { return cachePath + "/charset.bin"; }
+  bool attachBookSubset(const std::string& cachePath);
+  // Detaches the book's subset and starts rewriting it from charset. Step the writer until it is done, then attach the
+  // subset again; the reader font must not change meanwhile. nullptr if there is nothing to write.
+  std::unique_ptr<CustomEpdFont::SubsetWriter> beginBookSubsetUpdate(const std::string& cachePath,
+                                                                     const CodepointSet& charset);
+  void detachBookSubset();
+
  private:
   FontManager() = default;
   ~FontManager();
 
   std::vector<std::string> availableFamilies;
+  std::vector<FontFileInfo> fontFiles;
   bool scanned = false;
 
   // Map: FamilyName -> Size -> EpdFontFamily*
   std::map<std::string, std::map<int, EpdFontFamily*>> loadedFonts;
+  // Map: FamilyName -> Size -> regular style of the loaded family
+  std::map<std::string, std::map<int, CustomEpdFont*>> regularFonts;
+
+  CustomEpdFont* readerFont = nullptr;
+  std::string readerFontKey;
+
+  std::string getSubsetPath(const std::string& cachePath) const;
+
+  // The font index in the cache directory lets boot load a family without probing every possible file name or reading
+  // font headers. It is keyed on a fingerprint of the /fonts listing and rebuilt when fonts are added, removed or
+  // replaced.
+  void loadFontIndex();
+  bool readFontIndex(uint32_t fingerprint);
+  void writeFontIndex(uint32_t fingerprint) const;
+  void setFontFiles(std::vector<FontFileInfo> files);
+  const FontFileInfo* findFontFile(const std::string& fileName) const;
+  CustomEpdFont* loadFontStyle(const std::string& familyName, int style, int fontSize) const;
 };
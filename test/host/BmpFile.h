@@ -0,0 +1,59 @@
+#pragma once
+
+#include <SDCardManager.h>
+
+#include <cstdint>
+#include <vector>
+
+// Writes an uncompressed 1 or 2 bpp grayscale BMP for Bitmap to read. values holds one 2-bit level per pixel, top row
+// first, 0 black to 3 white as Bitmap::readNextRow returns them; a 1 bpp image only has levels 0 and 3.
+inline bool writeBmp(const char* path, const int width, const int height, const int bpp,
+                     const std::vector<uint8_t>& values, const bool topDown) {
+  const int colors = 1 << bpp;
+  const int rowBytes = (width * bpp + 31) / 32 * 4;
+  const uint32_t dataOffset = 14 + 40 + colors * 4;
+  std::vector<uint8_t> bmp;
+  auto le16 = [&](const uint32_t v) {
+    bmp.push_back(v);
+    bmp.push_back(v >> 8);
+  };
+  auto le32 = [&](const uint32_t v) {
+    le16(v);
+    le16(v >> 16);
+  };
+
+  bmp.push_back('B');
+  bmp.push_back('M');
+  le32(dataOffset + rowBytes * height);
+  le32(0);
+  le32(dataOffset);
+  le32(40);
+  le32(width);
+  le32(topDown ? -height : height);
+  le16(1);
+  le16(bpp);
+  le32(0);  // BI_RGB
+  le32(0);
+  le32(2835);
+  le32(2835);
+  le32(colors);
+  le32(0);
+  for (int i = 0; i < colors; i++) {
+    // Gray levels whose luminance >> 6 is the palette index (1 bpp: black and white)
+    const uint8_t gray = bpp == 1 ? i * 255 : i * 85;
+    bmp.insert(bmp.end(), {gray, gray, gray, 0});
+  }
+  for (int row = 0; row < height; row++) {
+    const int y = topDown ? row : height - 1 - row;
+    std::vector<uint8_t> bytes(rowBytes, 0);
+    for (int x = 0; x < width; x++) {
+      const uint8_t level = values[y * width + x];
+      const uint8_t index = bpp == 1 ? level == 3 : level;
+      bytes[x * bpp / 8] |= index << (8 - bpp - x * bpp % 8);
+    }
+    bmp.insert(bmp.end(), bytes.begin(), bytes.end());
+  }
+
+  FsFile file;
+  return SdMan.openFileForWrite("TST", path, file) && file.write(bmp.data(), bmp.size()) == bmp.size();
+}
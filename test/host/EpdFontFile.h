@@ -0,0 +1,58 @@
+#pragma once
+
+#include <CustomEpdFont.h>
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// An .epdfont v1/v2 loaded for the host benchmarks, with minimal header parsing, see FontManager for the real one
+struct EpdFontFile {
+  std::unique_ptr<CustomEpdFont> font;
+  std::vector<uint32_t> codepoints;
+  int version = 0;
+  uint32_t offsetBitmaps = 0;
+
+  bool load(const char* path, const size_t glyphCacheCapacity = 0, const size_t bitmapCacheBudget = 0) {
+    FsFile file;
+    uint8_t header[32];
+    if (!file.open(path) || file.read(header, sizeof(header)) != sizeof(header) || memcmp(header, "EPDF", 4) != 0) {
+      fprintf(stderr, "%s: not an .epdfont\n", path);
+      return false;
+    }
+    uint16_t fileVersion;
+    uint32_t intervalCount, glyphCount, offsets[3];
+    memcpy(&fileVersion, header + 4, 2);
+    memcpy(&intervalCount, header + 12, 4);
+    memcpy(&glyphCount, header + 16, 4);
+    memcpy(offsets, header + 20, 12);
+    if (fileVersion != 1 && fileVersion != 2) {
+      fprintf(stderr, "%s: version %u, expected 1 or 2\n", path, fileVersion);
+      return false;
+    }
+
+    auto* intervals = new EpdUnicodeInterval[intervalCount];
+    file.seekSet(offsets[0]);
+    file.read(intervals, intervalCount * sizeof(EpdUnicodeInterval));
+    auto* data = new EpdFontData();
+    data->intervals = intervals;
+    data->intervalCount = intervalCount;
+    data->advanceY = header[8];
+    data->ascender = static_cast<int8_t>(header[9]);
+    data->descender = static_cast<int8_t>(header[10]);
+    data->is2Bit = header[6] != 0;
+    data->pageTable = EpdFont::buildPageTable(data);
+    codepoints.clear();
+    for (uint32_t i = 0; i < intervalCount; i++) {
+      for (uint32_t cp = intervals[i].first; cp <= intervals[i].last; cp++) {
+        codepoints.push_back(cp);
+      }
+    }
+    version = fileVersion;
+    offsetBitmaps = offsets[2];
+    font.reset(new CustomEpdFont(path, data, offsets[0], offsets[1], offsets[2], version, glyphCacheCapacity,
+                                 bitmapCacheBudget));
+    return true;
+  }
+};
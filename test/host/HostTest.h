@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// Minimal checks for the host tests: a failed check prints where and exits, so the first failure stops the run
+#define CHECK(cond)                                                        \
+  do {                                                                     \
+    if (!(cond)) {                                                         \
+      std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+      std::exit(1);                                                        \
+    }                                                                      \
+  } while (0)
+
+#define RUN_TEST(fn)          \
+  do {                        \
+    std::printf("%s\n", #fn); \
+    fn();                     \
+  } while (0)
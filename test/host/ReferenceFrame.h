@@ -0,0 +1,39 @@
+#pragma once
+
+#include <GfxRenderer.h>
+
+#include <cstring>
+#include <vector>
+
+// Frame buffer drawn one pixel at a time through GfxRenderer::rotateCoordinates, the result the renderer's faster
+// primitives have to reproduce bit for bit
+struct ReferenceFrame {
+  std::vector<uint8_t> bytes;
+
+  explicit ReferenceFrame(const uint8_t* frameBuffer) : bytes(frameBuffer, frameBuffer + EInkDisplay::BUFFER_SIZE) {}
+
+  void setPixel(const GfxRenderer& renderer, const int x, const int y, const bool black) {
+    if (x < 0 || y < 0 || x >= renderer.getScreenWidth() || y >= renderer.getScreenHeight()) {
+      return;
+    }
+    int panelX = 0;
+    int panelY = 0;
+    renderer.rotateCoordinates(x, y, &panelX, &panelY);
+    uint8_t& byte = bytes[panelY * EInkDisplay::DISPLAY_WIDTH_BYTES + panelX / 8];
+    const uint8_t bit = 0x80 >> (panelX % 8);
+    byte = black ? byte & ~bit : byte | bit;
+  }
+
+  void fillRect(const GfxRenderer& renderer, const int x, const int y, const int width, const int height,
+                const bool black) {
+    for (int dy = 0; dy < height; dy++) {
+      for (int dx = 0; dx < width; dx++) {
+        setPixel(renderer, x + dx, y + dy, black);
+      }
+    }
+  }
+
+  bool matches(const uint8_t* frameBuffer) const {
+    return memcmp(bytes.data(), frameBuffer, EInkDisplay::BUFFER_SIZE) == 0;
+  }
+};
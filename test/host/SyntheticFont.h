@@ -0,0 +1,88 @@
+#pragma once
+
+#include <EpdFont.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+// In-memory font of random glyph bitmaps for drawing tests and benchmarks: printable ASCII (space without ink) and
+// cjkCount ideographs from U+4E00. ASCII glyphs get random boxes, including ones reaching left of the pen and below the
+// baseline; ideographs are cjkSize squares, as in a CJK font, or random boxes too if cjkSize is 0.
+struct SyntheticFont {
+  static constexpr uint32_t CJK_FIRST = 0x4E00;
+  static constexpr int ASCENDER = 26;
+
+  std::vector<uint8_t> bitmaps;
+  std::vector<EpdGlyph> glyphs;
+  std::vector<EpdUnicodeInterval> intervals;
+  EpdFontData data{};
+  EpdFont font{&data};
+
+  SyntheticFont(const bool is2Bit, const uint32_t seed, const uint32_t cjkCount = 64, const int cjkSize = 0) {
+    std::mt19937 rng(seed);
+    auto addGlyph = [&](const int width, const int height, const int left, const int top, const int advanceX) {
+      const uint32_t length = (width * height * (is2Bit ? 2 : 1) + 7) / 8;
+      glyphs.push_back({static_cast<uint8_t>(width), static_cast<uint8_t>(height), static_cast<uint8_t>(advanceX),
+                        static_cast<int16_t>(left), static_cast<int16_t>(top), length,
+                        static_cast<uint32_t>(bitmaps.size())});
+      for (uint32_t i = 0; i < length; i++) {
+        // Some solid bytes, so runs of ink and of paper span whole framebuffer bytes
+        const uint32_t pick = rng() % 8;
+        bitmaps.push_back(pick == 0 ? 0x00 : pick == 1 ? 0xFF : rng());
+      }
+    };
+    auto randomGlyph = [&] {
+      const int width = 1 + rng() % 30;
+      const int height = 1 + rng() % 34;
+      const int left = static_cast<int>(rng() % 9) - 3;
+      const int top = static_cast<int>(rng() % (height + 4)) - 2;
+      addGlyph(width, height, left, top, std::max(width + left, 1) + static_cast<int>(rng() % 3));
+    };
+
+    intervals.push_back({0x20, 0x7E, 0});
+    addGlyph(0, 0, 0, 0, 7);
+    for (uint32_t cp = 0x21; cp <= 0x7E; cp++) {
+      randomGlyph();
+    }
+    if (cjkCount > 0) {
+      intervals.push_back({CJK_FIRST, CJK_FIRST + cjkCount - 1, static_cast<uint32_t>(glyphs.size())});
+      for (uint32_t i = 0; i < cjkCount; i++) {
+        if (cjkSize > 0) {
+          addGlyph(cjkSize, cjkSize, 1, ASCENDER - 2, cjkSize + 2);
+        } else {
+          randomGlyph();
+        }
+      }
+    }
+
+    data.bitmap = bitmaps.data();
+    data.glyph = glyphs.data();
+    data.intervals = intervals.data();
+    data.intervalCount = intervals.size();
+    data.advanceY = ASCENDER + 10;
+    data.ascender = ASCENDER;
+    data.descender = -8;
+    data.is2Bit = is2Bit;
+  }
+  SyntheticFont(const SyntheticFont&) = delete;
+  SyntheticFont& operator=(const SyntheticFont&) = delete;
+
+  // UTF-8 text of length characters of this font, one in cjkShare an ideograph and some spaces
+  std::string randomText(std::mt19937& rng, const int length, const int cjkShare = 2) const {
+    const uint32_t cjkCount = intervals.size() > 1 ? intervals[1].last - CJK_FIRST + 1 : 0;
+    std::string text;
+    for (int i = 0; i < length; i++) {
+      if (cjkCount > 0 && static_cast<int>(rng() % cjkShare) == 0) {
+        const uint32_t cp = CJK_FIRST + rng() % cjkCount;
+        text += static_cast<char>(0xE0 | cp >> 12);
+        text += static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+        text += static_cast<char>(0x80 | (cp & 0x3F));
+      } else {
+        text += rng() % 6 == 0 ? ' ' : static_cast<char>(0x21 + rng() % 94);
+      }
+    }
+    return text;
+  }
+};
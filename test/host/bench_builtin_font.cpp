@@ -0,0 +1,117 @@
+// Codepoint to glyph index lookups in the built-in ubuntu_10_bold, through the interval search and through the page
+// table, in host CPU time per lookup. Then bitmap loads for simulated pages of text, a page being PAGE_GLYPHS glyphs
+// drawn from a vocabulary of ASCII characters or of random characters of the font, in time and block inflates per page,
+// which is the decode cost of fonts with EpdFontData::bitmapBlocks.
+//
+//   make -C test/host benches SANITIZE= && test/host/build/nosan/bench_builtin_font [passes]
+//
+// The times are relative: the device has a slower CPU and runs the font from flash.
+
+#include <EpdFont.h>
+#include <builtinFonts/ubuntu_10_bold.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr int SAMPLE_COUNT = 2048;
+constexpr int MISS_INTERVAL = 8;  // Every 8th sample is a codepoint the font may not have
+
+constexpr int PAGES = 20;
+constexpr int PAGE_GLYPHS = 600;
+constexpr int VOCABULARY_SIZE = 200;
+
+using Clock = std::chrono::steady_clock;
+
+double nanoseconds(const Clock::duration d) { return std::chrono::duration<double, std::nano>(d).count(); }
+
+// Codepoints drawn from the font's own intervals, so dense blocks are sampled as often as text would hit them
+std::vector<uint32_t> sampleCodepoints(const EpdFontData* data) {
+  std::mt19937 rng(12345);
+  std::vector<uint32_t> samples;
+  for (int i = 0; i < SAMPLE_COUNT; i++) {
+    const EpdUnicodeInterval& interval = data->intervals[rng() % data->intervalCount];
+    uint32_t cp = interval.first + rng() % (interval.last - interval.first + 1);
+    if (i % MISS_INTERVAL == 0) {
+      cp += rng() % 64;
+    }
+    samples.push_back(cp);
+  }
+  return samples;
+}
+
+bool benchLookups(const char* name, const EpdFontData* data, const int passes) {
+  const auto samples = sampleCodepoints(data);
+  uint32_t glyphIndex = 0;
+
+  uint32_t checksum = 0;
+  Clock::time_point start = Clock::now();
+  for (int pass = 0; pass < passes; pass++) {
+    for (const uint32_t cp : samples) {
+      checksum += EpdFont::findGlyphIndexInIntervals(data, cp, &glyphIndex) ? glyphIndex : 1;
+    }
+  }
+  const double intervalNs = nanoseconds(Clock::now() - start);
+
+  uint32_t tableChecksum = 0;
+  start = Clock::now();
+  for (int pass = 0; pass < passes; pass++) {
+    for (const uint32_t cp : samples) {
+      const bool found = cp < 0x10000 ? EpdFont::findGlyphIndexInPageTable(data->pageTable, cp, &glyphIndex)
+                                      : EpdFont::findGlyphIndexInIntervals(data, cp, &glyphIndex);
+      tableChecksum += found ? glyphIndex : 1;
+    }
+  }
+  const double tableNs = nanoseconds(Clock::now() - start);
+
+  const double lookups = static_cast<double>(samples.size()) * passes;
+  printf("%s: %u intervals, %.0f lookups\n", name, data->intervalCount, lookups);
+  printf("  interval search  %6.1f ns per lookup\n", intervalNs / lookups);
+  printf("  page table       %6.1f ns per lookup%s\n", tableNs / lookups,
+         checksum != tableChecksum ? " (MISMATCH)" : "");
+  return checksum == tableChecksum;
+}
+
+void benchBitmaps(const char* name, const EpdFontData* data) {
+  const EpdFont font(data);
+  std::mt19937 rng(54321);
+  const EpdGlyph* vocabulary[VOCABULARY_SIZE];
+
+  printf("%s: %d pages of %d glyphs, %u byte blocks\n", name, PAGES, PAGE_GLYPHS,
+         data->bitmapBlocks ? data->bitmapBlocks->blockSize : 0);
+  for (const bool ascii : {true, false}) {
+    uint32_t checksum = 0;
+    const uint32_t inflatesBefore = EpdFont::getBitmapBlockInflateCount();
+    const Clock::time_point start = Clock::now();
+    for (int page = 0; page < PAGES; page++) {
+      for (auto& glyph : vocabulary) {
+        do {
+          const EpdUnicodeInterval& interval = data->intervals[rng() % data->intervalCount];
+          const uint32_t cp = ascii ? 0x21 + rng() % 94 : interval.first + rng() % (interval.last - interval.first + 1);
+          glyph = font.getGlyph(cp);
+        } while (!glyph);
+      }
+      for (int i = 0; i < PAGE_GLYPHS; i++) {
+        const EpdGlyph* glyph = vocabulary[rng() % VOCABULARY_SIZE];
+        const uint8_t* bitmap = font.loadGlyphBitmap(glyph, nullptr);
+        checksum += bitmap && glyph->dataLength ? bitmap[glyph->dataLength - 1] : 0;
+      }
+    }
+    const double elapsedNs = nanoseconds(Clock::now() - start);
+    const uint32_t inflates = EpdFont::getBitmapBlockInflateCount() - inflatesBefore;
+    printf("  %-12s  %7.1f us and %5.1f block inflates per page (%u)\n", ascii ? "ASCII" : "random glyph",
+           elapsedNs / 1000 / PAGES, static_cast<double>(inflates) / PAGES, checksum);
+  }
+}
+}  // namespace
+
+int main(const int argc, char** argv) {
+  const int passes = argc > 1 ? atoi(argv[1]) : 200;
+  const bool ok = benchLookups("ubuntu_10_bold", &ubuntu_10_bold, passes);
+  printf("\n");
+  benchBitmaps("ubuntu_10_bold", &ubuntu_10_bold);
+  return ok ? 0 : 1;
+}
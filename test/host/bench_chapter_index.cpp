@@ -0,0 +1,170 @@
+// Indexing one chapter, inflated straight into the parser and, as when the heap is low, through a temp file on SD.
+// Builds the real Section, parser, ZipFile, miniz and expat against a fake renderer and reports SD traffic and host CPU
+// time per MB of XHTML for both, and checks that they write the same section file. The chapter is a generated 1MB
+// XHTML file of Latin and CJK paragraphs, deflated into a test epub.
+//
+//   make -C test/host benches && test/host/build/bench_chapter_index [runs] 2>/dev/null
+//
+// Heap can't be measured here; on the device the section build logs free and minimum free heap for each chapter.
+
+#include <Arduino.h>
+#include <Epub.h>
+#include <Epub/Section.h>
+#include <GfxRenderer.h>
+#include <SDCardManager.h>
+#include <ZipFile.h>
+#include <miniz.h>
+
+#include <ctime>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace {
+constexpr char EPUB_PATH[] = "/bench_chapter.epub";
+constexpr char CHAPTER_HREF[] = "OEBPS/ch1.xhtml";
+constexpr size_t CHAPTER_BYTES = 1024 * 1024;
+
+std::string generateChapter() {
+  static const char* words[] = {"the",  "quick",   "brown",   "fox",    "jumps",      "over",  "lazy",
+                                "dog",  "while",   "reading", "an",     "electronic", "paper", "display",
+                                "late", "into",    "night",   "<b>bold</b>", "<i>italic</i>"};
+  static const char* han[] = {"天", "地", "玄", "黄", "宇", "宙", "洪", "荒", "日", "月", "盈", "昃", "辰", "宿"};
+  std::mt19937 rng(7);
+  std::string html =
+      "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<html xmlns=\"http://www.w3.org/1999/xhtml\"><head><title>c</title>"
+      "</head><body>\n<h1>Chapter</h1>\n";
+  for (int i = 0; html.size() < CHAPTER_BYTES; i++) {
+    html += "<p>";
+    if (i % 3 == 0) {
+      for (int n = 80 + rng() % 220; n > 0; n--) {
+        html += han[rng() % (sizeof(han) / sizeof(han[0]))];
+      }
+    } else {
+      for (int n = 40 + rng() % 120; n > 0; n--) {
+        html += words[rng() % (sizeof(words) / sizeof(words[0]))];
+        html += n > 1 ? " " : "";
+      }
+    }
+    html += "</p>\n";
+  }
+  return html + "</body></html>\n";
+}
+
+bool writeEpub(const std::string& chapter) {
+  mz_zip_archive zip = {};
+  const std::string path = hostPath(EPUB_PATH);
+  bool ok = mz_zip_writer_init_file(&zip, path.c_str(), 0);
+  ok = ok && mz_zip_writer_add_mem(&zip, "mimetype", "application/epub+zip", 20, MZ_NO_COMPRESSION);
+  ok = ok && mz_zip_writer_add_mem(&zip, CHAPTER_HREF, chapter.data(), chapter.size(), MZ_DEFAULT_COMPRESSION);
+  ok = ok && mz_zip_writer_finalize_archive(&zip);
+  mz_zip_writer_end(&zip);
+  return ok;
+}
+
+std::string readSectionFile(const Epub& epub) {
+  // The section file is the only .bin besides the variant index
+  auto dir = SdMan.open((epub.getCachePath() + "/sections").c_str());
+  char name[64];
+  for (auto file = dir.openNextFile(); file; file = dir.openNextFile()) {
+    file.getName(name, sizeof(name));
+    if (strcmp(name, "variants.bin") != 0) {
+      std::ifstream in(hostPath((epub.getCachePath() + "/sections/" + name).c_str()), std::ios::binary);
+      std::stringstream contents;
+      contents << in.rdbuf();
+      return contents.str();
+    }
+  }
+  return "";
+}
+
+struct Result {
+  double bestMs = 1e9;
+  long bytesRead = 0;
+  long bytesWritten = 0;
+  int pages = 0;
+  std::string sectionFile;
+};
+
+bool run(const std::shared_ptr<Epub>& epub, GfxRenderer& renderer, const int runs, Result& result) {
+  for (int i = 0; i < runs; i++) {
+    Section section(epub, 0, renderer);
+    section.clearCache();
+    hostSdStats = {};
+    const clock_t start = clock();
+    if (!section.createSectionFile(0, 1.0f, false, 460, 740)) {
+      return false;
+    }
+    result.bestMs = std::min(result.bestMs, 1000.0 * (clock() - start) / CLOCKS_PER_SEC);
+    result.bytesRead = hostSdStats.bytesRead;
+    result.bytesWritten = hostSdStats.bytesWritten;
+    result.pages = section.pageCount;
+  }
+  result.sectionFile = readSectionFile(*epub);
+  return true;
+}
+}  // namespace
+
+// Only what a section build uses of Epub, the real Epub.cpp needs a whole book
+const std::string& Epub::getCachePath() const { return cachePath; }
+
+SectionCache& Epub::getSectionCache() const {
+  if (!sectionCache) {
+    sectionCache.reset(new SectionCache(cachePath + "/sections"));
+  }
+  return *sectionCache;
+}
+
+BookMetadataCache::SpineEntry Epub::getSpineItem(int) const {
+  BookMetadataCache::SpineEntry entry;
+  entry.href = CHAPTER_HREF;
+  return entry;
+}
+
+std::unique_ptr<ZipFileReader> Epub::openItemReader(const std::string& itemHref, const size_t chunkSize,
+                                                    const std::string& spoolPath) const {
+  std::unique_ptr<ZipFileReader> reader(new ZipFileReader(filepath));
+  if (!reader->open(itemHref.c_str(), chunkSize, spoolPath)) {
+    return nullptr;
+  }
+  return reader;
+}
+
+int main(const int argc, char** argv) {
+  const int runs = argc > 1 ? atoi(argv[1]) : 5;
+  std::string root = argv[0];
+  hostSdRoot() = root.substr(0, root.rfind('/') + 1) + "sd";
+  SdMan.begin();
+
+  const std::string chapter = generateChapter();
+  if (!writeEpub(chapter)) {
+    fprintf(stderr, "Failed to write %s\n", hostPath(EPUB_PATH).c_str());
+    return 1;
+  }
+  const auto epub = std::make_shared<Epub>(EPUB_PATH, "/.bench");
+  SdMan.mkdir(epub->getCachePath().c_str());
+  GfxRenderer renderer;
+
+  Result streamed, spooled;
+  ESP.freeHeap = ESP.minFreeHeap = 160000;
+  const bool streamedOk = run(epub, renderer, runs, streamed);
+  ESP.freeHeap = ESP.minFreeHeap = 40000;
+  const bool spooledOk = run(epub, renderer, runs, spooled);
+  if (!streamedOk || !spooledOk) {
+    fprintf(stderr, "Section build failed\n");
+    return 1;
+  }
+
+  const double mb = chapter.size() / 1048576.0;
+  printf("%.2f MB of XHTML, %d pages, best of %d runs\n\n", mb, streamed.pages, runs);
+  printf("                       temp file    into parser\n");
+  printf("  SD read per MB       %6.2f MB      %6.2f MB\n", spooled.bytesRead / 1048576.0 / mb,
+         streamed.bytesRead / 1048576.0 / mb);
+  printf("  SD written per MB    %6.2f MB      %6.2f MB\n", spooled.bytesWritten / 1048576.0 / mb,
+         streamed.bytesWritten / 1048576.0 / mb);
+  printf("  host CPU per MB      %6.0f ms      %6.0f ms\n", spooled.bestMs / mb, streamed.bestMs / mb);
+  const bool identical = streamed.sectionFile == spooled.sectionFile && !streamed.sectionFile.empty();
+  printf("\nSection files %s\n", identical ? "identical" : "DIFFER");
+  return identical ? 0 : 1;
+}
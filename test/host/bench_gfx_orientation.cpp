@@ -0,0 +1,135 @@
+// GfxRenderer drawing in each of the four orientations, in host CPU time per call: fillRect over random rectangles,
+// pages of text in a synthetic 1-bit and 2-bit font, and 1 bpp and 2 bpp bitmaps. Portrait and PortraitInverted run
+// glyph columns and bitmap columns along panel rows, the landscape orientations glyph and bitmap rows; the numbers
+// show what that costs for each primitive.
+//
+//   make -C test/host benches SANITIZE= && test/host/build/nosan/bench_gfx_orientation [passes]
+//
+// Bitmaps are read from build/sd through the SdFat stub, so their times include host file reads. The times are
+// relative: the device has a slower CPU.
+
+#include <GfxRenderer.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BmpFile.h"
+#include "SyntheticFont.h"
+
+namespace {
+constexpr GfxRenderer::Orientation ORIENTATIONS[] = {GfxRenderer::Portrait, GfxRenderer::LandscapeClockwise,
+                                                     GfxRenderer::PortraitInverted,
+                                                     GfxRenderer::LandscapeCounterClockwise};
+constexpr const char* ORIENTATION_NAMES[] = {"Portrait", "LandscapeClockwise", "PortraitInverted",
+                                             "LandscapeCounterClockwise"};
+constexpr int RECTS = 2000;
+// Text that fits the screen in every orientation, so no orientation gets away with clipped glyphs
+constexpr int LINES_PER_PAGE = 12;
+constexpr int LINE_GLYPHS = 18;
+constexpr int BITMAP_SIZE = 240;
+constexpr const char* BENCH_DIR = "/bench_gfx";
+
+using Clock = std::chrono::steady_clock;
+
+double microseconds(const Clock::duration d) { return std::chrono::duration<double, std::micro>(d).count(); }
+
+EInkDisplay display;
+
+double benchRects(GfxRenderer& renderer, const int passes) {
+  std::mt19937 rng(1);
+  std::vector<int> rects;
+  for (int i = 0; i < RECTS; i++) {
+    rects.insert(rects.end(), {static_cast<int>(rng() % 400), static_cast<int>(rng() % 400),
+                               1 + static_cast<int>(rng() % 200), 1 + static_cast<int>(rng() % 200)});
+  }
+  const Clock::time_point start = Clock::now();
+  for (int pass = 0; pass < passes; pass++) {
+    for (int i = 0; i < RECTS; i++) {
+      renderer.fillRect(rects[i * 4], rects[i * 4 + 1], rects[i * 4 + 2], rects[i * 4 + 3], i & 1);
+    }
+  }
+  return microseconds(Clock::now() - start) / passes / RECTS;
+}
+
+double benchText(GfxRenderer& renderer, const int fontId, const std::vector<std::string>& lines, const int passes) {
+  const int lineHeight = renderer.getLineHeight(fontId);
+  const Clock::time_point start = Clock::now();
+  for (int pass = 0; pass < passes; pass++) {
+    renderer.clearScreen();
+    for (size_t i = 0; i < lines.size(); i++) {
+      renderer.drawText(fontId, 10, 10 + static_cast<int>(i) * lineHeight, lines[i].c_str());
+    }
+  }
+  return microseconds(Clock::now() - start) / passes;
+}
+
+double benchBitmap(GfxRenderer& renderer, const std::string& path, const int passes) {
+  const Clock::time_point start = Clock::now();
+  for (int pass = 0; pass < passes; pass++) {
+    FsFile file;
+    if (!SdMan.openFileForRead("BNC", path, file)) {
+      return 0;
+    }
+    Bitmap bitmap(file);
+    if (bitmap.parseHeaders() != BmpReaderError::Ok) {
+      return 0;
+    }
+    renderer.drawBitmap(bitmap, 20, 20, 0, 0);
+  }
+  return microseconds(Clock::now() - start) / passes;
+}
+}  // namespace
+
+int main(const int argc, char** argv) {
+  const int passes = argc > 1 ? atoi(argv[1]) : 20;
+  SdMan.begin();
+  SdMan.mkdir(BENCH_DIR);
+
+  std::mt19937 rng(2);
+  std::vector<uint8_t> values(BITMAP_SIZE * BITMAP_SIZE);
+  for (auto& value : values) {
+    value = rng() % 4;
+  }
+  const std::string gray = std::string(BENCH_DIR) + "/gray.bmp";
+  const std::string mono = std::string(BENCH_DIR) + "/mono.bmp";
+  if (!writeBmp(gray.c_str(), BITMAP_SIZE, BITMAP_SIZE, 2, values, false)) {
+    fprintf(stderr, "can't write %s\n", gray.c_str());
+    return 1;
+  }
+  for (auto& value : values) {
+    value = value < 2 ? 0 : 3;
+  }
+  if (!writeBmp(mono.c_str(), BITMAP_SIZE, BITMAP_SIZE, 1, values, false)) {
+    fprintf(stderr, "can't write %s\n", mono.c_str());
+    return 1;
+  }
+
+  const SyntheticFont oneBit(false, 1, 3000, 22);
+  const SyntheticFont twoBit(true, 2, 3000, 22);
+  std::vector<std::string> lines;
+  for (int i = 0; i < LINES_PER_PAGE; i++) {
+    lines.push_back(twoBit.randomText(rng, LINE_GLYPHS));
+  }
+
+  GfxRenderer renderer(display);
+  renderer.insertFont(1, EpdFontFamily(&oneBit.font));
+  renderer.insertFont(2, EpdFontFamily(&twoBit.font));
+  printf("%d passes; fillRect per rectangle, text per page of %d lines of %d characters, bitmaps %dx%d\n", passes,
+         LINES_PER_PAGE, LINE_GLYPHS, BITMAP_SIZE, BITMAP_SIZE);
+  printf("%-26s %10s %12s %12s %12s %12s\n", "", "fillRect", "text 1-bit", "text 2-bit", "bitmap 1bpp", "bitmap 2bpp");
+  for (int i = 0; i < 4; i++) {
+    renderer.setOrientation(ORIENTATIONS[i]);
+    const double rect = benchRects(renderer, passes);
+    const double text1 = benchText(renderer, 1, lines, passes);
+    const double text2 = benchText(renderer, 2, lines, passes);
+    const double bitmap1 = benchBitmap(renderer, mono, passes);
+    const double bitmap2 = benchBitmap(renderer, gray, passes);
+    printf("%-26s %7.2f us %9.0f us %9.0f us %9.0f us %9.0f us\n", ORIENTATION_NAMES[i], rect, text1, text2, bitmap1,
+           bitmap2);
+  }
+  return 0;
+}
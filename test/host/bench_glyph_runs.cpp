@@ -0,0 +1,138 @@
+// Bitmap bytes read from the SD card while rendering random glyphs, for the same font stored as .epdfont v1 and as v2
+// with run length encoded bitmaps, and the host CPU time of those loads and of decodePixelRuns alone. Also checks that
+// every v2 bitmap decodes to the v1 one.
+//
+//   python3 lib/EpdFont/scripts/fontconvert.py --binary --2bit Bookerly-Regular-24 24 Bookerly-Regular.ttf
+//   (same with --compress into another directory)
+//   make -C test/host benches SANITIZE=
+//   test/host/build/nosan/bench_glyph_runs v1/Bookerly-Regular-24.epdfont v2/Bookerly-Regular-24.epdfont
+//
+// The times are relative: the device has a slower CPU and SD card.
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "EpdFontFile.h"
+
+namespace {
+constexpr int PAGES = 300;
+constexpr int GLYPHS_PER_PAGE = 300;
+constexpr int DECODE_PASSES = 20;
+
+using Clock = std::chrono::steady_clock;
+
+double microseconds(const Clock::duration d) { return std::chrono::duration<double, std::micro>(d).count(); }
+
+// Every compressed bitmap of a v2 font as stored, with its glyph
+struct StoredBitmap {
+  EpdGlyph glyph;
+  std::vector<uint8_t> runs;
+};
+
+std::vector<StoredBitmap> readCompressedBitmaps(const char* path, const EpdFontFile& font) {
+  FsFile file;
+  file.open(path);
+  const int bitsPerPixel = font.font->data->is2Bit ? 2 : 1;
+  std::vector<StoredBitmap> bitmaps;
+  for (const uint32_t cp : font.codepoints) {
+    const EpdGlyph* glyph = font.font->getGlyph(cp);
+    if (!glyph || glyph->dataLength >= static_cast<uint32_t>(glyph->width * glyph->height * bitsPerPixel + 7) / 8) {
+      continue;
+    }
+    StoredBitmap bitmap = {*glyph, std::vector<uint8_t>(glyph->dataLength)};
+    file.seekSet(font.offsetBitmaps + glyph->dataOffset);
+    file.read(bitmap.runs.data(), bitmap.runs.size());
+    bitmaps.push_back(std::move(bitmap));
+  }
+  return bitmaps;
+}
+}  // namespace
+
+int main(const int argc, char** argv) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <v1.epdfont> <v2.epdfont>\n", argv[0]);
+    return 2;
+  }
+  // Paths are host paths
+  hostSdRoot() = "";
+
+  EpdFontFile v1, v2;
+  if (!v1.load(argv[1]) || !v2.load(argv[2])) {
+    return 1;
+  }
+  if (v1.codepoints != v2.codepoints) {
+    fprintf(stderr, "The fonts have different glyphs\n");
+    return 1;
+  }
+
+  std::mt19937 rng(1);
+  const int bitsPerPixel = v1.font->data->is2Bit ? 2 : 1;
+  long bytesV1 = 0, bytesV2 = 0, mismatches = 0, loads = 0;
+  Clock::duration timeV1{}, timeV2{};
+  std::vector<uint8_t> bitmapV1;
+  for (int page = 0; page < PAGES; page++) {
+    for (int i = 0; i < GLYPHS_PER_PAGE; i++) {
+      const uint32_t cp = v1.codepoints[rng() % v1.codepoints.size()];
+      const EpdGlyph* glyphV1 = v1.font->getGlyph(cp);
+      const EpdGlyph* glyphV2 = v2.font->getGlyph(cp);
+      if (!glyphV1 || !glyphV2) {
+        mismatches++;
+        continue;
+      }
+
+      // Only bitmap reads are counted, glyph records cost the same in both versions
+      hostSdStats.bytesRead = 0;
+      Clock::time_point start = Clock::now();
+      const uint8_t* dataV1 = v1.font->loadGlyphBitmap(glyphV1, nullptr);
+      timeV1 += Clock::now() - start;
+      bytesV1 += hostSdStats.bytesRead;
+      // Copied, the returned pointer is only valid until the next load
+      const size_t length = dataV1 ? (glyphV1->width * glyphV1->height * bitsPerPixel + 7) / 8 : 0;
+      bitmapV1.assign(dataV1, dataV1 + length);
+
+      hostSdStats.bytesRead = 0;
+      start = Clock::now();
+      const uint8_t* dataV2 = v2.font->loadGlyphBitmap(glyphV2, nullptr);
+      timeV2 += Clock::now() - start;
+      bytesV2 += hostSdStats.bytesRead;
+      loads++;
+      if (length > 0 && (!dataV2 || memcmp(bitmapV1.data(), dataV2, length) != 0)) {
+        mismatches++;
+      }
+    }
+  }
+
+  printf("%d pages of %d random glyphs (%zu in the font)\n", PAGES, GLYPHS_PER_PAGE, v1.codepoints.size());
+  printf("v%d: %ld bytes read\n", v1.version, bytesV1);
+  printf("v%d: %ld bytes read (%+.0f%%)\n", v2.version, bytesV2, 100.0 * (bytesV2 - bytesV1) / bytesV1);
+
+  // Decoding alone, every compressed bitmap of the font from memory
+  const auto compressed = readCompressedBitmaps(argv[2], v2);
+  std::vector<uint8_t> decoded;
+  long decodedBytes = 0;
+  const Clock::time_point start = Clock::now();
+  for (int pass = 0; pass < DECODE_PASSES; pass++) {
+    for (const auto& bitmap : compressed) {
+      const uint32_t pixelCount = bitmap.glyph.width * bitmap.glyph.height;
+      decoded.resize((pixelCount * bitsPerPixel + 7) / 8);
+      if (!CustomEpdFont::decodePixelRuns(bitmap.runs.data(), bitmap.runs.size(), decoded.data(), pixelCount,
+                                          bitsPerPixel)) {
+        mismatches++;
+      }
+      decodedBytes += decoded.size();
+    }
+  }
+  const double decodeUs = microseconds(Clock::now() - start);
+  const long decodes = DECODE_PASSES * static_cast<long>(compressed.size());
+
+  printf("\nhost CPU per bitmap load, glyph lookup excluded\n");
+  printf("v%d: %.2f us\n", v1.version, microseconds(timeV1) / loads);
+  printf("v%d: %.2f us\n", v2.version, microseconds(timeV2) / loads);
+  printf("decodePixelRuns alone: %.2f us per bitmap, %.0f MB/s out (%zu compressed bitmaps, %d passes)\n",
+         decodes ? decodeUs / decodes : 0.0, decodeUs > 0 ? decodedBytes / decodeUs : 0.0, compressed.size(),
+         DECODE_PASSES);
+  printf("%ld bitmaps differ\n", mismatches);
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+// Replays the glyph accesses of a chapter through CustomEpdFont as the reader draws it: per page, prefetch the page's
+// codepoints, then look up and load the bitmap of every glyph in order. Reports glyph and bitmap cache hits and misses
+// and SD reads per page for a few bitmap cache budgets. The trace is the chapter's text as UTF-8, for example exported
+// from the book; pages are split at form feeds, or every [glyphs per page] visible characters if there are none.
+//
+//   make -C test/host benches
+//   test/host/build/bench_glyph_trace NotoSansSC-Regular-18.epdfont chapter.txt [glyphs per page]
+
+#include <Utf8.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "EpdFontFile.h"
+
+namespace {
+constexpr size_t BUDGETS[] = {24 * 1024, 32 * 1024, 48 * 1024};
+constexpr int DEFAULT_GLYPHS_PER_PAGE = 500;
+
+bool readPages(const char* path, const int glyphsPerPage, std::vector<std::vector<uint32_t>>& pages) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    fprintf(stderr, "%s: can't read\n", path);
+    return false;
+  }
+  std::stringstream text;
+  text << in.rdbuf();
+  const std::string trace = text.str();
+  const bool formFeeds = trace.find('\f') != std::string::npos;
+
+  pages.emplace_back();
+  const auto* p = reinterpret_cast<const unsigned char*>(trace.c_str());
+  while (const uint32_t cp = utf8NextCodepoint(&p)) {
+    if (formFeeds ? cp == '\f' : static_cast<int>(pages.back().size()) == glyphsPerPage) {
+      pages.emplace_back();
+    }
+    if (cp > 0x20) {
+      pages.back().push_back(cp);
+    }
+  }
+  if (pages.back().empty()) {
+    pages.pop_back();
+  }
+  return !pages.empty();
+}
+
+struct Totals {
+  long glyphHits = 0, glyphMisses = 0, bitmapHits = 0, bitmapMisses = 0;
+  long sdReads = 0, bytesRead = 0, firstPageReads = 0;
+};
+
+Totals replay(const CustomEpdFont& font, const std::vector<std::vector<uint32_t>>& pages) {
+  Totals totals;
+  for (size_t page = 0; page < pages.size(); page++) {
+    const auto& codepoints = pages[page];
+    font.resetCacheStats();
+    hostSdStats = {};
+    font.prefetchGlyphs(codepoints.data(), codepoints.size());
+    for (const uint32_t cp : codepoints) {
+      if (const EpdGlyph* glyph = font.getGlyph(cp)) {
+        font.loadGlyphBitmap(glyph, nullptr);
+      }
+    }
+    totals.glyphHits += font.getGlyphCacheHits();
+    totals.glyphMisses += font.getGlyphCacheMisses();
+    totals.bitmapHits += font.getBitmapCacheHits();
+    totals.bitmapMisses += font.getBitmapCacheMisses();
+    totals.sdReads += hostSdStats.reads;
+    totals.bytesRead += hostSdStats.bytesRead;
+    if (page == 0) {
+      totals.firstPageReads = hostSdStats.reads;
+    }
+  }
+  return totals;
+}
+
+double percent(const long part, const long whole) { return whole ? 100.0 * part / whole : 0.0; }
+}  // namespace
+
+int main(const int argc, char** argv) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <font.epdfont> <chapter.txt> [glyphs per page]\n", argv[0]);
+    return 2;
+  }
+  // Paths are host paths
+  hostSdRoot() = "";
+  const int glyphsPerPage = argc > 3 ? atoi(argv[3]) : DEFAULT_GLYPHS_PER_PAGE;
+
+  std::vector<std::vector<uint32_t>> pages;
+  if (!readPages(argv[2], glyphsPerPage, pages)) {
+    return 1;
+  }
+  size_t glyphs = 0;
+  for (const auto& page : pages) {
+    glyphs += page.size();
+  }
+  printf("%zu pages, %.0f glyphs per page\n\n", pages.size(), static_cast<double>(glyphs) / pages.size());
+  printf("bitmap budget   glyph cache hits   bitmap cache hits   SD reads per page   KB read per page   first page\n");
+
+  for (const size_t budget : BUDGETS) {
+    EpdFontFile font;
+    if (!font.load(argv[1], 0, budget)) {
+      return 1;
+    }
+    const Totals totals = replay(*font.font, pages);
+    const double pageCount = static_cast<double>(pages.size());
+    printf("%8zu KB      %6.1f%% (%ld)     %6.1f%% (%ld)     %10.1f        %10.1f        %6ld reads\n", budget / 1024,
+           percent(totals.glyphHits, totals.glyphHits + totals.glyphMisses), totals.glyphMisses,
+           percent(totals.bitmapHits, totals.bitmapHits + totals.bitmapMisses), totals.bitmapMisses,
+           totals.sdReads / pageCount, totals.bytesRead / 1024.0 / pageCount, totals.firstPageReads);
+  }
+  printf("\nMisses in brackets. The glyph cache is sized from a free heap of %u bytes.\n", ESP.getFreeHeap());
+  return 0;
+}
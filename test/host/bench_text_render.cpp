@@ -0,0 +1,137 @@
+// Rasterizes a dense page of CJK text through GfxRenderer::drawText, which blits each glyph by panel rows, and through
+// the per-pixel path renderChar used before (every glyph pixel through drawPixel), in host CPU time per page. Runs a
+// 1-bit font in BW and a 2-bit font in BW and both grayscale passes, and checks that both paths draw the same frame.
+//
+//   make -C test/host benches SANITIZE= && test/host/build/nosan/bench_text_render [passes]
+//
+// The font is synthetic (random 24px glyph bitmaps, see SyntheticFont.h) and in memory, so only rasterization is timed.
+// The times are relative: the device has a slower CPU.
+
+#include <GfxRenderer.h>
+#include <Utf8.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "SyntheticFont.h"
+
+namespace {
+constexpr int FONT_ID = 1;
+constexpr int GLYPH_SIZE = 24;
+constexpr int MARGIN = 12;
+
+using Clock = std::chrono::steady_clock;
+
+double microseconds(const Clock::duration d) { return std::chrono::duration<double, std::micro>(d).count(); }
+
+EInkDisplay display;
+
+// renderChar before glyphs were blitted: every pixel of the glyph through drawPixel
+void drawTextPerPixel(const GfxRenderer& renderer, const GfxRenderer::RenderMode mode, const EpdFont& font, const int x,
+                      const int y, const char* text, const bool black) {
+  const EpdFontData* data = font.getData();
+  const int yPos = y + data->ascender;
+  int xPos = x;
+  uint32_t cp;
+  while ((cp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&text)))) {
+    const EpdGlyph* glyph = font.getGlyph(cp);
+    if (!glyph) {
+      continue;
+    }
+    const uint8_t* bitmap = font.loadGlyphBitmap(glyph, nullptr);
+    for (int glyphY = 0; glyphY < glyph->height; glyphY++) {
+      const int screenY = yPos - glyph->top + glyphY;
+      for (int glyphX = 0; glyphX < glyph->width; glyphX++) {
+        const int pixelPosition = glyphY * glyph->width + glyphX;
+        const int screenX = xPos + glyph->left + glyphX;
+        if (data->is2Bit) {
+          const uint8_t bmpVal = (3 - (bitmap[pixelPosition / 4] >> ((3 - pixelPosition % 4) * 2))) & 0x3;
+          if (mode == GfxRenderer::BW && bmpVal < 3) {
+            renderer.drawPixel(screenX, screenY, black);
+          } else if (mode == GfxRenderer::GRAYSCALE_MSB && (bmpVal == 1 || bmpVal == 2)) {
+            renderer.drawPixel(screenX, screenY, false);
+          } else if (mode == GfxRenderer::GRAYSCALE_LSB && bmpVal == 1) {
+            renderer.drawPixel(screenX, screenY, false);
+          }
+        } else if (bitmap[pixelPosition / 8] >> (7 - pixelPosition % 8) & 1) {
+          renderer.drawPixel(screenX, screenY, black);
+        }
+      }
+    }
+    xPos += glyph->advanceX;
+  }
+}
+
+// One page as the reader lays it out: as many full lines of ideographs as fit the portrait screen
+std::vector<std::string> pageLines(const SyntheticFont& font, const int screenWidth, const int screenHeight) {
+  std::mt19937 rng(3);
+  const int perLine = (screenWidth - 2 * MARGIN) / (GLYPH_SIZE + 2);
+  const int lines = (screenHeight - 2 * MARGIN) / font.data.advanceY;
+  std::vector<std::string> page;
+  for (int i = 0; i < lines; i++) {
+    page.push_back(font.randomText(rng, perLine, 1));
+  }
+  return page;
+}
+
+bool bench(GfxRenderer& renderer, const char* name, const SyntheticFont& font, const GfxRenderer::RenderMode mode,
+           const int passes) {
+  const auto lines = pageLines(font, renderer.getScreenWidth(), renderer.getScreenHeight());
+  const int lineHeight = font.data.advanceY;
+  renderer.setRenderMode(mode);
+
+  const Clock::time_point perPixelStart = Clock::now();
+  for (int pass = 0; pass < passes; pass++) {
+    renderer.clearScreen();
+    for (size_t i = 0; i < lines.size(); i++) {
+      drawTextPerPixel(renderer, mode, font.font, MARGIN, MARGIN + static_cast<int>(i) * lineHeight, lines[i].c_str(),
+                       true);
+    }
+  }
+  const double perPixelUs = microseconds(Clock::now() - perPixelStart) / passes;
+  const std::vector<uint8_t> expected(display.getFrameBuffer(), display.getFrameBuffer() + EInkDisplay::BUFFER_SIZE);
+
+  const Clock::time_point blitStart = Clock::now();
+  for (int pass = 0; pass < passes; pass++) {
+    renderer.clearScreen();
+    for (size_t i = 0; i < lines.size(); i++) {
+      renderer.drawText(FONT_ID, MARGIN, MARGIN + static_cast<int>(i) * lineHeight, lines[i].c_str());
+    }
+  }
+  const double blitUs = microseconds(Clock::now() - blitStart) / passes;
+  const bool same = memcmp(expected.data(), display.getFrameBuffer(), EInkDisplay::BUFFER_SIZE) == 0;
+
+  size_t glyphs = 0;
+  for (const auto& line : lines) {
+    const auto* p = reinterpret_cast<const uint8_t*>(line.c_str());
+    while (utf8NextCodepoint(&p)) {
+      glyphs++;
+    }
+  }
+  printf("%-18s %zu glyphs  per pixel %7.0f us  blit %6.0f us  %4.1fx%s\n", name, glyphs, perPixelUs, blitUs,
+         perPixelUs / blitUs, same ? "" : "  (MISMATCH)");
+  return same;
+}
+}  // namespace
+
+int main(const int argc, char** argv) {
+  const int passes = argc > 1 ? atoi(argv[1]) : 50;
+  const SyntheticFont oneBit(false, 1, 3000, GLYPH_SIZE);
+  const SyntheticFont twoBit(true, 2, 3000, GLYPH_SIZE);
+  GfxRenderer renderer(display);
+  renderer.setOrientation(GfxRenderer::Portrait);
+
+  bool ok = true;
+  renderer.insertFont(FONT_ID, EpdFontFamily(&oneBit.font));
+  ok &= bench(renderer, "1-bit BW", oneBit, GfxRenderer::BW, passes);
+  renderer.insertFont(FONT_ID, EpdFontFamily(&twoBit.font));
+  ok &= bench(renderer, "2-bit BW", twoBit, GfxRenderer::BW, passes);
+  ok &= bench(renderer, "2-bit gray LSB", twoBit, GfxRenderer::GRAYSCALE_LSB, passes);
+  ok &= bench(renderer, "2-bit gray MSB", twoBit, GfxRenderer::GRAYSCALE_MSB, passes);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+// Renderer for laying out text without fonts or a display: every ASCII character is 9px wide (10px in bold), every
+// other character 20px, which is close enough to a real font for page counts and layout cost.
+
+#include <EpdFontFamily.h>
+#include <Utf8.h>
+
+#include <cstddef>
+#include <cstdint>
+
+class GfxRenderer {
+ public:
+  struct TextRunWord {
+    const char* text;
+    int x;
+    EpdFontFamily::Style style;
+  };
+
+  int getSpaceWidth(int) const { return 6; }
+  int getLineHeight(int) const { return 28; }
+  int getFontAscenderSize(int) const { return 20; }
+  int getScreenWidth() const { return 480; }
+  int getTextWidth(int, const char* text, const EpdFontFamily::Style style = EpdFontStyles::REGULAR) const {
+    auto p = reinterpret_cast<const unsigned char*>(text);
+    int width = 0;
+    uint32_t cp;
+    while ((cp = utf8NextCodepoint(&p))) {
+      width += cp < 0x80 ? 9 + (style & 1) : 20;
+    }
+    return width;
+  }
+  void prefetchGlyphs(int, const uint32_t*, size_t, EpdFontFamily::Style) const {}
+  void drawLine(int, int, int, int, bool) const {}
+  void drawTextRun(int, int, int, const TextRunWord*, size_t, bool = true) const {}
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+// Host stand-in for the parts of the Arduino core the tested code uses
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "HardwareSerial.h"
+#include "Print.h"
+#include "WString.h"
+
+inline unsigned long millis() {
+  using namespace std::chrono;
+  static const auto start = steady_clock::now();
+  return duration_cast<milliseconds>(steady_clock::now() - start).count();
+}
+
+inline unsigned long micros() {
+  using namespace std::chrono;
+  static const auto start = steady_clock::now();
+  return duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+
+inline void delay(unsigned long) {}
+inline void yield() {}
+
+// Heap figures are whatever the test sets, defaulting to a device after boot
+class EspClass {
+ public:
+  uint32_t freeHeap = 160000;
+  uint32_t minFreeHeap = 160000;
+
+  uint32_t getFreeHeap() const { return freeHeap; }
+  uint32_t getMinFreeHeap() const { return minFreeHeap; }
+  uint32_t getMaxAllocHeap() const { return freeHeap; }
+};
+inline EspClass ESP;
@@ -0,0 +1,38 @@
+#pragma once
+
+// Host stand-in for the display driver: the frame buffer and the dimensions, everything that would talk to the panel
+// does nothing. Same interface as the SDK's EInkDisplay built with EINK_DISPLAY_SINGLE_BUFFER_MODE.
+
+#include <cstdint>
+#include <cstring>
+
+class EInkDisplay {
+ public:
+  enum RefreshMode { FULL_REFRESH, HALF_REFRESH, FAST_REFRESH };
+
+  static constexpr uint16_t DISPLAY_WIDTH = 800;
+  static constexpr uint16_t DISPLAY_HEIGHT = 480;
+  static constexpr uint16_t DISPLAY_WIDTH_BYTES = DISPLAY_WIDTH / 8;
+  static constexpr uint32_t BUFFER_SIZE = DISPLAY_WIDTH_BYTES * DISPLAY_HEIGHT;
+
+  EInkDisplay() { clearScreen(); }
+
+  void clearScreen(const uint8_t color = 0xFF) const { memset(frameBuffer, color, BUFFER_SIZE); }
+  void drawImage(const uint8_t*, uint16_t, uint16_t, uint16_t, uint16_t, bool = false) const {}
+  void setFramebuffer(const uint8_t* bwBuffer) const { memcpy(frameBuffer, bwBuffer, BUFFER_SIZE); }
+
+  void copyGrayscaleBuffers(const uint8_t*, const uint8_t*) {}
+  void copyGrayscaleLsbBuffers(const uint8_t*) {}
+  void copyGrayscaleMsbBuffers(const uint8_t*) {}
+  void cleanupGrayscaleBuffers(const uint8_t*) {}
+
+  void displayBuffer(RefreshMode = FAST_REFRESH) {}
+  void displayWindow(uint16_t, uint16_t, uint16_t, uint16_t) {}
+  void displayGrayBuffer(bool = false) {}
+  void grayscaleRevert() {}
+
+  uint8_t* getFrameBuffer() const { return frameBuffer; }
+
+ private:
+  mutable uint8_t frameBuffer[BUFFER_SIZE];
+};
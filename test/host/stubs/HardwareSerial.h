@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Print.h"
+// As in the ESP32 core, where this header brings in millis() and the rest of the Arduino API
+#include "Arduino.h"
+
+class HardwareSerial : public Print {
+ public:
+  using Print::write;
+  size_t write(const uint8_t c) override { return fputc(c, stderr) == EOF ? 0 : 1; }
+  void begin(unsigned long) {}
+  void flush() {}
+};
+inline HardwareSerial Serial;
@@ -0,0 +1,43 @@
+#include <SDCardManager.h>
+
+// Host implementation of the SD card manager on top of the SdFat stub
+
+SDCardManager SDCardManager::instance;
+
+SDCardManager::SDCardManager() {}
+
+bool SDCardManager::begin() {
+  initialized = sd.mkdir("/");
+  return initialized;
+}
+
+bool SDCardManager::ready() const { return initialized; }
+
+bool SDCardManager::openFileForRead(const char*, const char* path, FsFile& file) { return file.open(path, O_RDONLY); }
+
+bool SDCardManager::openFileForRead(const char* moduleName, const std::string& path, FsFile& file) {
+  return openFileForRead(moduleName, path.c_str(), file);
+}
+
+bool SDCardManager::openFileForRead(const char* moduleName, const String& path, FsFile& file) {
+  return openFileForRead(moduleName, path.c_str(), file);
+}
+
+bool SDCardManager::openFileForWrite(const char*, const char* path, FsFile& file) {
+  return file.open(path, O_RDWR | O_CREAT | O_TRUNC);
+}
+
+bool SDCardManager::openFileForWrite(const char* moduleName, const std::string& path, FsFile& file) {
+  return openFileForWrite(moduleName, path.c_str(), file);
+}
+
+bool SDCardManager::openFileForWrite(const char* moduleName, const String& path, FsFile& file) {
+  return openFileForWrite(moduleName, path.c_str(), file);
+}
+
+bool SDCardManager::removeDir(const char* path) {
+  const std::string command = "rm -rf '" + hostPath(path) + "'";
+  return system(command.c_str()) == 0;
+}
+
+bool SDCardManager::ensureDirectoryExists(const char* path) { return mkdir(path); }
@@ -0,0 +1,226 @@
+#pragma once
+
+// Host stand-in for SdFat: files live in a directory of the host file system (hostSdRoot(), build/sd unless
+// HOST_SD_ROOT is set), and every access is counted in hostSdStats so benchmarks can report SD traffic.
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "Print.h"
+
+using oflag_t = int;
+#define O_RDONLY 0x00
+#define O_WRONLY 0x01
+#define O_RDWR 0x02
+#define O_CREAT 0x10
+#define O_TRUNC 0x20
+#define O_APPEND 0x40
+#define O_AT_END 0x80
+#define FILE_READ O_RDONLY
+#define FILE_WRITE (O_RDWR | O_CREAT | O_AT_END)
+
+struct HostSdStats {
+  long opens = 0;
+  long reads = 0;
+  long bytesRead = 0;
+  long seeks = 0;
+  long bytesWritten = 0;
+};
+inline HostSdStats hostSdStats;
+
+inline std::string& hostSdRoot() {
+  static std::string root = getenv("HOST_SD_ROOT") ? getenv("HOST_SD_ROOT") : "build/sd";
+  return root;
+}
+inline std::string hostPath(const char* path) { return hostSdRoot() + path; }
+
+class FsFile : public Print {
+  FILE* file = nullptr;
+  DIR* dir = nullptr;
+  std::string path;
+  std::string name;
+
+ public:
+  FsFile() = default;
+  FsFile(const FsFile&) = delete;
+  FsFile& operator=(const FsFile&) = delete;
+  FsFile(FsFile&& other) noexcept { *this = std::move(other); }
+  FsFile& operator=(FsFile&& other) noexcept {
+    if (this != &other) {
+      close();
+      file = other.file;
+      dir = other.dir;
+      path = std::move(other.path);
+      name = std::move(other.name);
+      other.file = nullptr;
+      other.dir = nullptr;
+    }
+    return *this;
+  }
+  ~FsFile() override { close(); }
+
+  bool open(const char* devicePath, const oflag_t flags = O_RDONLY) {
+    close();
+    hostSdStats.opens++;
+    path = devicePath;
+    name = path.substr(path.rfind('/') + 1);
+    const std::string host = hostPath(devicePath);
+    struct stat st;
+    if (stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+      dir = opendir(host.c_str());
+      return dir != nullptr;
+    }
+    if (!(flags & (O_WRONLY | O_RDWR))) {
+      file = fopen(host.c_str(), "rb");
+    } else if (flags & O_TRUNC) {
+      file = fopen(host.c_str(), "w+b");
+    } else {
+      file = fopen(host.c_str(), "r+b");
+      if (!file && (flags & O_CREAT)) {
+        file = fopen(host.c_str(), "w+b");
+      }
+      if (file && (flags & (O_APPEND | O_AT_END))) {
+        fseek(file, 0, SEEK_END);
+      }
+    }
+    return file != nullptr;
+  }
+  bool open(const char* devicePath, const int flags, const int) { return open(devicePath, flags); }
+  void close() {
+    if (file) {
+      fclose(file);
+    }
+    if (dir) {
+      closedir(dir);
+    }
+    file = nullptr;
+    dir = nullptr;
+  }
+  bool isOpen() const { return file || dir; }
+  explicit operator bool() const { return isOpen(); }
+  bool isDirectory() const { return dir != nullptr; }
+
+  int read() {
+    const int c = fgetc(file);
+    if (c != EOF) {
+      hostSdStats.reads++;
+      hostSdStats.bytesRead++;
+    }
+    return c == EOF ? -1 : c;
+  }
+  int read(void* buffer, const size_t size) {
+    hostSdStats.reads++;
+    const size_t n = fread(buffer, 1, size, file);
+    hostSdStats.bytesRead += n;
+    return static_cast<int>(n);
+  }
+  size_t readBytes(char* buffer, const size_t size) {
+    const int n = read(buffer, size);
+    return n < 0 ? 0 : n;
+  }
+  size_t readBytesUntil(const char terminator, char* buffer, const size_t size) {
+    size_t n = 0;
+    int c;
+    while (n < size && (c = read()) >= 0 && c != terminator) {
+      buffer[n++] = static_cast<char>(c);
+    }
+    return n;
+  }
+  int peek() {
+    const int c = fgetc(file);
+    if (c != EOF) {
+      ungetc(c, file);
+    }
+    return c == EOF ? -1 : c;
+  }
+  int available() { return static_cast<int>(size() - position()); }
+
+  using Print::write;
+  size_t write(const uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buffer, const size_t size) override {
+    const size_t n = fwrite(buffer, 1, size, file);
+    hostSdStats.bytesWritten += n;
+    return n;
+  }
+  size_t write(const void* buffer, const size_t size) { return write(static_cast<const uint8_t*>(buffer), size); }
+  void flush() { fflush(file); }
+  bool sync() {
+    flush();
+    return true;
+  }
+  bool truncate(const uint64_t length) {
+    flush();
+    return ftruncate(fileno(file), static_cast<off_t>(length)) == 0;
+  }
+
+  bool seek(const uint64_t pos) { return seekSet(pos); }
+  bool seekSet(const uint64_t pos) {
+    hostSdStats.seeks++;
+    return fseek(file, static_cast<long>(pos), SEEK_SET) == 0;
+  }
+  bool seekCur(const int64_t offset) { return fseek(file, static_cast<long>(offset), SEEK_CUR) == 0; }
+  bool seekEnd(const int64_t offset = 0) { return fseek(file, static_cast<long>(offset), SEEK_END) == 0; }
+  uint64_t position() const { return ftell(file); }
+  uint64_t curPosition() const { return position(); }
+  uint64_t size() const {
+    struct stat st;
+    return fstat(fileno(file), &st) == 0 ? st.st_size : 0;
+  }
+  uint64_t fileSize() const { return size(); }
+
+  FsFile openNextFile() {
+    FsFile next;
+    if (!dir) {
+      return next;
+    }
+    const dirent* entry;
+    while ((entry = readdir(dir)) && entry->d_name[0] == '.') {
+    }
+    if (entry) {
+      next.open((path + "/" + entry->d_name).c_str());
+    }
+    return next;
+  }
+  bool openNext(FsFile* parent, oflag_t = O_RDONLY) {
+    *this = parent->openNextFile();
+    return isOpen();
+  }
+  void rewindDirectory() {
+    if (dir) {
+      rewinddir(dir);
+    }
+  }
+  size_t getName(char* buffer, const size_t size) const {
+    snprintf(buffer, size, "%s", name.c_str());
+    return name.size();
+  }
+};
+using File = FsFile;
+
+class SdFat {
+ public:
+  FsFile open(const char* path, const oflag_t flags = O_RDONLY) {
+    FsFile file;
+    file.open(path, flags);
+    return file;
+  }
+  bool mkdir(const char* path, const bool = true) {
+    const std::string command = "mkdir -p '" + hostPath(path) + "'";
+    return system(command.c_str()) == 0;
+  }
+  bool exists(const char* path) {
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+  }
+  bool remove(const char* path) { return ::remove(hostPath(path).c_str()) == 0; }
+  bool rmdir(const char* path) { return ::rmdir(hostPath(path).c_str()) == 0; }
+  bool rename(const char* from, const char* to) {
+    return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+  }
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Arduino String on top of std::string, only what the tested code calls
+class String : public std::string {
+ public:
+  using std::string::string;
+  String() = default;
+  String(const std::string& s) : std::string(s) {}
+  explicit String(const int value) : std::string(std::to_string(value)) {}
+
+  String operator+(const char* other) const { return String(static_cast<const std::string&>(*this) + other); }
+  String operator+(const String& other) const {
+    return String(static_cast<const std::string&>(*this) + static_cast<const std::string&>(other));
+  }
+  bool endsWith(const char* suffix) const {
+    const size_t n = strlen(suffix);
+    return size() >= n && compare(size() - n, n, suffix) == 0;
+  }
+  bool startsWith(const char* prefix) const { return rfind(prefix, 0) == 0; }
+  int indexOf(const char c) const {
+    const auto pos = find(c);
+    return pos == npos ? -1 : static_cast<int>(pos);
+  }
+  int lastIndexOf(const char c) const {
+    const auto pos = rfind(c);
+    return pos == npos ? -1 : static_cast<int>(pos);
+  }
+  String substring(const size_t from) const { return String(substr(from)); }
+  String substring(const size_t from, const size_t to) const { return String(substr(from, to - from)); }
+  int toInt() const { return atoi(c_str()); }
+};
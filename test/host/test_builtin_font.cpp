@@ -0,0 +1,111 @@
+#include <EpdFont.h>
+#include <builtinFonts/ubuntu_10_bold.h>
+#include <miniz.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "HostTest.h"
+
+namespace {
+// Every BMP codepoint through the page table gives what the interval search gives
+void checkPageTable(const EpdFontData* data, const EpdGlyphPageTable* table) {
+  int found = 0;
+  for (uint32_t cp = 0; cp < 0x10000; cp++) {
+    uint32_t fromIntervals = 0, fromTable = 0;
+    const bool inIntervals = EpdFont::findGlyphIndexInIntervals(data, cp, &fromIntervals);
+    const bool inTable = EpdFont::findGlyphIndexInPageTable(table, cp, &fromTable);
+    CHECK(inIntervals == inTable);
+    CHECK(!inIntervals || fromIntervals == fromTable);
+    found += inIntervals;
+  }
+  CHECK(found > 0);
+}
+
+void testGeneratedPageTableMatchesIntervals() { checkPageTable(&ubuntu_10_bold, ubuntu_10_bold.pageTable); }
+
+void testBuiltPageTableMatchesIntervals() {
+  EpdGlyphPageTable* table = EpdFont::buildPageTable(&ubuntu_10_bold);
+  CHECK(table != nullptr);
+  checkPageTable(&ubuntu_10_bold, table);
+  free(table);
+}
+
+void testPageTableOfSparseIntervals() {
+  // Single codepoints, runs across page and bits word boundaries, a whole page and glyphs beyond the BMP
+  static const EpdUnicodeInterval intervals[] = {
+      {0x20, 0x20, 0},
+      {0x7E, 0x81, 1},
+      {0xFF, 0x100, 5},
+      {0x1E0, 0x2FF, 7},
+      {0x4E00, 0x4EFF, 295},
+      {0xFFFF, 0xFFFF, 551},
+      {0x1F600, 0x1F601, 552},
+  };
+  EpdFontData data = {};
+  data.intervals = intervals;
+  data.intervalCount = sizeof(intervals) / sizeof(intervals[0]);
+  EpdGlyphPageTable* table = EpdFont::buildPageTable(&data);
+  CHECK(table != nullptr);
+  checkPageTable(&data, table);
+  free(table);
+}
+
+// Every block of the font inflated on its own, at its uncompressed offset. Bytes past the end of a block, which is
+// shorter than the block size when the next glyph didn't fit, are left out of inflated.
+std::vector<uint8_t> inflateAllBlocks(const EpdFontData* data, std::vector<bool>& inflated) {
+  const EpdBitmapBlocks* blocks = data->bitmapBlocks;
+  std::vector<uint8_t> bitmaps(blocks->blockCount * blocks->blockSize);
+  inflated.assign(bitmaps.size(), false);
+  for (uint32_t block = 0; block < blocks->blockCount; block++) {
+    const uint32_t start = blocks->offsets[block];
+    const size_t size = tinfl_decompress_mem_to_mem(&bitmaps[block * blocks->blockSize], blocks->blockSize,
+                                                    data->bitmap + start, blocks->offsets[block + 1] - start, 0);
+    CHECK(size != TINFL_DECOMPRESS_MEM_TO_MEM_FAILED && size <= blocks->blockSize);
+    std::fill_n(inflated.begin() + block * blocks->blockSize, size, true);
+  }
+  return bitmaps;
+}
+
+void testBlockDecodedBitmapsMatchRawInflate() {
+  const EpdFontData* data = &ubuntu_10_bold;
+  CHECK(data->bitmapBlocks != nullptr);
+  std::vector<bool> inflated;
+  const auto bitmaps = inflateAllBlocks(data, inflated);
+  const EpdUnicodeInterval& lastInterval = data->intervals[data->intervalCount - 1];
+  const uint32_t glyphCount = lastInterval.offset + lastInterval.last - lastInterval.first + 1;
+
+  // In glyph order, then in random order so the glyph cache and the block slots evict
+  std::vector<uint32_t> order(glyphCount);
+  for (uint32_t i = 0; i < glyphCount; i++) {
+    order[i] = i;
+  }
+  const EpdFont font(data);
+  std::mt19937 rng(5);
+  for (int pass = 0; pass < 3; pass++) {
+    for (const uint32_t i : order) {
+      const EpdGlyph* glyph = &data->glyph[i];
+      if (glyph->dataLength == 0) {
+        continue;
+      }
+      CHECK(glyph->dataOffset + glyph->dataLength <= bitmaps.size());
+      CHECK(inflated[glyph->dataOffset] && inflated[glyph->dataOffset + glyph->dataLength - 1]);
+      const uint8_t* bitmap = font.loadGlyphBitmap(glyph, nullptr);
+      CHECK(bitmap != nullptr);
+      CHECK(memcmp(bitmap, &bitmaps[glyph->dataOffset], glyph->dataLength) == 0);
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+  }
+}
+}  // namespace
+
+int main() {
+  RUN_TEST(testGeneratedPageTableMatchesIntervals);
+  RUN_TEST(testBuiltPageTableMatchesIntervals);
+  RUN_TEST(testPageTableOfSparseIntervals);
+  RUN_TEST(testBlockDecodedBitmapsMatchRawInflate);
+  return 0;
+}
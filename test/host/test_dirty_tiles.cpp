@@ -0,0 +1,98 @@
+#include <DirtyTiles.h>
+
+#include <cstring>
+#include <vector>
+
+#include "HostTest.h"
+
+namespace {
+// Same geometry as the panel: 800x480, 1 bit per pixel
+constexpr int WIDTH_BYTES = 100;
+constexpr int HEIGHT = 480;
+using Tiles = DirtyTiles<WIDTH_BYTES, HEIGHT>;
+
+// Stands in for the display: a frame buffer, and the panel contents that displayDirty would leave behind
+struct MockDisplay {
+  std::vector<uint8_t> frame = std::vector<uint8_t>(WIDTH_BYTES * HEIGHT, 0xFF);
+  std::vector<uint8_t> panel = frame;
+
+  void setPixel(const int x, const int y, const bool black) {
+    uint8_t& byte = frame[y * WIDTH_BYTES + x / 8];
+    const uint8_t bit = 0x80 >> (x % 8);
+    byte = black ? byte & ~bit : byte | bit;
+  }
+  void push(const Tiles::Window& window) {
+    for (int y = window.y; y < window.y + window.height; y++) {
+      memcpy(&panel[y * WIDTH_BYTES + window.x / 8], &frame[y * WIDTH_BYTES + window.x / 8], window.width / 8);
+    }
+  }
+};
+
+void testInvalidUntilUpdated() {
+  MockDisplay display;
+  Tiles tiles;
+  CHECK(!tiles.valid());
+  tiles.update(display.frame.data());
+  CHECK(tiles.valid());
+  tiles.invalidate();
+  CHECK(!tiles.valid());
+}
+
+void testUnchangedFrameIsEmpty() {
+  MockDisplay display;
+  Tiles tiles;
+  tiles.update(display.frame.data());
+  CHECK(tiles.diff(display.frame.data()).empty());
+}
+
+void testSinglePixelGivesItsTile() {
+  MockDisplay display;
+  Tiles tiles;
+  tiles.update(display.frame.data());
+  display.setPixel(85, 30, true);
+  const auto window = tiles.diff(display.frame.data());
+  CHECK(window.x == 80 && window.y == 24 && window.width == 80 && window.height == 24);
+  CHECK(window.coveragePercent() == 0);
+  // The diff recorded the new frame
+  CHECK(tiles.diff(display.frame.data()).empty());
+}
+
+void testWindowBoundsAllChanges() {
+  MockDisplay display;
+  Tiles tiles;
+  tiles.update(display.frame.data());
+  display.setPixel(0, 0, true);
+  display.setPixel(799, 479, true);
+  const auto window = tiles.diff(display.frame.data());
+  CHECK(window.x == 0 && window.y == 0 && window.width == 800 && window.height == 480);
+  CHECK(window.coveragePercent() == 100);
+}
+
+void testPushingWindowsKeepsPanelInSync() {
+  MockDisplay display;
+  Tiles tiles;
+  tiles.update(display.frame.data());
+  unsigned seed = 7;
+  for (int round = 0; round < 200; round++) {
+    // A few scattered pixels per round, sometimes reverting earlier ones
+    for (int i = 0; i < 1 + round % 4; i++) {
+      seed = seed * 1103515245 + 12345;
+      display.setPixel((seed >> 8) % 800, (seed >> 18) % 480, (seed & 1) != 0);
+    }
+    const auto window = tiles.diff(display.frame.data());
+    CHECK(window.x % 8 == 0 && window.width % 8 == 0);
+    CHECK(window.x + window.width <= 800 && window.y + window.height <= HEIGHT);
+    display.push(window);
+    CHECK(display.panel == display.frame);
+  }
+}
+}  // namespace
+
+int main() {
+  RUN_TEST(testInvalidUntilUpdated);
+  RUN_TEST(testUnchangedFrameIsEmpty);
+  RUN_TEST(testSinglePixelGivesItsTile);
+  RUN_TEST(testWindowBoundsAllChanges);
+  RUN_TEST(testPushingWindowsKeepsPanelInSync);
+  return 0;
+}
@@ -0,0 +1,220 @@
+#include <CodepointSet.h>
+#include <CustomEpdFont.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "EpdFontFile.h"
+#include "HostTest.h"
+#include "SyntheticFont.h"
+
+namespace {
+constexpr const char* TEST_DIR = "/font_subset";
+
+std::string devicePath(const char* name) { return std::string(TEST_DIR) + "/" + name; }
+
+std::vector<uint8_t> readHostFile(const std::string& path) {
+  std::ifstream in(hostPath(path.c_str()), std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// The synthetic font as a v1 .epdfont, the format the subsets are written in
+bool writeFontFile(const SyntheticFont& font, const std::string& path) {
+  const uint32_t intervalCount = font.intervals.size();
+  const uint32_t glyphCount = font.glyphs.size();
+  const uint32_t offsets[] = {32, static_cast<uint32_t>(32 + intervalCount * sizeof(EpdUnicodeInterval)),
+                              static_cast<uint32_t>(32 + intervalCount * sizeof(EpdUnicodeInterval) + glyphCount * 16)};
+  uint8_t header[32] = {'E', 'P', 'D', 'F', 1, 0, font.data.is2Bit};
+  header[8] = font.data.advanceY;
+  header[9] = static_cast<uint8_t>(font.data.ascender);
+  header[10] = static_cast<uint8_t>(font.data.descender);
+  memcpy(header + 12, &intervalCount, 4);
+  memcpy(header + 16, &glyphCount, 4);
+  memcpy(header + 20, offsets, sizeof(offsets));
+
+  std::vector<uint8_t> bytes(header, header + sizeof(header));
+  const auto* intervals = reinterpret_cast<const uint8_t*>(font.intervals.data());
+  bytes.insert(bytes.end(), intervals, intervals + intervalCount * sizeof(EpdUnicodeInterval));
+  for (const EpdGlyph& glyph : font.glyphs) {
+    uint8_t record[16] = {glyph.width, glyph.height, glyph.advanceX, 0};
+    memcpy(record + 4, &glyph.left, 2);
+    memcpy(record + 6, &glyph.top, 2);
+    memcpy(record + 8, &glyph.dataLength, 4);
+    memcpy(record + 12, &glyph.dataOffset, 4);
+    bytes.insert(bytes.end(), record, record + sizeof(record));
+  }
+  bytes.insert(bytes.end(), font.bitmaps.begin(), font.bitmaps.end());
+
+  FsFile file;
+  return SdMan.openFileForWrite("TST", path, file) && file.write(bytes.data(), bytes.size()) == bytes.size();
+}
+
+// Codepoints of the synthetic font with gaps of every size, plus some the font doesn't have
+void randomCharset(std::mt19937& rng, CodepointSet& set) {
+  for (uint32_t cp = 0x20; cp <= 0x7E; cp++) {
+    if (rng() % 3 != 0) {
+      set.add(cp);
+    }
+  }
+  for (uint32_t cp = SyntheticFont::CJK_FIRST; cp < SyntheticFont::CJK_FIRST + 600; cp++) {
+    if (rng() % 4 == 0) {
+      set.add(cp);
+    }
+  }
+  for (const uint32_t cp : {0x0A, 0xA0, 0x3001, 0xFF0C, 0x20000, 0x2A6D6}) {
+    set.add(cp);
+  }
+}
+
+void testCodepointSetWalk() {
+  std::mt19937 rng(11);
+  CodepointSet set;
+  std::vector<uint32_t> expected;
+  for (int i = 0; i < 3000; i++) {
+    // Mostly clustered in a few BMP pages, some anywhere, some astral
+    const uint32_t pick = rng() % 8;
+    set.add(pick < 5 ? 0x4E00 + rng() % 700 : pick < 7 ? rng() % 0x10000 : 0x10000 + rng() % 0x100000);
+  }
+  set.forEach([&](const uint32_t cp) { expected.push_back(cp); });
+  CHECK(expected.size() == set.size());
+
+  std::vector<uint32_t> walked;
+  uint32_t cp;
+  for (uint32_t from = 0; set.next(from, &cp); from = cp + 1) {
+    walked.push_back(cp);
+  }
+  CHECK(walked == expected);
+
+  // From anywhere, including word and page boundaries
+  for (int i = 0; i < 2000; i++) {
+    const uint32_t from = i < 1000 ? rng() % 0x11000 : (rng() % 0x110) << (rng() % 2 ? 5 : 8);
+    const auto it = std::lower_bound(expected.begin(), expected.end(), from);
+    CHECK(set.next(from, &cp) == (it != expected.end()));
+    CHECK(it == expected.end() || cp == *it);
+  }
+
+  CodepointSet copy;
+  copy.add(0x41);
+  CHECK(copy.copyFrom(set));
+  CHECK(copy.size() == set.size());
+  std::vector<uint32_t> copied;
+  copy.forEach([&](const uint32_t cp) { copied.push_back(cp); });
+  CHECK(copied == expected);
+  // The copy owns its pages
+  set.clear();
+  CHECK(copy.contains(expected.front()) && copy.contains(expected.back()));
+
+  CodepointSet empty;
+  CHECK(!empty.next(0, &cp));
+}
+
+void testSteppedWriteMatchesWholeWrite() {
+  for (const bool is2Bit : {false, true}) {
+    std::mt19937 rng(is2Bit ? 13 : 12);
+    const SyntheticFont synthetic(is2Bit, is2Bit ? 5 : 4, 600);
+    const std::string sourcePath = devicePath("source.epdfont");
+    CHECK(writeFontFile(synthetic, sourcePath));
+    EpdFontFile source;
+    CHECK(source.load(sourcePath.c_str(), 32, 8 * 1024));
+
+    CodepointSet charset;
+    randomCharset(rng, charset);
+    const std::string wholePath = devicePath("whole.epdfont");
+    CHECK(source.font->writeSubset(charset, wholePath.c_str()));
+    const std::vector<uint8_t> whole = readHostFile(wholePath);
+
+    for (const uint32_t glyphsPerStep : {1u, 7u, 100u}) {
+      const std::string steppedPath = devicePath("stepped.epdfont");
+      CustomEpdFont::SubsetWriter writer(*source.font, steppedPath.c_str());
+      CodepointSet changing;
+      CHECK(changing.copyFrom(charset));
+      CHECK(writer.begin(changing));
+      int steps = 0;
+      while (!writer.done()) {
+        CHECK(writer.step(glyphsPerStep));
+        steps++;
+        // Between steps the font keeps drawing and the book keeps adding characters, neither may leak into the file
+        for (int i = 0; i < 3; i++) {
+          const uint32_t cp = SyntheticFont::CJK_FIRST + rng() % 600;
+          const EpdGlyph* glyph = source.font->getGlyph(cp);
+          CHECK(glyph && source.font->loadGlyphBitmap(glyph, nullptr));
+          changing.add(cp);
+        }
+      }
+      CHECK(steps > 1);
+      CHECK(writer.step(glyphsPerStep));
+      CHECK(readHostFile(steppedPath) == whole);
+    }
+
+    // The subset serves the glyphs of the charset the font has, with their source metrics and bitmaps. (Characters the
+    // font lacks may still get a lookalike through CustomEpdFont's fallbacks.)
+    EpdFontFile subset;
+    CHECK(subset.load(wholePath.c_str(), 32, 8 * 1024));
+    CHECK(subset.font->getData()->is2Bit == is2Bit);
+    std::vector<uint8_t> buffer(4096);
+    charset.forEach([&](const uint32_t cp) {
+      const EpdGlyph* expected = synthetic.font.getGlyph(cp);
+      const EpdGlyph* glyph = subset.font->getGlyph(cp);
+      if (!expected) {
+        return;
+      }
+      CHECK(glyph);
+      CHECK(glyph->width == expected->width && glyph->height == expected->height &&
+            glyph->advanceX == expected->advanceX && glyph->left == expected->left && glyph->top == expected->top &&
+            glyph->dataLength == expected->dataLength);
+      const uint8_t* bitmap = subset.font->loadGlyphBitmap(glyph, buffer.data());
+      CHECK(expected->dataLength == 0 ||
+            (bitmap && memcmp(bitmap, synthetic.bitmaps.data() + expected->dataOffset, expected->dataLength) == 0));
+    });
+  }
+}
+
+void testUnfinishedWriteLeavesNoFile() {
+  std::mt19937 rng(14);
+  const SyntheticFont synthetic(false, 6, 600);
+  const std::string sourcePath = devicePath("source.epdfont");
+  CHECK(writeFontFile(synthetic, sourcePath));
+  EpdFontFile source;
+  CHECK(source.load(sourcePath.c_str()));
+  CodepointSet charset;
+  randomCharset(rng, charset);
+
+  const std::string path = devicePath("unfinished.epdfont");
+  {
+    CustomEpdFont::SubsetWriter writer(*source.font, path.c_str());
+    CHECK(writer.begin(charset));
+    CHECK(writer.step(10));
+    CHECK(!writer.done());
+    CHECK(SdMan.exists(path.c_str()));
+  }
+  CHECK(!SdMan.exists(path.c_str()));
+
+  // Nothing of the charset in the font: no file at all
+  CodepointSet missing;
+  missing.add(0x3001);
+  CustomEpdFont::SubsetWriter writer(*source.font, path.c_str());
+  CHECK(!writer.begin(missing));
+  CHECK(!writer.step(10));
+  CHECK(!SdMan.exists(path.c_str()));
+
+  // Steps on a writer that never began fail too
+  CustomEpdFont::SubsetWriter unbegun(*source.font, path.c_str());
+  CHECK(!unbegun.step(10));
+  CHECK(!unbegun.done());
+}
+}  // namespace
+
+int main() {
+  SdMan.begin();
+  SdMan.removeDir(TEST_DIR);
+  SdMan.mkdir(TEST_DIR);
+  RUN_TEST(testCodepointSetWalk);
+  RUN_TEST(testSteppedWriteMatchesWholeWrite);
+  RUN_TEST(testUnfinishedWriteLeavesNoFile);
+  return 0;
+}
@@ -0,0 +1,120 @@
+#include <GfxRenderer.h>
+
+#include <algorithm>
+#include <random>
+
+#include "HostTest.h"
+#include "ReferenceFrame.h"
+
+namespace {
+constexpr GfxRenderer::Orientation ORIENTATIONS[] = {GfxRenderer::Portrait, GfxRenderer::LandscapeClockwise,
+                                                     GfxRenderer::PortraitInverted,
+                                                     GfxRenderer::LandscapeCounterClockwise};
+
+EInkDisplay display;
+
+// Starts from noise, so both clearing and setting bits show up against the reference
+void randomizeFrame(std::mt19937& rng) {
+  uint8_t* frameBuffer = display.getFrameBuffer();
+  for (uint32_t i = 0; i < EInkDisplay::BUFFER_SIZE; i++) {
+    frameBuffer[i] = rng();
+  }
+}
+
+int randomIn(std::mt19937& rng, const int low, const int high) {
+  return low + static_cast<int>(rng() % (high - low + 1));
+}
+
+void testRandomClippedRects() {
+  std::mt19937 rng(4);
+  GfxRenderer renderer(display);
+  for (const auto orientation : ORIENTATIONS) {
+    renderer.setOrientation(orientation);
+    randomizeFrame(rng);
+    ReferenceFrame reference(display.getFrameBuffer());
+    const int width = renderer.getScreenWidth();
+    const int height = renderer.getScreenHeight();
+    for (int i = 0; i < 1500; i++) {
+      // Rectangles anywhere from fully off screen to larger than the screen, including empty and negative sizes
+      const int x = randomIn(rng, -width / 2, width + 20);
+      const int y = randomIn(rng, -height / 2, height + 20);
+      const int w = i % 4 == 0 ? randomIn(rng, -3, 12) : randomIn(rng, -3, width + width / 2);
+      const int h = i % 4 == 1 ? randomIn(rng, -3, 12) : randomIn(rng, -3, height + height / 2);
+      const bool black = rng() & 1;
+      renderer.fillRect(x, y, w, h, black);
+      reference.fillRect(renderer, x, y, w, h, black);
+      CHECK(reference.matches(display.getFrameBuffer()));
+    }
+  }
+}
+
+void testRandomAxisLines() {
+  std::mt19937 rng(5);
+  GfxRenderer renderer(display);
+  for (const auto orientation : ORIENTATIONS) {
+    renderer.setOrientation(orientation);
+    randomizeFrame(rng);
+    ReferenceFrame reference(display.getFrameBuffer());
+    const int width = renderer.getScreenWidth();
+    const int height = renderer.getScreenHeight();
+    for (int i = 0; i < 1500; i++) {
+      // Endpoints in either order and past the edges
+      int x1 = randomIn(rng, -40, width + 40);
+      int y1 = randomIn(rng, -40, height + 40);
+      int x2 = x1;
+      int y2 = y1;
+      if (i % 2 == 0) {
+        x2 = randomIn(rng, -40, width + 40);
+      } else {
+        y2 = randomIn(rng, -40, height + 40);
+      }
+      const bool black = rng() & 1;
+      renderer.drawLine(x1, y1, x2, y2, black);
+      reference.fillRect(renderer, std::min(x1, x2), std::min(y1, y2), std::abs(x2 - x1) + 1, std::abs(y2 - y1) + 1,
+                         black);
+      CHECK(reference.matches(display.getFrameBuffer()));
+    }
+  }
+}
+
+// Narrow fills are the masked partial-byte cases: one byte, two bytes, and two partial bytes around a full one. Every
+// orientation maps one logical axis onto panel rows, so starting at every offset along both axes, at either end of
+// the screen, hits every bit offset within a framebuffer byte.
+void testNarrowFillsAtEveryBitOffset() {
+  std::mt19937 rng(6);
+  GfxRenderer renderer(display);
+  for (const auto orientation : ORIENTATIONS) {
+    renderer.setOrientation(orientation);
+    const int width = renderer.getScreenWidth();
+    const int height = renderer.getScreenHeight();
+    for (const bool black : {true, false}) {
+      randomizeFrame(rng);
+      ReferenceFrame reference(display.getFrameBuffer());
+      for (int size = 1; size <= 9; size++) {
+        for (int offset = -8; offset < 16; offset++) {
+          const int farX = width - 16 + offset;
+          const int farY = height - 16 + offset;
+          const int depth = 1 + offset % 3 + (offset < 0 ? 3 : 0);
+          // Narrow along x, then along y, at the near and the far edge
+          renderer.fillRect(offset, 37, size, depth, black);
+          reference.fillRect(renderer, offset, 37, size, depth, black);
+          renderer.fillRect(farX, 53, size, depth, black);
+          reference.fillRect(renderer, farX, 53, size, depth, black);
+          renderer.fillRect(41, offset, depth, size, black);
+          reference.fillRect(renderer, 41, offset, depth, size, black);
+          renderer.fillRect(59, farY, depth, size, black);
+          reference.fillRect(renderer, 59, farY, depth, size, black);
+          CHECK(reference.matches(display.getFrameBuffer()));
+        }
+      }
+    }
+  }
+}
+}  // namespace
+
+int main() {
+  RUN_TEST(testRandomClippedRects);
+  RUN_TEST(testRandomAxisLines);
+  RUN_TEST(testNarrowFillsAtEveryBitOffset);
+  return 0;
+}
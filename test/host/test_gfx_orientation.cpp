@@ -0,0 +1,249 @@
+#include <GfxRenderer.h>
+#include <Utf8.h>
+
+#include <random>
+#include <string>
+
+#include "BmpFile.h"
+#include "HostTest.h"
+#include "ReferenceFrame.h"
+#include "SyntheticFont.h"
+
+namespace {
+constexpr GfxRenderer::Orientation ORIENTATIONS[] = {GfxRenderer::Portrait, GfxRenderer::LandscapeClockwise,
+                                                     GfxRenderer::PortraitInverted,
+                                                     GfxRenderer::LandscapeCounterClockwise};
+constexpr GfxRenderer::RenderMode RENDER_MODES[] = {GfxRenderer::BW, GfxRenderer::GRAYSCALE_LSB,
+                                                    GfxRenderer::GRAYSCALE_MSB};
+constexpr int FONT_1BIT = 1;
+constexpr int FONT_2BIT = 2;
+constexpr const char* DIR = "/gfx_orientation";
+
+EInkDisplay display;
+
+void randomizeFrame(std::mt19937& rng) {
+  uint8_t* frameBuffer = display.getFrameBuffer();
+  for (uint32_t i = 0; i < EInkDisplay::BUFFER_SIZE; i++) {
+    frameBuffer[i] = rng();
+  }
+}
+
+int randomIn(std::mt19937& rng, const int low, const int high) {
+  return low + static_cast<int>(rng() % (high - low + 1));
+}
+
+// Glyph by glyph and pixel by pixel, as drawText placed text before glyphs were blitted by panel rows
+void referenceText(ReferenceFrame& reference, const GfxRenderer& renderer, const GfxRenderer::RenderMode mode,
+                   const EpdFont& font, const int x, const int y, const std::string& text, const bool black) {
+  const EpdFontData* data = font.getData();
+  const auto* p = reinterpret_cast<const unsigned char*>(text.c_str());
+  int penX = x;
+  const int baseline = y + data->ascender;
+  while (const uint32_t cp = utf8NextCodepoint(&p)) {
+    const EpdGlyph* glyph = font.getGlyph(cp);
+    CHECK(glyph);
+    const uint8_t* bitmap = font.loadGlyphBitmap(glyph, nullptr);
+    for (int glyphY = 0; glyphY < glyph->height; glyphY++) {
+      for (int glyphX = 0; glyphX < glyph->width; glyphX++) {
+        const int pixelPosition = glyphY * glyph->width + glyphX;
+        const int screenX = penX + glyph->left + glyphX;
+        const int screenY = baseline - glyph->top + glyphY;
+        if (!data->is2Bit) {
+          if (bitmap[pixelPosition / 8] >> (7 - pixelPosition % 8) & 1) {
+            reference.setPixel(renderer, screenX, screenY, black);
+          }
+          continue;
+        }
+        // 0 white, 1 light gray, 2 dark gray, 3 black
+        const int value = bitmap[pixelPosition / 4] >> ((3 - pixelPosition % 4) * 2) & 3;
+        if (mode == GfxRenderer::BW && value != 0) {
+          reference.setPixel(renderer, screenX, screenY, black);
+        } else if (mode == GfxRenderer::GRAYSCALE_MSB && (value == 1 || value == 2)) {
+          reference.setPixel(renderer, screenX, screenY, false);
+        } else if (mode == GfxRenderer::GRAYSCALE_LSB && value == 2) {
+          reference.setPixel(renderer, screenX, screenY, false);
+        }
+      }
+    }
+    penX += glyph->advanceX;
+  }
+}
+
+void testRotateCoordinates() {
+  GfxRenderer renderer(display);
+  // Panel position of the logical top left and top right corners
+  const int corners[][4] = {{0, 479, 0, 0}, {799, 479, 0, 479}, {799, 0, 799, 479}, {0, 0, 799, 0}};
+  for (int i = 0; i < 4; i++) {
+    renderer.setOrientation(ORIENTATIONS[i]);
+    const int width = renderer.getScreenWidth();
+    const int height = renderer.getScreenHeight();
+    int panelX = 0;
+    int panelY = 0;
+    renderer.rotateCoordinates(0, 0, &panelX, &panelY);
+    CHECK(panelX == corners[i][0] && panelY == corners[i][1]);
+    renderer.rotateCoordinates(width - 1, 0, &panelX, &panelY);
+    CHECK(panelX == corners[i][2] && panelY == corners[i][3]);
+
+    // Every logical pixel lands on its own panel pixel
+    std::vector<bool> hit(EInkDisplay::DISPLAY_WIDTH * EInkDisplay::DISPLAY_HEIGHT);
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        renderer.rotateCoordinates(x, y, &panelX, &panelY);
+        CHECK(panelX >= 0 && panelX < EInkDisplay::DISPLAY_WIDTH && panelY >= 0 &&
+              panelY < EInkDisplay::DISPLAY_HEIGHT);
+        CHECK(!hit[panelY * EInkDisplay::DISPLAY_WIDTH + panelX]);
+        hit[panelY * EInkDisplay::DISPLAY_WIDTH + panelX] = true;
+      }
+    }
+  }
+}
+
+void testPixelsAndOutlines() {
+  std::mt19937 rng(7);
+  GfxRenderer renderer(display);
+  for (const auto orientation : ORIENTATIONS) {
+    renderer.setOrientation(orientation);
+    randomizeFrame(rng);
+    ReferenceFrame reference(display.getFrameBuffer());
+    const int width = renderer.getScreenWidth();
+    const int height = renderer.getScreenHeight();
+    for (int i = 0; i < 4000; i++) {
+      const int x = randomIn(rng, -3, width + 2);
+      const int y = randomIn(rng, -3, height + 2);
+      const bool black = rng() & 1;
+      renderer.drawPixel(x, y, black);
+      reference.setPixel(renderer, x, y, black);
+    }
+    CHECK(reference.matches(display.getFrameBuffer()));
+
+    for (int i = 0; i < 300; i++) {
+      const int x = randomIn(rng, -40, width);
+      const int y = randomIn(rng, -40, height);
+      const int w = randomIn(rng, 1, 200);
+      const int h = randomIn(rng, 1, 200);
+      const bool black = rng() & 1;
+      renderer.drawRect(x, y, w, h, black);
+      reference.fillRect(renderer, x, y, w, 1, black);
+      reference.fillRect(renderer, x, y + h - 1, w, 1, black);
+      reference.fillRect(renderer, x, y, 1, h, black);
+      reference.fillRect(renderer, x + w - 1, y, 1, h, black);
+      CHECK(reference.matches(display.getFrameBuffer()));
+    }
+  }
+}
+
+void testText() {
+  std::mt19937 rng(8);
+  GfxRenderer renderer(display);
+  const SyntheticFont oneBit(false, 1);
+  const SyntheticFont twoBit(true, 2);
+  renderer.insertFont(FONT_1BIT, EpdFontFamily(&oneBit.font));
+  renderer.insertFont(FONT_2BIT, EpdFontFamily(&twoBit.font));
+
+  for (const auto orientation : ORIENTATIONS) {
+    renderer.setOrientation(orientation);
+    const int width = renderer.getScreenWidth();
+    const int height = renderer.getScreenHeight();
+    for (const auto mode : RENDER_MODES) {
+      renderer.setRenderMode(mode);
+      randomizeFrame(rng);
+      ReferenceFrame reference(display.getFrameBuffer());
+      for (int i = 0; i < 200; i++) {
+        // Lines starting anywhere, so glyphs are clipped at every edge
+        const bool is2Bit = i % 2;
+        const SyntheticFont& font = is2Bit ? twoBit : oneBit;
+        const std::string text = font.randomText(rng, randomIn(rng, 1, 30));
+        const int x = randomIn(rng, -60, width + 10);
+        const int y = randomIn(rng, -50, height + 10);
+        const bool black = rng() % 4 != 0;
+        if (i % 3 == 0) {
+          // The same line through drawTextRun, split into two words
+          const size_t split = text.find(' ');
+          const int splitX = randomIn(rng, 0, 300);
+          const std::string first = text.substr(0, split);
+          const std::string second = split == std::string::npos ? "" : text.substr(split + 1);
+          const GfxRenderer::TextRunWord words[] = {{first.c_str(), 0, EpdFontFamily::REGULAR},
+                                                    {second.c_str(), splitX, EpdFontFamily::REGULAR}};
+          renderer.drawTextRun(is2Bit ? FONT_2BIT : FONT_1BIT, x, y, words, 2, black);
+          referenceText(reference, renderer, mode, font.font, x, y, first, black);
+          referenceText(reference, renderer, mode, font.font, x + splitX, y, second, black);
+        } else {
+          renderer.drawText(is2Bit ? FONT_2BIT : FONT_1BIT, x, y, text.c_str(), black);
+          referenceText(reference, renderer, mode, font.font, x, y, text, black);
+        }
+        CHECK(reference.matches(display.getFrameBuffer()));
+      }
+    }
+  }
+}
+
+// Unscaled bitmaps placed anywhere across the left and right edges. They stay within the screen vertically: rows
+// above the top are skipped without being read, which is how drawBitmap has always behaved.
+void testBitmaps() {
+  std::mt19937 rng(9);
+  SdMan.removeDir(DIR);
+  SdMan.mkdir(DIR);
+  GfxRenderer renderer(display);
+
+  for (const int bpp : {1, 2}) {
+    for (const bool topDown : {false, true}) {
+      const int bmpWidth = randomIn(rng, 20, 90);
+      const int bmpHeight = randomIn(rng, 20, 90);
+      std::vector<uint8_t> values(bmpWidth * bmpHeight);
+      for (auto& value : values) {
+        value = bpp == 1 ? (rng() & 1) * 3 : rng() % 4;
+      }
+      const std::string path = std::string(DIR) + "/image.bmp";
+      CHECK(writeBmp(path.c_str(), bmpWidth, bmpHeight, bpp, values, topDown));
+
+      for (const auto orientation : ORIENTATIONS) {
+        renderer.setOrientation(orientation);
+        const int width = renderer.getScreenWidth();
+        const int height = renderer.getScreenHeight();
+        for (const auto mode : RENDER_MODES) {
+          renderer.setRenderMode(mode);
+          randomizeFrame(rng);
+          ReferenceFrame reference(display.getFrameBuffer());
+          for (int i = 0; i < 6; i++) {
+            const int x = randomIn(rng, -bmpWidth, width);
+            const int y = randomIn(rng, 0, height - bmpHeight);
+            FsFile file;
+            CHECK(SdMan.openFileForRead("TST", path, file));
+            Bitmap bitmap(file);
+            CHECK(bitmap.parseHeaders() == BmpReaderError::Ok);
+            renderer.drawBitmap(bitmap, x, y, 0, 0);
+
+            for (int bmpY = 0; bmpY < bmpHeight; bmpY++) {
+              for (int bmpX = 0; bmpX < bmpWidth; bmpX++) {
+                const uint8_t value = values[bmpY * bmpWidth + bmpX];
+                if (bpp == 1) {
+                  // 1-bit bitmaps draw black only, whatever the render mode
+                  if (value < 3) {
+                    reference.setPixel(renderer, x + bmpX, y + bmpY, true);
+                  }
+                } else if (mode == GfxRenderer::BW && value < 3) {
+                  reference.setPixel(renderer, x + bmpX, y + bmpY, true);
+                } else if (mode == GfxRenderer::GRAYSCALE_MSB && (value == 1 || value == 2)) {
+                  reference.setPixel(renderer, x + bmpX, y + bmpY, false);
+                } else if (mode == GfxRenderer::GRAYSCALE_LSB && value == 1) {
+                  reference.setPixel(renderer, x + bmpX, y + bmpY, false);
+                }
+              }
+            }
+            CHECK(reference.matches(display.getFrameBuffer()));
+          }
+        }
+      }
+    }
+  }
+}
+}  // namespace
+
+int main() {
+  SdMan.begin();
+  RUN_TEST(testRotateCoordinates);
+  RUN_TEST(testPixelsAndOutlines);
+  RUN_TEST(testText);
+  RUN_TEST(testBitmaps);
+  return 0;
+}
@@ -0,0 +1,125 @@
+#include <CustomEpdFont.h>
+
+#include <random>
+#include <vector>
+
+#include "HostTest.h"
+
+namespace {
+// Same encoding as encode_pixel_runs() in fontconvert.py
+std::vector<uint8_t> encode(const std::vector<uint8_t>& packed, const uint32_t pixelCount, const int bitsPerPixel) {
+  const int lengthBits = 8 - bitsPerPixel;
+  const uint32_t maxRun = 1u << lengthBits;
+  const int pixelsPerByte = 8 / bitsPerPixel;
+  std::vector<uint8_t> out;
+  int value = -1;
+  uint32_t run = 0;
+  for (uint32_t i = 0; i < pixelCount; i++) {
+    const int shift = 8 - bitsPerPixel * (i % pixelsPerByte + 1);
+    const int pixel = (packed[i / pixelsPerByte] >> shift) & ((1 << bitsPerPixel) - 1);
+    if (pixel == value && run < maxRun) {
+      run++;
+      continue;
+    }
+    if (run > 0) {
+      out.push_back(value << lengthBits | (run - 1));
+    }
+    value = pixel;
+    run = 1;
+  }
+  if (run > 0) {
+    out.push_back(value << lengthBits | (run - 1));
+  }
+  return out;
+}
+
+// Random bitmap made of runs, some longer than one encoded byte can hold. Padding bits of the last byte are zero, as in
+// the bitmaps fontconvert.py packs.
+std::vector<uint8_t> randomBitmap(std::mt19937& rng, const uint32_t pixelCount, const int bitsPerPixel) {
+  std::vector<uint8_t> packed((pixelCount * bitsPerPixel + 7) / 8, 0);
+  const int pixelsPerByte = 8 / bitsPerPixel;
+  int pixel = 0;
+  uint32_t left = 0;
+  for (uint32_t i = 0; i < pixelCount; i++) {
+    if (left == 0) {
+      pixel = rng() % (1 << bitsPerPixel);
+      left = rng() % 4 == 0 ? 1 + rng() % 300 : 1 + rng() % 6;
+    }
+    left--;
+    packed[i / pixelsPerByte] |= pixel << (8 - bitsPerPixel * (i % pixelsPerByte + 1));
+  }
+  return packed;
+}
+
+void roundTrip(const int bitsPerPixel) {
+  std::mt19937 rng(bitsPerPixel);
+  for (int i = 0; i < 2000; i++) {
+    const uint32_t width = 1 + rng() % 40;
+    const uint32_t height = 1 + rng() % 40;
+    const uint32_t pixelCount = width * height;
+    const auto packed = randomBitmap(rng, pixelCount, bitsPerPixel);
+    const auto runs = encode(packed, pixelCount, bitsPerPixel);
+    // Sized exactly, so the sanitizer catches a write past the bitmap
+    std::vector<uint8_t> decoded(packed.size(), 0xA5);
+    CHECK(CustomEpdFont::decodePixelRuns(runs.data(), runs.size(), decoded.data(), pixelCount, bitsPerPixel));
+    CHECK(decoded == packed);
+  }
+}
+
+void testOneBitRoundTrip() { roundTrip(1); }
+
+void testTwoBitRoundTrip() { roundTrip(2); }
+
+void testLongestRuns() {
+  // One byte holds up to 128 pixels at 1 bit and 64 at 2 bits
+  uint8_t decoded[32];
+  const uint8_t oneBit[] = {0xFF, 0x7F};
+  CHECK(CustomEpdFont::decodePixelRuns(oneBit, 2, decoded, 256, 1));
+  CHECK(decoded[0] == 0xFF && decoded[15] == 0xFF && decoded[16] == 0x00 && decoded[31] == 0x00);
+  const uint8_t twoBit[] = {0xBF, 0x40};
+  CHECK(CustomEpdFont::decodePixelRuns(twoBit, 2, decoded, 65, 2));
+  CHECK(decoded[0] == 0xAA && decoded[15] == 0xAA && decoded[16] == 0x40);
+}
+
+void testMalformedRuns() {
+  uint8_t decoded[16] = {};
+  // Runs past the end of the bitmap fail before anything is written past it
+  const uint8_t tooLong[] = {0x07, 0x83};
+  CHECK(!CustomEpdFont::decodePixelRuns(tooLong, 2, decoded, 10, 1));
+  const uint8_t oneTooMany[] = {0x3F, 0x00};
+  CHECK(!CustomEpdFont::decodePixelRuns(oneTooMany, 2, decoded, 64, 2));
+  // Runs that stop short of it
+  const uint8_t tooShort[] = {0x02, 0x81};
+  CHECK(!CustomEpdFont::decodePixelRuns(tooShort, 2, decoded, 10, 1));
+  CHECK(!CustomEpdFont::decodePixelRuns(tooShort, 0, decoded, 1, 1));
+  // Only an empty bitmap matches no runs
+  CHECK(CustomEpdFont::decodePixelRuns(tooShort, 0, decoded, 0, 1));
+
+  // Truncated and corrupted encodings of real bitmaps
+  std::mt19937 rng(3);
+  for (const int bitsPerPixel : {1, 2}) {
+    for (int i = 0; i < 500; i++) {
+      const uint32_t pixelCount = 1 + rng() % 900;
+      const auto packed = randomBitmap(rng, pixelCount, bitsPerPixel);
+      auto runs = encode(packed, pixelCount, bitsPerPixel);
+      std::vector<uint8_t> out(packed.size());
+      CHECK(!CustomEpdFont::decodePixelRuns(runs.data(), runs.size() - 1, out.data(), pixelCount, bitsPerPixel));
+      // Lengthening any run makes the total overshoot
+      const size_t at = rng() % runs.size();
+      const uint8_t lengthMask = (1 << (8 - bitsPerPixel)) - 1;
+      if ((runs[at] & lengthMask) != lengthMask) {
+        runs[at]++;
+        CHECK(!CustomEpdFont::decodePixelRuns(runs.data(), runs.size(), out.data(), pixelCount, bitsPerPixel));
+      }
+    }
+  }
+}
+}  // namespace
+
+int main() {
+  RUN_TEST(testOneBitRoundTrip);
+  RUN_TEST(testTwoBitRoundTrip);
+  RUN_TEST(testLongestRuns);
+  RUN_TEST(testMalformedRuns);
+  return 0;
+}
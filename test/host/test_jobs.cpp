@@ -0,0 +1,128 @@
+#include <Jobs.h>
+
+#include <string>
+
+#include "HostTest.h"
+
+namespace {
+unsigned long now = 0;
+unsigned long fakeClock() { return now; }
+
+// Does units of work that each take costMs of the fake clock, counting them and its own destruction
+class CountJob final : public Job {
+  int units;
+  const unsigned long costMs;
+  int& done;
+  int& destroyed;
+
+ public:
+  CountJob(const int units, const unsigned long costMs, int& done, int& destroyed)
+      : units(units), costMs(costMs), done(done), destroyed(destroyed) {}
+  ~CountJob() override { destroyed++; }
+
+  State resume(const Deadline& deadline) override {
+    do {
+      now += costMs;
+      done++;
+      if (--units == 0) {
+        return State::Done;
+      }
+    } while (!deadline.expired());
+    return State::Running;
+  }
+};
+
+void testEveryJobProgressesEachSlice() {
+  int doneA = 0, doneB = 0, destroyedA = 0, destroyedB = 0;
+  JobScheduler jobs(fakeClock);
+  CHECK(!jobs.add(nullptr));
+  jobs.add(std::unique_ptr<Job>(new CountJob(100, 5, doneA, destroyedA)));
+  jobs.add(std::unique_ptr<Job>(new CountJob(3, 50, doneB, destroyedB)));
+
+  // The first job uses up the slice, the second still gets one unit
+  CHECK(jobs.runFor(30));
+  CHECK(doneA == 6 && doneB == 1);
+  CHECK(jobs.runFor(30));
+  CHECK(doneB == 2);
+
+  jobs.runAll();
+  CHECK(jobs.empty());
+  CHECK(doneA == 100 && doneB == 3);
+  CHECK(destroyedA == 1 && destroyedB == 1);
+}
+
+void testPendingJobsAreDestroyed() {
+  int done = 0, destroyed = 0;
+  {
+    JobScheduler jobs(fakeClock);
+    jobs.add(std::unique_ptr<Job>(new CountJob(100, 5, done, destroyed)));
+    jobs.runFor(10);
+    CHECK(destroyed == 0);
+  }
+  CHECK(destroyed == 1);
+
+  JobScheduler jobs(fakeClock);
+  jobs.add(std::unique_ptr<Job>(new CountJob(100, 5, done, destroyed)));
+  jobs.clear();
+  CHECK(jobs.empty() && destroyed == 2);
+}
+
+void testSequenceStepsSplitAtDeadline() {
+  JobScheduler jobs(fakeClock);
+  std::string log;
+  jobs.add(std::unique_ptr<Job>(new SequenceJob({
+      [&log] {
+        log += "1";
+        now += 20;
+        return true;
+      },
+      [&log] {
+        log += "2";
+        now += 20;
+        return true;
+      },
+      [&log] {
+        log += "3";
+        return true;
+      },
+  })));
+  CHECK(jobs.runFor(30) && log == "12");
+  CHECK(!jobs.runFor(30) && log == "123");
+}
+
+void testFailedStepSkipsTheRest() {
+  JobScheduler jobs(fakeClock);
+  std::string log;
+  jobs.add(std::unique_ptr<Job>(new SequenceJob({
+      [&log] {
+        log += "1";
+        return false;
+      },
+      [&log] {
+        log += "2";
+        return true;
+      },
+  })));
+  CHECK(!jobs.runFor(30) && log == "1");
+}
+
+void testExpiredSliceStillRunsEachJobOnce() {
+  JobScheduler jobs(fakeClock);
+  int ran = 0;
+  jobs.add(std::unique_ptr<Job>(new SequenceJob({[&ran] {
+    ran++;
+    return true;
+  }})));
+  jobs.add(std::unique_ptr<Job>(new SequenceJob({})));
+  CHECK(!jobs.runFor(0) && ran == 1);
+}
+}  // namespace
+
+int main() {
+  RUN_TEST(testEveryJobProgressesEachSlice);
+  RUN_TEST(testPendingJobsAreDestroyed);
+  RUN_TEST(testSequenceStepsSplitAtDeadline);
+  RUN_TEST(testFailedStepSkipsTheRest);
+  RUN_TEST(testExpiredSliceStillRunsEachJobOnce);
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include <Epub/SectionCache.h>
+#include <SDCardManager.h>
+
+#include <string>
+#include <vector>
+
+#include "HostTest.h"
+
+namespace {
+constexpr char DIR[] = "/section_cache";
+constexpr uint32_t A = 0xaaaaaaaa;
+constexpr uint32_t B = 0xbbbbbbbb;
+constexpr uint32_t C = 0xcccccccc;
+
+void freshDir() {
+  SdMan.removeDir(DIR);
+  SdMan.mkdir(DIR);
+}
+
+void writeFile(const std::string& path, const size_t bytes) {
+  FsFile file;
+  CHECK(SdMan.openFileForWrite("TST", path, file));
+  const std::vector<uint8_t> data(bytes, 0x5a);
+  file.write(data.data(), data.size());
+  file.close();
+}
+
+bool exists(const std::string& path) { return SdMan.exists(path.c_str()); }
+
+void testTouchWritesIndexOnlyWhenOrderChanges() {
+  freshDir();
+  SectionCache cache(DIR);
+  cache.touch(A);
+  CHECK(exists(std::string(DIR) + "/variants.bin"));
+  hostSdStats = {};
+  cache.touch(A);
+  CHECK(hostSdStats.opens == 0);
+  cache.touch(B);
+  CHECK(hostSdStats.bytesWritten > 0);
+
+  // Another instance reads the index once, then works from memory
+  SectionCache other(DIR);
+  hostSdStats = {};
+  other.touch(B);
+  other.touch(B);
+  CHECK(hostSdStats.opens == 1 && hostSdStats.bytesWritten == 0);
+}
+
+void testEvictUnderBudgetWalksOnlyOnce() {
+  freshDir();
+  SectionCache cache(DIR);
+  cache.touch(A);
+  writeFile(cache.getSectionPath(0, A), 100);
+  cache.addBytes(A, 100);
+  cache.evict(A, 1000);
+  CHECK(exists(cache.getSectionPath(0, A)));
+
+  writeFile(cache.getSectionPath(1, A), 100);
+  cache.addBytes(A, 100);
+  hostSdStats = {};
+  cache.evict(A, 1000);
+  CHECK(hostSdStats.opens == 0);
+}
+
+void testEvictsLeastRecentlyUsedFirst() {
+  freshDir();
+  SectionCache cache(DIR);
+  for (const uint32_t variant : {A, B, C}) {
+    cache.touch(variant);
+    writeFile(cache.getSectionPath(0, variant), 100);
+    writeFile(cache.getSectionPath(1, variant), 100);
+  }
+  cache.evict(C, 450);
+  CHECK(!exists(cache.getSectionPath(0, A)) && !exists(cache.getSectionPath(1, A)));
+  CHECK(exists(cache.getSectionPath(0, B)) && exists(cache.getSectionPath(0, C)));
+
+  // Growth reported through addBytes is enough to trigger the next eviction, the kept variant always stays
+  writeFile(cache.getSectionPath(2, C), 300);
+  cache.addBytes(C, 300);
+  cache.evict(C, 450);
+  CHECK(!exists(cache.getSectionPath(0, B)));
+  CHECK(exists(cache.getSectionPath(0, C)) && exists(cache.getSectionPath(2, C)));
+
+  // The index no longer lists the evicted variants
+  SectionCache reread(DIR);
+  reread.touch(C);
+  writeFile(reread.getSectionPath(0, B), 10);
+  reread.evict(C, 100000);
+  CHECK(!exists(reread.getSectionPath(0, B)));
+}
+
+void testUnknownFilesAlwaysGo() {
+  freshDir();
+  SectionCache cache(DIR);
+  cache.touch(A);
+  writeFile(cache.getSectionPath(0, A), 100);
+  writeFile(std::string(DIR) + "/3.bin", 100);
+  cache.evict(A, 100000);
+  CHECK(!exists(std::string(DIR) + "/3.bin"));
+  CHECK(exists(cache.getSectionPath(0, A)));
+}
+
+void testVariantDroppedFromIndexIsEvicted() {
+  freshDir();
+  SectionCache cache(DIR);
+  cache.touch(A);
+  writeFile(cache.getSectionPath(0, A), 100);
+  cache.evict(A, 100000);
+  // The index holds 8 variants, the ninth pushes A out
+  for (uint32_t variant = 1; variant <= 8; variant++) {
+    cache.touch(variant);
+  }
+  cache.evict(8, 100000);
+  CHECK(!exists(cache.getSectionPath(0, A)));
+}
+
+void testResetRereadsTheDirectory() {
+  freshDir();
+  SectionCache cache(DIR);
+  cache.touch(A);
+  cache.evict(A, 100000);
+  freshDir();
+  cache.reset();
+  cache.touch(A);
+  CHECK(exists(std::string(DIR) + "/variants.bin"));
+}
+}  // namespace
+
+int main() {
+  SdMan.begin();
+  RUN_TEST(testTouchWritesIndexOnlyWhenOrderChanges);
+  RUN_TEST(testEvictUnderBudgetWalksOnlyOnce);
+  RUN_TEST(testEvictsLeastRecentlyUsedFirst);
+  RUN_TEST(testUnknownFilesAlwaysGo);
+  RUN_TEST(testVariantDroppedFromIndexIsEvicted);
+  RUN_TEST(testResetRereadsTheDirectory);
+  return 0;
+}
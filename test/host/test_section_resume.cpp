@@ -0,0 +1,216 @@
+#include <Arduino.h>
+#include <Epub.h>
+#include <Epub/Section.h>
+#include <GfxRenderer.h>
+#include <SDCardManager.h>
+#include <ZipFile.h>
+#include <miniz.h>
+
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "HostTest.h"
+
+namespace {
+constexpr char EPUB_PATH[] = "/section_resume.epub";
+constexpr char CHAPTER_HREF[] = "OEBPS/ch1.xhtml";
+constexpr size_t CHAPTER_BYTES = 160 * 1024;
+
+// Paragraphs in nested divs, some of them inside bold or italic elements and skipped tables, so checkpoints fall at
+// every depth and style
+std::string generateChapter() {
+  static const char* words[] = {"the",  "quick", "brown",   "fox", "jumps",      "over",  "lazy",   "dog",
+                                "while", "reading", "an",  "electronic", "paper", "display", "<b>bold</b>",
+                                "<i>italic</i>"};
+  static const char* han[] = {"天", "地", "玄", "黄", "宇", "宙", "洪", "荒", "日", "月"};
+  std::mt19937 rng(5);
+  std::string html =
+      "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<!DOCTYPE html>\n<html xmlns=\"http://www.w3.org/1999/xhtml\">"
+      "<head><title>c</title><style>p { margin: 0 }</style></head><body>\n<h1>Chapter</h1>\n";
+  auto paragraph = [&] {
+    html += "<p class=\"t\">";
+    if (rng() % 3 == 0) {
+      for (int n = 20 + rng() % 250; n > 0; n--) {
+        html += han[rng() % (sizeof(han) / sizeof(han[0]))];
+      }
+    } else {
+      for (int n = 5 + rng() % 120; n > 0; n--) {
+        html += words[rng() % (sizeof(words) / sizeof(words[0]))];
+        html += n > 1 ? " " : "";
+      }
+    }
+    html += "</p>\n";
+  };
+  for (int i = 0; html.size() < CHAPTER_BYTES; i++) {
+    html += "<div class=\"section\"><h2>Part</h2>\n";
+    const char* wrapper = i % 4 == 1 ? "b" : i % 4 == 2 ? "em" : nullptr;
+    if (wrapper) {
+      html += std::string("<") + wrapper + "><div>";
+    }
+    for (int n = 1 + rng() % 6; n > 0; n--) {
+      paragraph();
+    }
+    if (wrapper) {
+      html += std::string("</div></") + wrapper + ">";
+    }
+    if (i % 5 == 3) {
+      html += "<table><tr><td><p>skipped</p></td></tr></table>\n";
+    }
+    html += "<blockquote>";
+    paragraph();
+    html += "</blockquote></div>\n";
+  }
+  return html + "</body></html>\n";
+}
+
+bool writeEpub(const std::string& chapter) {
+  mz_zip_archive zip = {};
+  const std::string path = hostPath(EPUB_PATH);
+  bool ok = mz_zip_writer_init_file(&zip, path.c_str(), 0);
+  ok = ok && mz_zip_writer_add_mem(&zip, "mimetype", "application/epub+zip", 20, MZ_NO_COMPRESSION);
+  ok = ok && mz_zip_writer_add_mem(&zip, CHAPTER_HREF, chapter.data(), chapter.size(), MZ_DEFAULT_COMPRESSION);
+  ok = ok && mz_zip_writer_finalize_archive(&zip);
+  mz_zip_writer_end(&zip);
+  return ok;
+}
+
+std::string sectionFilePath(const Epub& epub) {
+  // The section file is the only .bin besides the variant index
+  auto dir = SdMan.open((epub.getCachePath() + "/sections").c_str());
+  char name[64];
+  for (auto file = dir.openNextFile(); file; file = dir.openNextFile()) {
+    file.getName(name, sizeof(name));
+    if (strcmp(name, "variants.bin") != 0) {
+      return epub.getCachePath() + "/sections/" + name;
+    }
+  }
+  return "";
+}
+
+std::string readSectionFile(const Epub& epub) {
+  std::ifstream in(hostPath(sectionFilePath(epub).c_str()), std::ios::binary);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
+struct Build {
+  bool done = false;
+  int firstProgress = -1;
+};
+
+// One call of createSectionFile on a new Section, as when the reader comes back to the chapter, stopped after the
+// given number of chunks
+Build buildStoppedAfter(const std::shared_ptr<Epub>& epub, GfxRenderer& renderer, const int chunks) {
+  Build build;
+  Section section(epub, 0, renderer);
+  section.loadSectionFile(0, 1.0f, false, 460, 740);
+  if (section.isComplete()) {
+    build.done = true;
+    return build;
+  }
+  int yields = 0;
+  build.done = section.createSectionFile(
+      0, 1.0f, false, 460, 740, nullptr,
+      [&build](const int progress) {
+        if (build.firstProgress < 0) {
+          build.firstProgress = progress;
+        }
+      },
+      nullptr, [&yields, chunks] { return ++yields <= chunks; });
+  return build;
+}
+
+void testStoppedBuildsResume() {
+  const auto epub = std::make_shared<Epub>(EPUB_PATH, "/.section_resume");
+  SdMan.mkdir(epub->getCachePath().c_str());
+  GfxRenderer renderer;
+
+  Section whole(epub, 0, renderer);
+  whole.clearCache();
+  CHECK(whole.createSectionFile(0, 1.0f, false, 460, 740));
+  const int pages = whole.pageCount;
+  CHECK(pages > 100);
+  const std::string expected = readSectionFile(*epub);
+  CHECK(!expected.empty());
+
+  for (const int chunks : {6, 12, 40}) {
+    whole.clearCache();
+    int builds = 0;
+    int resumedPastStart = 0;
+    Build build;
+    while (!build.done && builds < 1000) {
+      build = buildStoppedAfter(epub, renderer, chunks);
+      builds++;
+      // Progress starts where layout picks up, past the start of the chapter once pages are kept
+      if (builds > 2 && build.firstProgress > 10) {
+        resumedPastStart++;
+      }
+    }
+    CHECK(build.done);
+    CHECK(builds > 3);
+    CHECK(resumedPastStart > 0);
+    CHECK(readSectionFile(*epub) == expected);
+  }
+}
+
+// Power cut mid-write: the last page record is cut short and dropped, the build resumes before it
+void testCutOffBuildResumes() {
+  const auto epub = std::make_shared<Epub>(EPUB_PATH, "/.section_resume");
+  GfxRenderer renderer;
+  Section whole(epub, 0, renderer);
+  whole.clearCache();
+  CHECK(whole.createSectionFile(0, 1.0f, false, 460, 740));
+  const std::string expected = readSectionFile(*epub);
+
+  whole.clearCache();
+  CHECK(!buildStoppedAfter(epub, renderer, 40).done);
+  const std::string path = sectionFilePath(*epub);
+  {
+    FsFile file = SdMan.open(path.c_str(), O_RDWR);
+    CHECK(file);
+    CHECK(file.truncate(file.size() - 7));
+  }
+  Section cut(epub, 0, renderer);
+  CHECK(cut.loadSectionFile(0, 1.0f, false, 460, 740));
+  CHECK(!cut.isComplete());
+  CHECK(cut.createSectionFile(0, 1.0f, false, 460, 740));
+  CHECK(readSectionFile(*epub) == expected);
+}
+}  // namespace
+
+// Only what a section build uses of Epub, the real Epub.cpp needs a whole book
+const std::string& Epub::getCachePath() const { return cachePath; }
+
+SectionCache& Epub::getSectionCache() const {
+  if (!sectionCache) {
+    sectionCache.reset(new SectionCache(cachePath + "/sections"));
+  }
+  return *sectionCache;
+}
+
+BookMetadataCache::SpineEntry Epub::getSpineItem(int) const {
+  BookMetadataCache::SpineEntry entry;
+  entry.href = CHAPTER_HREF;
+  return entry;
+}
+
+std::unique_ptr<ZipFileReader> Epub::openItemReader(const std::string& itemHref, const size_t chunkSize,
+                                                    const std::string& spoolPath) const {
+  std::unique_ptr<ZipFileReader> reader(new ZipFileReader(filepath));
+  if (!reader->open(itemHref.c_str(), chunkSize, spoolPath)) {
+    return nullptr;
+  }
+  return reader;
+}
+
+int main() {
+  SdMan.begin();
+  ESP.freeHeap = ESP.minFreeHeap = 160000;
+  CHECK(writeEpub(generateChapter()));
+  RUN_TEST(testStoppedBuildsResume);
+  RUN_TEST(testCutOffBuildResumes);
+  return 0;
+}
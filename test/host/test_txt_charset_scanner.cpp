@@ -0,0 +1,98 @@
+#include <CodepointSet.h>
+#include <TxtCharsetScanner.h>
+#include <Utf8.h>
+
+#include <random>
+#include <string>
+
+#include "HostTest.h"
+
+namespace {
+constexpr char PATH[] = "/scanner.txt";
+
+void appendUtf8(std::string& text, const uint32_t cp) {
+  if (cp < 0x80) {
+    text += static_cast<char>(cp);
+  } else if (cp < 0x800) {
+    text += static_cast<char>(0xC0 | cp >> 6);
+    text += static_cast<char>(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    text += static_cast<char>(0xE0 | cp >> 12);
+    text += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    text += static_cast<char>(0x80 | (cp & 0x3F));
+  } else {
+    text += static_cast<char>(0xF0 | cp >> 18);
+    text += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    text += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    text += static_cast<char>(0x80 | (cp & 0x3F));
+  }
+}
+
+void writeText(const std::string& text) {
+  FsFile file;
+  CHECK(SdMan.openFileForWrite("TST", PATH, file));
+  file.write(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+  file.close();
+}
+
+// Returns the number of chunks the scan took
+int scan(CodepointSet& charset) {
+  TxtCharsetScanner scanner;
+  CHECK(scanner.begin(PATH));
+  int chunks = 0;
+  while (scanner.scanChunk(charset)) {
+    chunks++;
+  }
+  CHECK(!scanner.scanChunk(charset));
+  return chunks;
+}
+
+void testMatchesDirectDecode() {
+  // 1 to 4 byte characters in random order, so they straddle the chunk boundaries
+  std::string text = "\xEF\xBB\xBF";
+  std::mt19937 rng(1);
+  const uint32_t common[] = {'a', 'Z', '\n', 0xE9, 0x3000, 0x4E2D, 0x6587, 0x1F600};
+  while (text.size() < 50000) {
+    const uint32_t cp = rng() % 7 == 0 ? 0x4E00 + rng() % 2000 : common[rng() % 8];
+    appendUtf8(text, cp);
+  }
+  writeText(text);
+
+  CodepointSet expected;
+  const auto* p = reinterpret_cast<const unsigned char*>(text.c_str());
+  while (const uint32_t cp = utf8NextCodepoint(&p)) {
+    if (cp >= 0x20) {
+      expected.add(cp);
+    }
+  }
+
+  CodepointSet charset;
+  const int chunks = scan(charset);
+  CHECK(chunks == static_cast<int>((text.size() + TxtCharsetScanner::CHUNK_SIZE - 1) / TxtCharsetScanner::CHUNK_SIZE));
+  CHECK(charset.size() == expected.size());
+  bool allFound = true;
+  expected.forEach([&charset, &allFound](const uint32_t cp) { allFound &= charset.contains(cp); });
+  CHECK(allFound);
+}
+
+void testEmptyFile() {
+  writeText("");
+  CodepointSet charset;
+  CHECK(scan(charset) == 0 && charset.size() == 0);
+}
+
+void testMissingFile() {
+  TxtCharsetScanner scanner;
+  CHECK(!scanner.begin("/missing.txt"));
+  CodepointSet charset;
+  CHECK(!scanner.scanChunk(charset));
+}
+}  // namespace
+
+int main() {
+  SdMan.begin();
+  RUN_TEST(testMatchesDirectDecode);
+  RUN_TEST(testEmptyFile);
+  RUN_TEST(testMissingFile);
+  return 0;
+}